@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+
+# Generate the perfect hash table of SQL keywords (src/include/keyword_table.h)
+# from the KeywordId enumeration in src/include/lexer.h.
+#
+#   python3 script/keywords.py
+#
+# Rerun after adding keywords to the enumeration.
+
+import os
+import random
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+LEXER_HEADER = os.path.join(ROOT, "src", "include", "lexer.h")
+TABLE_HEADER = os.path.join(ROOT, "src", "include", "keyword_table.h")
+
+MASK = 0xFFFFFFFF
+
+
+def read_keywords():
+    with open(LEXER_HEADER) as header:
+        text = header.read()
+    enum = re.search(r"enum KeywordId[^{]*{(.*?)};", text, re.S).group(1)
+    names = re.findall(r"\bKEYWORD_([A-Z_]+)\b", enum)
+    return [name.lower() for name in names if name != "NONE"]
+
+
+# Must match KeywordHash in src/lexer.cpp
+def keyword_hash(word, multipliers, bits):
+    first, second, last, length = multipliers
+    value = (ord(word[0]) * first + ord(word[1]) * second +
+             ord(word[-1]) * last + len(word) * length) & MASK
+    return value >> (32 - bits)
+
+
+def search(keywords):
+    generator = random.Random(0)
+    bits = max(len(keywords) - 1, 1).bit_length() + 1
+    while True:
+        for _ in range(100000):
+            multipliers = [generator.getrandbits(32) | 1 for _ in range(4)]
+            slots = set()
+            for word in keywords:
+                slot = keyword_hash(word, multipliers, bits)
+                if slot in slots:
+                    break
+                slots.add(slot)
+            else:
+                return multipliers, bits
+        bits += 1
+
+
+def main():
+    keywords = read_keywords()
+    for word in keywords:
+        if re.fullmatch(r"[a-z]{2,}", word) is None:
+            sys.exit("unsupported keyword: " + word)
+
+    multipliers, bits = search(keywords)
+    table = [None] * (1 << bits)
+    for word in keywords:
+        table[keyword_hash(word, multipliers, bits)] = word
+
+    lines = []
+    lines.append("// KEYWORD TABLE HEADER")
+    lines.append("// Generated by script/keywords.py from KeywordId in lexer.h; do not edit")
+    lines.append("")
+    lines.append("#pragma once")
+    lines.append("")
+    lines.append('#include "lexer.h"')
+    lines.append("")
+    lines.append("namespace sqlcheck {")
+    lines.append("")
+    lines.append("// Multipliers of the first, second and last byte and of the length")
+    for name, value in zip(["FIRST", "SECOND", "LAST", "LENGTH"], multipliers):
+        lines.append("const uint32_t KEYWORD_HASH_%s = 0x%08Xu;" % (name, value))
+    lines.append("")
+    lines.append("const unsigned KEYWORD_HASH_BITS = %d;" % bits)
+    lines.append("const size_t KEYWORD_MIN_LENGTH = %d;" % min(len(word) for word in keywords))
+    lines.append("const size_t KEYWORD_MAX_LENGTH = %d;" % max(len(word) for word in keywords))
+    lines.append("")
+    lines.append("struct KeywordEntry {")
+    lines.append("")
+    lines.append("  const char* word;")
+    lines.append("  uint8_t length;")
+    lines.append("  KeywordId keyword;")
+    lines.append("")
+    lines.append("};")
+    lines.append("")
+    lines.append("// Keywords indexed by their hash")
+    lines.append("const KeywordEntry KEYWORD_HASH_TABLE[1u << KEYWORD_HASH_BITS] = {")
+    entries = []
+    for word in table:
+        if word is None:
+            entries.append('  {"", 0, KEYWORD_NONE}')
+        else:
+            entries.append('  {"%s", %d, KEYWORD_%s}' % (word, len(word), word.upper()))
+    lines.append(",\n".join(entries))
+    lines.append("};")
+    lines.append("")
+    lines.append("}  // namespace sqlcheck")
+
+    with open(TABLE_HEADER, "w") as header:
+        header.write("\n".join(lines) + "\n")
+    print("%d keywords in %d slots" % (len(keywords), len(table)))
+
+
+if __name__ == "__main__":
+    main()
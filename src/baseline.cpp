@@ -0,0 +1,175 @@
+// BASELINE SOURCE
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "include/baseline.h"
+#include "include/hash.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// File layout: magic, version, slot count and the slots, all in native
+// byte order
+const char BASELINE_MAGIC[8] = {'S', 'Q', 'L', 'C', 'B', 'A', 'S', 'E'};
+const uint64_t BASELINE_VERSION = 1;
+const size_t BASELINE_HEADER_SIZE = 3 * sizeof(uint64_t);
+
+// Spread the bits of a key to pick its slot
+uint64_t MixKey(uint64_t key){
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return key;
+}
+
+}  // namespace
+
+uint64_t BaselineKey(const uint64_t fingerprint, const int pattern_id){
+  auto key = fingerprint ^ (static_cast<uint64_t>(pattern_id) * 0x9e3779b97f4a7c15ULL);
+
+  // Keep 0 free for empty slots
+  return (key == 0) ? 1 : key;
+}
+
+Baseline::Baseline()
+ : mapping_(nullptr),
+   mapping_size_(0),
+   slots_(nullptr),
+   slot_count_(0){
+}
+
+Baseline::~Baseline(){
+  Close();
+}
+
+void Baseline::Close(){
+  if(mapping_ != nullptr){
+    munmap(mapping_, mapping_size_);
+  }
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+  slots_ = nullptr;
+  slot_count_ = 0;
+}
+
+void Baseline::Open(const std::string& file_name){
+
+  // Reopening replaces the previous mapping
+  Close();
+
+  int handle = open(file_name.c_str(), O_RDONLY);
+  if(handle < 0){
+    throw std::runtime_error("Could not open baseline: " + file_name);
+  }
+
+  struct stat file_stat;
+  if(fstat(handle, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < BASELINE_HEADER_SIZE){
+    close(handle);
+    throw std::runtime_error("Invalid baseline: " + file_name);
+  }
+
+  mapping_size_ = static_cast<size_t>(file_stat.st_size);
+  mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, handle, 0);
+  close(handle);
+  if(mapping_ == MAP_FAILED){
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+    throw std::runtime_error("Could not map baseline: " + file_name);
+  }
+
+  // The slot count is bounded by the file size before it is multiplied,
+  // so that a corrupt count cannot overflow the size check
+  auto header = static_cast<const uint64_t*>(mapping_);
+  slot_count_ = header[2];
+  if(std::memcmp(header, BASELINE_MAGIC, sizeof(BASELINE_MAGIC)) != 0 ||
+      header[1] != BASELINE_VERSION || slot_count_ == 0 ||
+      (slot_count_ & (slot_count_ - 1)) != 0 ||
+      slot_count_ > (mapping_size_ - BASELINE_HEADER_SIZE) / sizeof(uint64_t) ||
+      mapping_size_ != BASELINE_HEADER_SIZE + slot_count_ * sizeof(uint64_t)){
+    Close();
+    throw std::runtime_error("Invalid baseline: " + file_name);
+  }
+  slots_ = header + 3;
+
+}
+
+bool Baseline::Contains(const uint64_t key) const {
+
+  if(slots_ == nullptr){
+    return false;
+  }
+
+  // Linear probing; tables are at most half full
+  auto mask = slot_count_ - 1;
+  for(auto slot = MixKey(key) & mask; ; slot = (slot + 1) & mask){
+    if(slots_[slot] == key){
+      return true;
+    }
+    if(slots_[slot] == 0){
+      return false;
+    }
+  }
+}
+
+uint64_t Baseline::ContentHash() const {
+  if(mapping_ == nullptr){
+    return 0;
+  }
+  return HashBytes(static_cast<const char*>(mapping_), mapping_size_);
+}
+
+void Baseline::Write(const std::string& file_name,
+                     std::vector<uint64_t> keys){
+
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  uint64_t slot_count = 16;
+  while(slot_count < 2 * keys.size()){
+    slot_count *= 2;
+  }
+
+  std::vector<uint64_t> slots(slot_count, 0);
+  for(auto key : keys){
+    auto slot = MixKey(key) & (slot_count - 1);
+    while(slots[slot] != 0){
+      slot = (slot + 1) & (slot_count - 1);
+    }
+    slots[slot] = key;
+  }
+
+  uint64_t header[3];
+  std::memcpy(&header[0], BASELINE_MAGIC, sizeof(BASELINE_MAGIC));
+  header[1] = BASELINE_VERSION;
+  header[2] = slot_count;
+
+  // Write to a temporary file first so that readers never map a
+  // truncated baseline
+  auto temporary_path = file_name + ".tmp";
+  {
+    std::ofstream output(temporary_path.c_str(), std::ios::binary);
+    output.write(reinterpret_cast<const char*>(header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(slots.data()),
+                 slots.size() * sizeof(uint64_t));
+    if(!output){
+      throw std::runtime_error("Could not write baseline: " + temporary_path);
+    }
+  }
+  if(std::rename(temporary_path.c_str(), file_name.c_str()) != 0){
+    throw std::runtime_error("Could not write baseline: " + file_name);
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,188 @@
+// BUDGET SOURCE
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include "include/budget.h"
+#include "include/checker.h"
+#include "include/splitter.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Check whether a line ends a statement: only blanks or a line comment
+// follow the last delimiter on it
+bool EndsStatement(const std::string& line,
+                   const std::string& delimiter){
+  auto pos = line.rfind(delimiter);
+  if(pos == std::string::npos){
+    return false;
+  }
+  auto rest = line.find_first_not_of(" \t\r", pos + delimiter.size());
+  return rest == std::string::npos || line.compare(rest, 2, "--") == 0;
+}
+
+// Find the first statement boundary at or after a position without
+// reading the input before it: statements start right after a line that
+// ends one. A line inside a multi-line string or comment, or after a
+// DELIMITER directive, can be taken for a boundary.
+unsigned long long FindStatementStart(std::istream& input,
+                                      const unsigned long long position,
+                                      const unsigned long long size,
+                                      const std::string& delimiter){
+  if(position == 0){
+    return 0;
+  }
+
+  // Search backwards for the start of the line holding the previous byte
+  const unsigned long long window_size = 4096;
+  unsigned long long line_start = 0;
+  unsigned long long window_end = position - 1;
+  std::string window;
+  while(window_end > 0){
+    auto window_start = (window_end > window_size) ? window_end - window_size : 0;
+    window.resize(window_end - window_start);
+    input.clear();
+    input.seekg(window_start);
+    input.read(&window[0], window.size());
+
+    auto newline = window.rfind('\n');
+    if(newline != std::string::npos){
+      line_start = window_start + newline + 1;
+      break;
+    }
+    window_end = window_start;
+  }
+
+  input.clear();
+  input.seekg(line_start);
+  std::string line;
+  auto offset = line_start;
+  while(std::getline(input, line)){
+    offset += line.size() + 1;
+    if(EndsStatement(line, delimiter)){
+      return std::min(offset, size);
+    }
+  }
+  return size;
+}
+
+// Reverse the lowest bits of an index
+size_t ReverseBits(size_t index, const size_t bits){
+  size_t reversed = 0;
+  for(size_t bit = 0; bit < bits; bit++){
+    reversed = (reversed << 1) | (index & 1);
+    index >>= 1;
+  }
+  return reversed;
+}
+
+}  // namespace
+
+double ParseDuration(const std::string& duration){
+
+  char* unit = nullptr;
+  double value = std::strtod(duration.c_str(), &unit);
+  std::string suffix(unit);
+
+  if(unit == duration.c_str() || value < 0){
+    throw std::invalid_argument("Invalid duration: " + duration);
+  }
+  if(suffix.empty() || suffix == "s"){
+    return value;
+  }
+  if(suffix == "ms"){
+    return value / 1000;
+  }
+  if(suffix == "m"){
+    return value * 60;
+  }
+  if(suffix == "h"){
+    return value * 3600;
+  }
+  throw std::invalid_argument("Invalid duration: " + duration);
+}
+
+void CheckWithTimeBudget(Configuration& state,
+                         std::istream& input){
+
+  auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(state.time_budget));
+
+  input.seekg(0, std::ios::end);
+  if(input.tellg() < 0){
+    throw std::runtime_error("Time-budgeted checks require a seekable input");
+  }
+  auto size = static_cast<unsigned long long>(input.tellg());
+
+  // Split the input into a power of two number of ranges; visiting them in
+  // bit-reversed order covers the input evenly at any point in time
+  size_t bits = 0;
+  while((static_cast<size_t>(2) << bits) <= BUDGET_MAX_RANGES &&
+      (BUDGET_MIN_RANGE_SIZE << (bits + 1)) <= size){
+    bits++;
+  }
+  size_t ranges = static_cast<size_t>(1) << bits;
+
+  state.total_bytes = size;
+  state.total_ranges = ranges;
+
+  for(size_t itr = 0; itr < ranges && state.cancelled == false; itr++){
+    auto range = ReverseBits(itr, bits);
+
+    // A range checks the statements starting between the first boundary
+    // in it and the first boundary in the next range
+    auto range_start = FindStatementStart(input, size * range / ranges, size,
+                                          state.delimiter);
+    auto range_end = FindStatementStart(input, size * (range + 1) / ranges, size,
+                                        state.delimiter);
+    input.clear();
+    input.seekg(range_start);
+
+    StatementSplitter splitter(state, input);
+    std::string sql_statement;
+    bool expired = false;
+    while(range_start < range_end && splitter.Next(sql_statement)){
+      if(splitter.StatementOffset() >= range_end){
+        break;
+      }
+      CheckStatement(state, sql_statement);
+
+      if(std::chrono::steady_clock::now() >= deadline){
+        expired = true;
+        break;
+      }
+    }
+
+    if(expired || state.cancelled == true){
+      auto position = std::min(splitter.Offset(), range_end);
+      state.covered_bytes += (position > range_start) ? position - range_start : 0;
+      break;
+    }
+
+    state.covered_bytes += (range_end > range_start) ? range_end - range_start : 0;
+    state.covered_ranges++;
+  }
+
+}
+
+void PrintCoverage(const Configuration& state){
+
+  double percentage = (state.total_bytes == 0) ? 100.0 :
+      100.0 * state.covered_bytes / state.total_bytes;
+
+  std::cout << "\n==================== Coverage ==================\n";
+  std::cout << "Bytes        :: " << state.covered_bytes << " of " << state.total_bytes
+      << " (" << std::fixed << std::setprecision(1) << percentage << "%)\n";
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << "Ranges       :: " << state.covered_ranges << " of " << state.total_ranges << "\n";
+
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,215 @@
+// CACHE SOURCE
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "include/cache.h"
+#include "include/checker.h"
+#include "include/hash.h"
+#include "include/list.h"
+#include "include/splitter.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Statements read and checked by a sampled check
+struct SampleCounts {
+
+  unsigned long long scanned_statements = 0;
+  unsigned long long sampled_statements = 0;
+
+};
+
+std::string ResultCachePath(const Configuration& state, const uint64_t key){
+  return state.cache_dir + "/results-" + HashToString(key);
+}
+
+bool LoadResults(const std::string& path,
+                 std::vector<StatementFindings>& results,
+                 SampleCounts& samples){
+
+  std::ifstream input(path.c_str(), std::ios::binary);
+  std::string version;
+  if(!input || !std::getline(input, version) || version != RESULT_CACHE_VERSION){
+    return false;
+  }
+
+  size_t statement_count;
+  if(!(input >> samples.scanned_statements >> samples.sampled_statements >> statement_count)){
+    return false;
+  }
+
+  results.clear();
+  for(size_t itr = 0; itr < statement_count; itr++){
+    StatementFindings result;
+    size_t finding_count;
+    if(!(input >> finding_count) || ReadString(input, result.statement) == false){
+      return false;
+    }
+
+    for(size_t finding_itr = 0; finding_itr < finding_count; finding_itr++){
+      int pattern_id, risk_level, pattern_type, exists;
+      Finding finding;
+      if(!(input >> pattern_id >> risk_level >> pattern_type >> exists) ||
+          ReadString(input, finding.message) == false ||
+          ReadString(input, finding.match) == false){
+        return false;
+      }
+      finding.pattern_id = static_cast<PatternId>(pattern_id);
+      finding.risk_level = static_cast<RiskLevel>(risk_level);
+      finding.pattern_type = static_cast<PatternType>(pattern_type);
+      finding.exists = (exists != 0);
+      result.findings.push_back(finding);
+    }
+
+    results.push_back(result);
+  }
+
+  return true;
+}
+
+void SaveResults(const std::string& cache_dir,
+                 const std::string& path,
+                 const std::vector<StatementFindings>& results,
+                 const SampleCounts& samples){
+  mkdir(cache_dir.c_str(), 0755);
+
+  // Write to a temporary file first so that an interrupted run never
+  // leaves behind truncated results
+  auto temporary_path = path + ".tmp";
+  {
+    std::ofstream output(temporary_path.c_str(), std::ios::binary);
+    if(!output){
+      std::cerr << "Could not write result cache: " << temporary_path << "\n";
+      return;
+    }
+
+    output << RESULT_CACHE_VERSION << "\n" << samples.scanned_statements << " "
+        << samples.sampled_statements << " " << results.size() << "\n";
+    for(auto& result : results){
+      output << result.findings.size() << " ";
+      WriteString(output, result.statement);
+      for(auto& finding : result.findings){
+        output << finding.pattern_id << " " << finding.risk_level << " "
+            << finding.pattern_type << " " << finding.exists << " ";
+        WriteString(output, finding.message);
+        WriteString(output, finding.match);
+      }
+    }
+  }
+  std::rename(temporary_path.c_str(), path.c_str());
+}
+
+}  // namespace
+
+void WriteString(std::ostream& output, const std::string& value){
+  output << value.size() << " " << value << "\n";
+}
+
+bool ReadString(std::istream& input, std::string& value){
+  size_t length;
+  if(!(input >> length) || input.get() != ' '){
+    return false;
+  }
+  value.resize(length);
+  if(length != 0 && !input.read(&value[0], length)){
+    return false;
+  }
+  return input.get() == '\n';
+}
+
+uint64_t ResultCacheKey(const Configuration& state,
+                        const std::string& contents){
+
+  // Color and verbose mode only affect how findings are printed; cached
+  // findings are already filtered by the baseline
+  uint64_t key = HashString(RESULT_CACHE_VERSION + "\n" + RULE_SET_VERSION + "\n");
+  key = HashString(std::to_string(state.risk_level) + "\n", key);
+  key = HashString(state.delimiter + "\n", key);
+  key = HashString(std::to_string(state.dialect) + "\n", key);
+  key = HashString(std::to_string(state.sample_rate) + " " +
+                   std::to_string(state.reservoir_size) + "\n", key);
+  key = HashString(std::to_string(state.baseline.ContentHash()) + "\n", key);
+  return HashString(contents, key);
+}
+
+bool CheckCachedStream(Configuration& state,
+                       std::istream& input){
+
+  std::stringstream buffer;
+  buffer << input.rdbuf();
+  auto contents = buffer.str();
+
+  auto path = ResultCachePath(state, ResultCacheKey(state, contents));
+
+  auto sampled = state.sample_rate < 1.0 || state.reservoir_size != 0;
+
+  std::vector<StatementFindings> results;
+  SampleCounts samples;
+  if(LoadResults(path, results, samples)){
+    for(auto& result : results){
+      auto replay = [&](){
+        state.findings = result.findings;
+        ReportFindings(state, result.statement);
+      };
+      if(sampled){
+        CheckSample(state, replay);
+      }
+      else {
+        replay();
+      }
+      if(state.cancelled == true){
+        break;
+      }
+    }
+
+    // Only the sampled statements with findings are cached
+    if(sampled && state.cancelled == false){
+      state.sampled_statements += samples.sampled_statements - results.size();
+    }
+    state.scanned_statements += samples.scanned_statements;
+    return true;
+  }
+
+  std::istringstream contents_stream(contents);
+  StatementSplitter splitter(state, contents_stream);
+  if(sampled){
+    splitter.SetSampling(state.sample_rate, state.reservoir_size);
+  }
+  std::string sql_statement;
+  auto sampled_statements = state.sampled_statements;
+  while(splitter.Next(sql_statement)){
+    auto check = [&](){
+      CheckStatement(state, sql_statement);
+    };
+    if(sampled){
+      CheckSample(state, check);
+    }
+    else {
+      check();
+    }
+    if(state.findings.empty() == false){
+      results.push_back(StatementFindings{state.statement, state.findings});
+    }
+  }
+  if(sampled){
+    samples.scanned_statements = splitter.Statements();
+    samples.sampled_statements = state.sampled_statements - sampled_statements;
+    state.scanned_statements += samples.scanned_statements;
+  }
+
+  // Partial results of a cancelled check are not reusable
+  if(state.cancelled == false){
+    SaveResults(state.cache_dir, path, results, samples);
+  }
+
+  return false;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,657 @@
+// CATALOG SOURCE
+
+#include <cctype>
+#include <algorithm>
+
+#include "include/catalog.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// UTILITY
+
+std::string Trim(const std::string& text){
+  auto begin = text.find_first_not_of(' ');
+  if(begin == std::string::npos){
+    return "";
+  }
+  auto end = text.find_last_not_of(' ');
+  return text.substr(begin, end - begin + 1);
+}
+
+// Collapse all white space into single spaces and strip the delimiter
+std::string NormalizeText(const std::string& text){
+  std::string normalized;
+  normalized.reserve(text.size());
+
+  bool space = false;
+  for(char c : text){
+    if(std::isspace(static_cast<unsigned char>(c))){
+      space = true;
+      continue;
+    }
+    if(space && normalized.empty() == false){
+      normalized += ' ';
+    }
+    space = false;
+    normalized += c;
+  }
+
+  while(normalized.empty() == false &&
+      (normalized.back() == ';' || normalized.back() == ' ')){
+    normalized.pop_back();
+  }
+
+  return normalized;
+}
+
+void SkipSpace(const std::string& text, size_t& pos){
+  while(pos < text.size() && text[pos] == ' '){
+    pos++;
+  }
+}
+
+// Read the next word; quoted identifiers are returned without their quotes
+std::string ReadWord(const std::string& text, size_t& pos){
+  SkipSpace(text, pos);
+
+  std::string word;
+  while(pos < text.size()){
+    char c = text[pos];
+
+    if(c == '"' || c == '`' || c == '['){
+      char closing = (c == '[') ? ']' : c;
+      auto end = text.find(closing, pos + 1);
+      if(end == std::string::npos){
+        end = text.size();
+      }
+      word += text.substr(pos + 1, end - pos - 1);
+      pos = std::min(end + 1, text.size());
+      continue;
+    }
+
+    if(c == ' ' || c == '(' || c == ')' || c == ',' || c == ';'){
+      break;
+    }
+
+    word += c;
+    pos++;
+  }
+
+  return word;
+}
+
+// Consume a sequence of words if it is next in the text
+bool ConsumeWords(const std::string& text,
+                  size_t& pos,
+                  const std::vector<std::string>& words){
+  size_t cursor = pos;
+  for(auto& word : words){
+    if(ReadWord(text, cursor) != word){
+      return false;
+    }
+  }
+  pos = cursor;
+  return true;
+}
+
+std::string Rest(const std::string& text, size_t pos){
+  if(pos >= text.size()){
+    return "";
+  }
+  return Trim(text.substr(pos));
+}
+
+// Locate the parenthesis closing the one at the given position
+size_t FindClosingParen(const std::string& text, size_t pos){
+  int depth = 0;
+  bool quoted = false;
+
+  for(; pos < text.size(); pos++){
+    char c = text[pos];
+    if(c == '\''){
+      quoted = !quoted;
+    }
+    else if(quoted == false && c == '('){
+      depth++;
+    }
+    else if(quoted == false && c == ')'){
+      depth--;
+      if(depth == 0){
+        return pos;
+      }
+    }
+  }
+
+  return text.size();
+}
+
+// Split on commas that are not nested in parentheses or literals
+std::vector<std::string> SplitTopLevel(const std::string& text){
+  std::vector<std::string> parts;
+  std::string part;
+  int depth = 0;
+  bool quoted = false;
+
+  for(char c : text){
+    if(c == '\''){
+      quoted = !quoted;
+    }
+    else if(quoted == false && c == '('){
+      depth++;
+    }
+    else if(quoted == false && c == ')'){
+      depth--;
+    }
+    else if(quoted == false && depth == 0 && c == ','){
+      part = Trim(part);
+      if(part.empty() == false){
+        parts.push_back(part);
+      }
+      part.clear();
+      continue;
+    }
+    part += c;
+  }
+
+  part = Trim(part);
+  if(part.empty() == false){
+    parts.push_back(part);
+  }
+
+  return parts;
+}
+
+bool IsConstraintKeyword(const std::string& word){
+  return (word == "primary" || word == "foreign" || word == "unique" ||
+      word == "check" || word == "exclude");
+}
+
+bool IsIndexKeyword(const std::string& word){
+  return (word == "index" || word == "key" ||
+      word == "fulltext" || word == "spatial");
+}
+
+// Compare index names, ignoring any schema qualifier
+bool SameIndexName(const std::string& name, const std::string& other){
+  if(name == other){
+    return true;
+  }
+  auto dot = other.rfind('.');
+  return (dot != std::string::npos && name == other.substr(dot + 1));
+}
+
+ColumnInfo* FindColumn(TableInfo& table, const std::string& name){
+  for(auto& column : table.columns){
+    if(column.name == name){
+      return &column;
+    }
+  }
+  return nullptr;
+}
+
+void RemoveColumn(TableInfo& table, const std::string& name){
+  table.columns.erase(std::remove_if(table.columns.begin(),
+                                     table.columns.end(),
+                                     [&](const ColumnInfo& column){
+                                       return column.name == name;
+                                     }),
+                      table.columns.end());
+}
+
+void RemoveConstraint(TableInfo& table, const std::string& name){
+  table.constraints.erase(std::remove_if(table.constraints.begin(),
+                                         table.constraints.end(),
+                                         [&](const ConstraintInfo& constraint){
+                                           return constraint.name == name;
+                                         }),
+                          table.constraints.end());
+}
+
+void RemoveIndex(TableInfo& table, const std::string& name){
+  table.indexes.erase(std::remove_if(table.indexes.begin(),
+                                     table.indexes.end(),
+                                     [&](const IndexInfo& index){
+                                       return SameIndexName(index.name, name);
+                                     }),
+                      table.indexes.end());
+}
+
+void AddIndex(TableInfo& table, const IndexInfo& index){
+  if(index.name.empty() == false){
+    RemoveIndex(table, index.name);
+  }
+  table.indexes.push_back(index);
+}
+
+// Add a column, constraint or index definition to a table
+void AddTableElement(TableInfo& table, const std::string& element){
+  size_t pos = 0;
+  auto keyword = ReadWord(element, pos);
+  if(keyword.empty()){
+    return;
+  }
+
+  if(keyword == "constraint"){
+    ConstraintInfo constraint;
+    constraint.name = ReadWord(element, pos);
+    constraint.definition = Rest(element, pos);
+    table.constraints.push_back(constraint);
+    return;
+  }
+
+  if(IsConstraintKeyword(keyword)){
+    table.constraints.push_back(ConstraintInfo{"", element});
+    return;
+  }
+
+  if(IsIndexKeyword(keyword)){
+    size_t cursor = pos;
+    auto name = ReadWord(element, cursor);
+    if(name == "index" || name == "key"){
+      name = ReadWord(element, cursor);
+    }
+    AddIndex(table, IndexInfo{name, element});
+    return;
+  }
+
+  auto column = FindColumn(table, keyword);
+  if(column != nullptr){
+    column->definition = Rest(element, pos);
+  }
+  else {
+    table.columns.push_back(ColumnInfo{keyword, Rest(element, pos)});
+  }
+}
+
+void AddTableElements(TableInfo& table, const std::string& text, size_t pos){
+  SkipSpace(text, pos);
+  if(pos >= text.size() || text[pos] != '('){
+    return;
+  }
+
+  auto end = FindClosingParen(text, pos);
+  for(auto& element : SplitTopLevel(text.substr(pos + 1, end - pos - 1))){
+    AddTableElement(table, element);
+  }
+}
+
+void DropPrimaryKey(TableInfo& table){
+  table.constraints.erase(std::remove_if(table.constraints.begin(),
+                                         table.constraints.end(),
+                                         [](const ConstraintInfo& constraint){
+                                           return constraint.definition.compare(0, 11, "primary key") == 0;
+                                         }),
+                          table.constraints.end());
+
+  for(auto& column : table.columns){
+    auto found = column.definition.find(" primary key");
+    if(found != std::string::npos){
+      column.definition.erase(found, 12);
+    }
+  }
+}
+
+// Apply a single ALTER TABLE action
+void AlterTable(TableInfo& table, const std::string& action){
+  size_t pos = 0;
+  auto verb = ReadWord(action, pos);
+
+  if(verb == "add"){
+    size_t cursor = pos;
+    auto word = ReadWord(action, cursor);
+    if(word == "column"){
+      pos = cursor;
+      ConsumeWords(action, pos, {"if", "not", "exists"});
+      AddTableElement(table, Rest(action, pos));
+    }
+    else if(word.empty()){
+      AddTableElements(table, action, pos);
+    }
+    else {
+      AddTableElement(table, Rest(action, pos));
+    }
+  }
+  else if(verb == "drop"){
+    size_t cursor = pos;
+    auto word = ReadWord(action, cursor);
+    if(word == "primary"){
+      DropPrimaryKey(table);
+    }
+    else if(word == "foreign"){
+      pos = cursor;
+      ConsumeWords(action, pos, {"key"});
+      RemoveConstraint(table, ReadWord(action, pos));
+    }
+    else if(word == "constraint"){
+      pos = cursor;
+      ConsumeWords(action, pos, {"if", "exists"});
+      auto name = ReadWord(action, pos);
+      RemoveConstraint(table, name);
+      RemoveIndex(table, name);
+    }
+    else if(word == "index" || word == "key"){
+      pos = cursor;
+      RemoveIndex(table, ReadWord(action, pos));
+    }
+    else {
+      ConsumeWords(action, pos, {"column"});
+      ConsumeWords(action, pos, {"if", "exists"});
+      RemoveColumn(table, ReadWord(action, pos));
+    }
+  }
+  else if(verb == "modify" || verb == "change" || verb == "alter"){
+    ConsumeWords(action, pos, {"column"});
+    auto column = FindColumn(table, ReadWord(action, pos));
+    if(column == nullptr){
+      return;
+    }
+
+    if(verb == "change"){
+      column->name = ReadWord(action, pos);
+      column->definition = Rest(action, pos);
+    }
+    else if(verb == "modify"){
+      column->definition = Rest(action, pos);
+    }
+    else if(ConsumeWords(action, pos, {"type"}) ||
+        ConsumeWords(action, pos, {"set", "data", "type"})){
+      column->definition = Rest(action, pos);
+    }
+  }
+  else if(verb == "rename"){
+    auto word = ReadWord(action, pos);
+    if(word == "to" || word == "as"){
+      table.name = ReadWord(action, pos);
+      return;
+    }
+
+    if(word == "column"){
+      word = ReadWord(action, pos);
+    }
+    ConsumeWords(action, pos, {"to"});
+    auto column = FindColumn(table, word);
+    if(column != nullptr){
+      column->name = ReadWord(action, pos);
+    }
+  }
+}
+
+// Normalize a DDL statement and read its verb and object type, skipping
+// object modifiers; returns false for other statements
+bool ReadStatementType(const std::string& sql_statement,
+                       std::string& text,
+                       size_t& pos,
+                       std::string& verb,
+                       std::string& object){
+
+  // Skip statements that cannot be DDL without normalizing them
+  auto start = sql_statement.find_first_not_of(" \t\r\n");
+  if(start == std::string::npos){
+    return false;
+  }
+  char first = sql_statement[start];
+  if(first != 'c' && first != 'a' && first != 'd'){
+    return false;
+  }
+
+  text = NormalizeText(sql_statement.substr(start));
+  pos = 0;
+  verb = ReadWord(text, pos);
+  if(verb != "create" && verb != "alter" && verb != "drop"){
+    return false;
+  }
+
+  // Skip object modifiers
+  object = ReadWord(text, pos);
+  while(object == "or" || object == "replace" || object == "temporary" ||
+      object == "temp" || object == "global" || object == "local" ||
+      object == "unlogged" || object == "unique" || object == "clustered" ||
+      object == "nonclustered" || object == "fulltext" || object == "spatial" ||
+      object == "bitmap" || object == "online"){
+    object = ReadWord(text, pos);
+  }
+
+  return true;
+}
+
+// Read the name of a created index and of its table; returns false if the
+// statement has no ON clause
+bool ReadIndexTarget(const std::string& text,
+                     size_t& pos,
+                     std::string& index_name,
+                     std::string& table_name){
+
+  ConsumeWords(text, pos, {"concurrently"});
+  ConsumeWords(text, pos, {"if", "not", "exists"});
+
+  index_name = ReadWord(text, pos);
+  if(index_name == "on"){
+    index_name.clear();
+  }
+  else if(ReadWord(text, pos) != "on"){
+    return false;
+  }
+
+  ConsumeWords(text, pos, {"only"});
+  table_name = ReadWord(text, pos);
+  return true;
+}
+
+}  // namespace
+
+bool TableInfo::HasPrimaryKey() const {
+  for(auto& constraint : constraints){
+    if(constraint.definition.compare(0, 11, "primary key") == 0){
+      return true;
+    }
+  }
+  for(auto& column : columns){
+    if(column.definition.find("primary key") != std::string::npos){
+      return true;
+    }
+  }
+  return false;
+}
+
+void Catalog::ApplyStatement(const std::string& sql_statement){
+
+  std::string text, verb, object;
+  size_t pos;
+  if(ReadStatementType(sql_statement, text, pos, verb, object) == false){
+    return;
+  }
+
+  if(verb == "create" && object == "table"){
+    ApplyCreateTable(text, pos);
+  }
+  else if(verb == "alter" && object == "table"){
+    ApplyAlterTable(text, pos);
+  }
+  else if(verb == "drop" && object == "table"){
+    ApplyDropTable(text, pos);
+  }
+  else if(verb == "create" && object == "index"){
+    ApplyCreateIndex(text, pos);
+  }
+  else if(verb == "drop" && object == "index"){
+    ApplyDropIndex(text, pos);
+  }
+
+}
+
+const TableInfo* Catalog::FindTargetTable(const std::string& sql_statement) const {
+
+  // Plain checks keep no catalog
+  if(tables.empty()){
+    return nullptr;
+  }
+
+  std::string text, verb, object, name;
+  size_t pos;
+  if(ReadStatementType(sql_statement, text, pos, verb, object) == false){
+    return nullptr;
+  }
+
+  if(verb == "alter" && object == "table"){
+    ConsumeWords(text, pos, {"if", "exists"});
+    ConsumeWords(text, pos, {"only"});
+    name = ReadWord(text, pos);
+  }
+  else if(verb == "create" && object == "index"){
+    std::string index_name;
+    if(ReadIndexTarget(text, pos, index_name, name) == false){
+      return nullptr;
+    }
+  }
+  else {
+    return nullptr;
+  }
+
+  auto entry = tables.find(name);
+  return (entry == tables.end()) ? nullptr : &entry->second;
+}
+
+void Catalog::ApplyCreateTable(const std::string& sql_statement, size_t pos){
+  ConsumeWords(sql_statement, pos, {"if", "not", "exists"});
+
+  TableInfo table;
+  table.name = ReadWord(sql_statement, pos);
+  if(table.name.empty()){
+    return;
+  }
+
+  AddTableElements(table, sql_statement, pos);
+  tables[table.name] = table;
+}
+
+void Catalog::ApplyAlterTable(const std::string& sql_statement, size_t pos){
+  ConsumeWords(sql_statement, pos, {"if", "exists"});
+  ConsumeWords(sql_statement, pos, {"only"});
+
+  auto name = ReadWord(sql_statement, pos);
+  auto entry = tables.find(name);
+  if(entry == tables.end()){
+    return;
+  }
+
+  auto& table = entry->second;
+  for(auto& action : SplitTopLevel(Rest(sql_statement, pos))){
+    AlterTable(table, action);
+  }
+
+  // Renamed table
+  if(table.name != name){
+    auto renamed = table;
+    tables.erase(entry);
+    tables[renamed.name] = renamed;
+  }
+}
+
+void Catalog::ApplyDropTable(const std::string& sql_statement, size_t pos){
+  ConsumeWords(sql_statement, pos, {"if", "exists"});
+
+  for(auto& part : SplitTopLevel(Rest(sql_statement, pos))){
+    size_t cursor = 0;
+    tables.erase(ReadWord(part, cursor));
+  }
+}
+
+void Catalog::ApplyCreateIndex(const std::string& sql_statement, size_t pos){
+  bool unique = (sql_statement.compare(0, 14, "create unique ") == 0);
+
+  IndexInfo index;
+  std::string table_name;
+  if(ReadIndexTarget(sql_statement, pos, index.name, table_name) == false){
+    return;
+  }
+
+  auto entry = tables.find(table_name);
+  if(entry == tables.end()){
+    return;
+  }
+
+  index.definition = (unique ? "unique index " : "index ") + Rest(sql_statement, pos);
+  AddIndex(entry->second, index);
+}
+
+void Catalog::ApplyDropIndex(const std::string& sql_statement, size_t pos){
+  ConsumeWords(sql_statement, pos, {"concurrently"});
+  ConsumeWords(sql_statement, pos, {"if", "exists"});
+
+  auto name = ReadWord(sql_statement, pos);
+  for(auto& entry : tables){
+    RemoveIndex(entry.second, name);
+  }
+}
+
+void Catalog::Save(std::ostream& output) const {
+
+  output << CATALOG_VERSION << "\n";
+
+  for(auto& entry : tables){
+    auto& table = entry.second;
+    output << "table\t" << table.name << "\n";
+    for(auto& column : table.columns){
+      output << "column\t" << column.name << "\t" << column.definition << "\n";
+    }
+    for(auto& constraint : table.constraints){
+      output << "constraint\t" << constraint.name << "\t" << constraint.definition << "\n";
+    }
+    for(auto& index : table.indexes){
+      output << "index\t" << index.name << "\t" << index.definition << "\n";
+    }
+  }
+
+}
+
+bool Catalog::Load(std::istream& input){
+
+  std::string line;
+  if(!std::getline(input, line) || line != CATALOG_VERSION){
+    return false;
+  }
+
+  tables.clear();
+  TableInfo* table = nullptr;
+
+  while(std::getline(input, line)){
+    auto first_tab = line.find('\t');
+    if(first_tab == std::string::npos){
+      return false;
+    }
+
+    auto kind = line.substr(0, first_tab);
+    auto second_tab = line.find('\t', first_tab + 1);
+    auto name = line.substr(first_tab + 1, second_tab - first_tab - 1);
+    std::string definition;
+    if(second_tab != std::string::npos){
+      definition = line.substr(second_tab + 1);
+    }
+
+    if(kind == "table"){
+      table = &tables[name];
+      table->name = name;
+    }
+    else if(table == nullptr){
+      return false;
+    }
+    else if(kind == "column"){
+      table->columns.push_back(ColumnInfo{name, definition});
+    }
+    else if(kind == "constraint"){
+      table->constraints.push_back(ConstraintInfo{name, definition});
+    }
+    else if(kind == "index"){
+      table->indexes.push_back(IndexInfo{name, definition});
+    }
+    else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,163 @@
+// CHANGES SOURCE
+
+#include <algorithm>
+#include <cerrno>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "include/changes.h"
+#include "include/checker.h"
+#include "include/splitter.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Parse the "+start[,count]" part of a hunk header
+bool ParseNewRange(const std::string& header, size_t& start, size_t& count){
+  auto pos = header.find(" +");
+  if(pos == std::string::npos){
+    return false;
+  }
+
+  std::istringstream range(header.substr(pos + 2));
+  if(!(range >> start)){
+    return false;
+  }
+  count = 1;
+  if(range.peek() == ','){
+    range.get();
+    if(!(range >> count)){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Overlaps(const std::vector<LineRange>& changes,
+              const size_t first_line,
+              const size_t last_line){
+
+  // Changes are sorted by line; find the first one ending at or after the
+  // statement
+  auto change = std::lower_bound(changes.begin(), changes.end(), first_line,
+                                 [](const LineRange& range, const size_t line){
+                                   return range.last < line;
+                                 });
+  return change != changes.end() && change->first <= last_line;
+}
+
+}  // namespace
+
+std::vector<LineRange> ParseDiffHunks(std::istream& diff){
+
+  std::vector<LineRange> changes;
+  std::string line;
+  while(std::getline(diff, line)){
+    size_t start, count;
+    if(line.compare(0, 3, "@@ ") != 0 || ParseNewRange(line, start, count) == false){
+      continue;
+    }
+
+    if(count != 0){
+      changes.push_back(LineRange{start, start + count - 1});
+    }
+    else {
+      // Lines were removed between line start and the next one
+      changes.push_back(LineRange{start, start + 1});
+    }
+  }
+
+  std::sort(changes.begin(), changes.end(),
+            [](const LineRange& left, const LineRange& right){
+              return left.first < right.first;
+            });
+
+  // Merge overlapping ranges to keep them sorted by their last line too
+  std::vector<LineRange> merged;
+  for(auto& change : changes){
+    if(merged.empty() == false && change.first <= merged.back().last + 1){
+      merged.back().last = std::max(merged.back().last, change.last);
+    }
+    else {
+      merged.push_back(change);
+    }
+  }
+
+  return merged;
+}
+
+std::vector<LineRange> ChangedLines(const std::string& revision,
+                                    const std::string& file_name){
+
+  // Run git without a shell; the revision can never be read as an option
+  const char* arguments[] = {
+    "git", "diff", "--no-color", "--no-ext-diff", "--unified=0",
+    "--end-of-options", revision.c_str(), "--", file_name.c_str(), nullptr
+  };
+
+  int pipe_handles[2];
+  if(pipe(pipe_handles) != 0){
+    throw std::runtime_error("Could not run git diff");
+  }
+
+  pid_t pid = fork();
+  if(pid < 0){
+    close(pipe_handles[0]);
+    close(pipe_handles[1]);
+    throw std::runtime_error("Could not run git diff");
+  }
+  if(pid == 0){
+    dup2(pipe_handles[1], STDOUT_FILENO);
+    close(pipe_handles[0]);
+    close(pipe_handles[1]);
+    execvp(arguments[0], const_cast<char* const*>(arguments));
+    _exit(127);
+  }
+  close(pipe_handles[1]);
+
+  std::string output;
+  char buffer[4096];
+  while(true){
+    auto length = read(pipe_handles[0], buffer, sizeof(buffer));
+    if(length < 0 && errno == EINTR){
+      continue;
+    }
+    if(length <= 0){
+      break;
+    }
+    output.append(buffer, length);
+  }
+  close(pipe_handles[0]);
+
+  int status = 0;
+  while(waitpid(pid, &status, 0) < 0 && errno == EINTR){
+  }
+  if(WIFEXITED(status) == false || WEXITSTATUS(status) != 0){
+    throw std::runtime_error("Could not diff " + file_name + " against " + revision);
+  }
+
+  std::istringstream diff(output);
+  return ParseDiffHunks(diff);
+}
+
+void CheckChangedStream(Configuration& state,
+                        std::istream& input,
+                        const std::vector<LineRange>& changes){
+
+  StatementSplitter splitter(state, input);
+  std::string sql_statement;
+
+  while(splitter.Next(sql_statement)){
+    if(Overlaps(changes, splitter.FirstLine(), splitter.LastLine())){
+      CheckStatement(state, sql_statement);
+    }
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -9,17 +9,49 @@
 #include <cstdlib>
 #include <cctype>
 #include <functional>
-#include <regex>
 #include <map>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
 
 #include "checker.h"
 
 #include "include/configuration.h"
 #include "include/list.h"
 #include "include/color.h"
+#include "include/splitter.h"
+#include "include/workload.h"
+#include "include/budget.h"
+#include "include/cache.h"
+#include "include/changes.h"
+#include "include/checkpoint.h"
+#include "include/hash.h"
+#include "include/progress.h"
+
+#include <sys/stat.h>
 
 namespace sqlcheck {
 
+namespace {
+
+// Run the rules over a statement
+void CheckRules(Configuration& state,
+                const Statement& statement){
+
+  for(auto rule : GetRules(ClassifyStatement(statement))){
+    rule(state, statement);
+  }
+
+  // METRICS
+
+  if(state.metrics.IsOpen()){
+    AddMetrics(statement, state.statement_metrics);
+  }
+
+}
+
+}  // namespace
+
 void Check(Configuration& state) {
 
   std::unique_ptr<std::istream> input;
@@ -36,39 +68,159 @@ void Check(Configuration& state) {
     input.reset(new std::ifstream(state.file_name.c_str()));
   }
 
-  std::stringstream sql_statement;
-  size_t fragment_size = 4096;
-  char buffer[fragment_size];
+  // Lines changed since a revision
+  std::vector<LineRange> changes;
+  if(state.changed_since.empty() == false){
+    changes = ChangedLines(state.changed_since, state.file_name);
+  }
 
   std::cout << "==================== Results ===================\n";
 
-  // Go over the input stream
-  while(!input->eof()){
+  // Report progress on stderr
+  std::unique_ptr<ProgressReporter> progress;
+  if(state.progress == true){
+    struct stat file_stat;
+    unsigned long long total_bytes = 0;
+    if(state.testing_mode == false && state.file_name.empty() == false &&
+        stat(state.file_name.c_str(), &file_stat) == 0){
+      total_bytes = static_cast<unsigned long long>(file_stat.st_size);
+    }
+    progress.reset(new ProgressReporter(state, total_bytes));
+  }
+
+  // Check only the statements changed since a revision
+  if(state.changed_since.empty() == false){
+    CheckChangedStream(state, *input, changes);
+  }
+  // Spread the checked statements over the input within the time budget
+  else if(state.time_budget > 0){
+    CheckWithTimeBudget(state, *input);
+  }
+  // Periodically save the checker state of long checks
+  else if(state.checkpoint_file.empty() == false){
+    CheckStreamWithCheckpoints(state, *input);
+  }
+  // Answer unchanged files from the result cache
+  else if(state.result_cache == true && state.log_mode == false &&
+      state.write_baseline == false && state.metrics.IsOpen() == false &&
+      state.file_name.empty() == false){
+    CheckCachedStream(state, *input);
+  }
+  else {
+    CheckStream(state, *input);
+  }
+
+  progress.reset();
 
-    // Get a line from the input stream
-    input->getline(buffer, fragment_size);
-    std::string statement_fragment(buffer);
+  PrintSummary(state);
 
-    // Append fragment to statement
-    if(statement_fragment.empty() == false){
-      sql_statement << statement_fragment << " ";
-    }
+  // Skip destroying std::cin
+  if (state.file_name.empty()) {
+    input.release();
+  }
 
-    // Check for delimiter in line
-    std::size_t location = statement_fragment.find(state.delimiter);
-    if (location != std::string::npos) {
+}
+
+void CheckSample(Configuration& state,
+                 const std::function<void()>& check){
+
+  // Track the spread of the findings per statement for the estimates
+  const int risk_levels[] = {RISK_LEVEL_ALL, RISK_LEVEL_HIGH, RISK_LEVEL_MEDIUM,
+                             RISK_LEVEL_LOW, RISK_LEVEL_NONE};
+  int previous[5];
+  for(int level = 0; level < 5; level++){
+    previous[level] = state.checker_stats[risk_levels[level]];
+  }
+
+  check();
+  state.sampled_statements++;
+
+  for(int level = 0; level < 5; level++){
+    double findings = state.checker_stats[risk_levels[level]] - previous[level];
+    state.sampled_squares[risk_levels[level]] += findings * findings;
+  }
+
+}
 
-      // Check the statement
-      CheckStatement(state, sql_statement.str());
+void CheckStream(Configuration& state,
+                 std::istream& input) {
 
-      // Reset statement
-      sql_statement.str(std::string());
+  StatementSplitter splitter(state, input);
+  std::string sql_statement;
 
+  if(state.sample_rate >= 1.0 && state.reservoir_size == 0){
+    while(splitter.Next(sql_statement)){
+      CheckStatement(state, sql_statement);
     }
+    return;
+  }
+
+  splitter.SetSampling(state.sample_rate, state.reservoir_size);
+  while(splitter.Next(sql_statement)){
+    CheckSample(state, [&](){
+      CheckStatement(state, sql_statement);
+    });
+  }
+  state.scanned_statements += splitter.Statements();
+
+}
+
+// Extrapolate a count over the sampled statements to all statements, with
+// the half-width of its 95% confidence interval
+void EstimateCount(const Configuration& state,
+                   const int risk_level,
+                   double& estimate,
+                   double& margin){
+
+  double scanned = static_cast<double>(state.scanned_statements);
+  double sampled = static_cast<double>(state.sampled_statements);
+  double sum = state.checker_stats.count(risk_level) ? state.checker_stats.at(risk_level) : 0;
+  double squares = state.sampled_squares.count(risk_level) ? state.sampled_squares.at(risk_level) : 0;
+
+  double mean = sum / sampled;
+  double variance = 0;
+  if(sampled > 1){
+    variance = std::max(0.0, (squares - sampled * mean * mean) / (sampled - 1));
+  }
+
+  estimate = scanned * mean;
+  margin = 1.96 * scanned * std::sqrt(variance / sampled * (1.0 - sampled / scanned));
 
+}
+
+void PrintEstimates(const Configuration& state){
+
+  const std::vector<std::pair<int, std::string>> risk_levels = {
+    {RISK_LEVEL_ALL, "All Anti-Patterns and Hints  :: "},
+    {RISK_LEVEL_HIGH, ">  High Risk   :: "},
+    {RISK_LEVEL_MEDIUM, ">  Medium Risk :: "},
+    {RISK_LEVEL_LOW, ">  Low Risk    :: "},
+    {RISK_LEVEL_NONE, ">  Hints       :: "}
+  };
+
+  std::cout << "\n==================== Estimates =================\n";
+  std::cout << "Sampled      :: " << state.sampled_statements << " of "
+      << state.scanned_statements << " statements\n";
+
+  if(state.sampled_statements == 0){
+    return;
+  }
+
+  auto precision = std::cout.precision();
+  std::cout << std::fixed << std::setprecision(0);
+  for(auto& risk_level : risk_levels){
+    double estimate, margin;
+    EstimateCount(state, risk_level.first, estimate, margin);
+    std::cout << risk_level.second << "~" << estimate << " +/- " << margin << "\n";
   }
+  std::cout << "(95% confidence intervals)\n";
+  std::cout.unsetf(std::ios::fixed);
+  std::cout.precision(precision);
+
+}
+
+void PrintSummary(Configuration& state) {
 
-  // Print summary
   if(state.checker_stats[RISK_LEVEL_ALL] == 0){
     std::cout << "No issues found.\n";
   }
@@ -81,9 +233,25 @@ void Check(Configuration& state) {
     std::cout << ">  Hints       :: " << state.checker_stats[RISK_LEVEL_NONE] << "\n";
   }
 
-  // Skip destroying std::cin
-  if (state.file_name.empty()) {
-    input.release();
+  if(state.cancelled == true){
+    std::cout << "> Stopped at the first " << RiskLevelToString(state.fail_fast_level)
+        << " finding or above (fail fast)\n";
+  }
+
+  if(state.baselined_findings != 0){
+    std::cout << "> Suppressed by baseline :: " << state.baselined_findings << "\n";
+  }
+
+  if(state.scanned_statements != 0){
+    PrintEstimates(state);
+  }
+
+  if(state.total_ranges != 0){
+    PrintCoverage(state);
+  }
+
+  if(state.log_mode == true){
+    PrintWorkloadSummary(state);
   }
 
 }
@@ -143,16 +311,15 @@ std::string WrapText(const std::string& text){
 void PrintMessage(Configuration& state,
                   const std::string sql_statement,
                   const bool print_statement,
-                  const RiskLevel pattern_risk_level,
-                  const PatternType pattern_type,
-                  const std::string title,
-                  const std::string message){
+                  const Finding& finding){
 
   ColorModifier red(ColorCode::FG_RED, state.color_mode, true);
   ColorModifier green(ColorCode::FG_GREEN, state.color_mode, true);
   ColorModifier blue(ColorCode::FG_BLUE, state.color_mode, true);
   ColorModifier regular(ColorCode::FG_DEFAULT, state.color_mode, false);
 
+  auto title = PatternIdToString(finding.pattern_id);
+
   if(print_statement == true){
     std::cout << "\n-------------------------------------------------\n";
     ColorModifier regular(ColorCode::FG_DEFAULT, state.color_mode, false);
@@ -170,7 +337,7 @@ void PrintMessage(Configuration& state,
       std::cout << "[" << state.file_name << "]: ";
     }
 
-    std::cout << "(" << green << RiskLevelToString(pattern_risk_level) << regular << ") ";
+    std::cout << "(" << green << RiskLevelToString(finding.risk_level) << regular << ") ";
     std::cout << blue << title << regular << "\n";
   }
   else {
@@ -178,171 +345,233 @@ void PrintMessage(Configuration& state,
       std::cout << "[" << state.file_name << "]: ";
     }
 
-    std::cout << "(" << RiskLevelToString(pattern_risk_level) << ") ";
-    std::cout << "(" << PatternTypeToString(pattern_type) << ") ";
+    std::cout << "(" << RiskLevelToString(finding.risk_level) << ") ";
+    std::cout << "(" << PatternTypeToString(finding.pattern_type) << ") ";
     std::cout << title << "\n";
   }
 
   // Print detailed message only in verbose mode
   if(state.verbose == true){
-    std::cout << WrapText(message) << "\n";
+    std::cout << WrapText(finding.message) << "\n";
   }
 
-  // Update checker stats
-  state.checker_stats[pattern_risk_level]++;
-  state.checker_stats[RISK_LEVEL_ALL]++;
+  if(finding.exists == true){
+    if(state.color_mode == true){
+      std::cout << "[Matching Expression: " << blue << finding.match << regular << "]";
+    }
+    else{
+      std::cout << "[Matching Expression: " << finding.match << "]";
+    }
+    std::cout << "\n\n";
+  }
 
 }
 
-void CheckPattern(Configuration& state,
-                  const std::string& sql_statement,
-                  bool& print_statement,
-                  const std::regex& anti_pattern,
-                  const RiskLevel pattern_risk_level,
-                  const PatternType pattern_type,
-                  const std::string title,
-                  const std::string message,
-                  const bool exists,
-                  const size_t min_count){
-
-  //std::cout << "PATTERN LEVEL: " << pattern_risk_level << "\n";
-  //std::cout << "CHECKER LEVEL: " << state.log_level << "\n";
+// Drop the accepted findings of the current statement, or record them
+// when writing a new baseline
+void ApplyBaseline(Configuration& state){
 
-  // Check log level
-  if(pattern_risk_level < state.risk_level){
-    return;
-  }
+  auto fingerprint = HashString(state.statement);
 
-  bool found = false;
-  std::smatch match;
-  std::size_t count = 0;
-
-  try {
-    std::sregex_iterator next(sql_statement.begin(),
-                              sql_statement.end(),
-                              anti_pattern);
-    std::sregex_iterator end;
-    while (next != end) {
-      match = *next;
-      found = true;
-      count++;
-      next++;
+  if(state.write_baseline == true){
+    for(auto& finding : state.findings){
+      state.baseline_keys.push_back(BaselineKey(fingerprint, finding.pattern_id));
     }
-  } catch (std::regex_error& e) {
-    // Syntax error in the regular expression
+    return;
   }
 
-  if(found == exists && count > min_count){
-
-    PrintMessage(state,
-                 sql_statement,
-                 print_statement,
-                 pattern_risk_level,
-                 pattern_type,
-                 title,
-                 message);
-
-    if(exists == true){
-      ColorModifier blue(ColorCode::FG_BLUE, state.color_mode, true);
-      ColorModifier regular(ColorCode::FG_DEFAULT, state.color_mode, false);
-      if(state.color_mode == true){
-        std::cout << "[Matching Expression: " << blue << match.str(0) << regular << "]";
-      }
-      else{
-        std::cout << "[Matching Expression: " << match.str(0) << "]";
-      }
-      std::cout << "\n\n";
-    }
-
-    // TOGGLE PRINT STATEMENT
-    print_statement = false;
-  }
+  auto end = std::remove_if(state.findings.begin(),
+                            state.findings.end(),
+                            [&](const Finding& finding){
+                              return state.baseline.Contains(
+                                  BaselineKey(fingerprint, finding.pattern_id));
+                            });
+  state.baselined_findings += state.findings.end() - end;
+  state.findings.erase(end, state.findings.end());
 
 }
 
-void CheckStatement(Configuration& state,
+void ReportFindings(Configuration& state,
                     const std::string& sql_statement){
 
-  // TRANSFORM TO LOWER CASE
-  auto statement = sql_statement;
-
-  std::transform(statement.begin(),
-                 statement.end(),
-                 statement.begin(),
-                 ::tolower);
-
-  // REMOVE SPACE
-  statement = std::regex_replace(statement, std::regex("^ +| +$|( ) +"), "$1");
-
-  // RESET
   bool print_statement = true;
 
-  // LOGICAL DATABASE DESIGN
-
-  CheckMultiValuedAttribute(state, statement, print_statement);
-
-  CheckRecursiveDependency(state, statement, print_statement);
+  for(auto& finding : state.findings){
+    if(state.print_findings == true){
+      PrintMessage(state,
+                   sql_statement,
+                   print_statement,
+                   finding);
+    }
 
-  CheckPrimaryKeyExists(state, statement, print_statement);
+    // TOGGLE PRINT STATEMENT
+    print_statement = false;
 
-  CheckGenericPrimaryKey(state, statement, print_statement);
+    // Update checker stats
+    state.checker_stats[finding.risk_level]++;
+    state.checker_stats[RISK_LEVEL_ALL]++;
+    state.progress_findings.fetch_add(1, std::memory_order_relaxed);
 
-  CheckForeignKeyExists(state, statement, print_statement);
+    if(state.fail_fast == true && finding.risk_level >= state.fail_fast_level){
+      state.cancelled.store(true, std::memory_order_relaxed);
+    }
+  }
 
-  CheckVariableAttribute(state, statement, print_statement);
+}
 
-  CheckMetadataTribbles(state, statement, print_statement);
+// Strip leading and trailing spaces and collapse runs of spaces
+void CollapseSpaces(std::string& statement){
 
-  // PHYSICAL DATABASE DESIGN
+  size_t length = 0;
+  for(auto c : statement){
+    if(c == ' ' && (length == 0 || statement[length - 1] == ' ')){
+      continue;
+    }
+    statement[length++] = c;
+  }
+  if(length != 0 && statement[length - 1] == ' '){
+    length--;
+  }
+  statement.resize(length);
 
-  CheckFloat(state, statement, print_statement);
+}
 
-  CheckValuesInDefinition(state, statement, print_statement);
+void AddFinding(Configuration& state,
+                const RiskLevel pattern_level,
+                const PatternType pattern_type,
+                const PatternId pattern_id,
+                const std::string& message,
+                const std::string& match,
+                const bool exists){
 
-  CheckExternalFiles(state, statement, print_statement);
+  // Check log level
+  if(pattern_level < state.risk_level){
+    return;
+  }
 
-  CheckIndexCount(state, statement, print_statement);
+  state.findings.push_back(Finding{pattern_id,
+                                   pattern_level,
+                                   pattern_type,
+                                   message,
+                                   match,
+                                   exists});
 
-  CheckIndexAttributeOrder(state, statement, print_statement);
+}
 
-  // QUERY
+namespace {
 
-  CheckSelectStar(state, statement, print_statement);
+// Literals are masked in the shape of a query, so the rules that depend on
+// their values run again on each execution of a known shape; only the
+// patterns that the shape has not shown before are reported
+void CheckLiterals(Configuration& state,
+                   const std::string& statement,
+                   const uint64_t fingerprint){
 
-  CheckNullUsage(state, statement, print_statement);
+  state.findings.clear();
+  state.arena.Reset();
+  Statement parsed{statement, state.tokens, Parse(statement, state.tokens, state.arena)};
+  for(auto rule : GetLiteralRules()){
+    rule(state, parsed);
+  }
 
-  CheckNotNullUsage(state, statement, print_statement);
+  auto& pattern_ids = state.query_stats[fingerprint].pattern_ids;
+  state.findings.erase(std::remove_if(state.findings.begin(), state.findings.end(),
+                                      [&](const Finding& finding){
+                                        return std::find(pattern_ids.begin(),
+                                                         pattern_ids.end(),
+                                                         finding.pattern_id) !=
+                                            pattern_ids.end();
+                                      }),
+                       state.findings.end());
+  if(state.findings.empty()){
+    return;
+  }
 
-  CheckConcatenation(state, statement, print_statement);
+  if(state.baseline_file.empty() == false){
+    ApplyBaseline(state);
+  }
+  RecordFindings(state, fingerprint);
+  ReportFindings(state, statement);
+}
 
-  CheckGroupByUsage(state, statement, print_statement);
+}  // namespace
 
-  CheckOrderByRand(state, statement, print_statement);
+void CheckStatement(Configuration& state,
+                    const std::string& sql_statement){
 
-  CheckPatternMatching(state, statement, print_statement);
+  // TRANSFORM TO LOWER CASE
+  auto statement = sql_statement;
 
-  CheckSpaghettiQuery(state, statement, print_statement);
+  std::transform(statement.begin(),
+                 statement.end(),
+                 statement.begin(),
+                 ::tolower);
 
-  CheckJoinCount(state, statement, print_statement);
+  // REMOVE SPACE
+  CollapseSpaces(statement);
 
-  CheckDistinctCount(state, statement, print_statement);
+  state.statement = statement;
 
-  CheckImplicitColumns(state, statement, print_statement);
+  // Literals and comments are masked once by the lexer; the rules and the
+  // query shape only see tokens
+  Tokenize(statement, state.tokens, state.dialect);
 
-  CheckHaving(state, statement, print_statement);
+  // SKIP QUERIES SEEN BEFORE IN LOG MODE
+  uint64_t fingerprint = 0;
+  if(state.log_mode == true &&
+      RecordQuery(state, statement, state.tokens, fingerprint) == false){
+    CheckLiterals(state, statement, fingerprint);
+    return;
+  }
 
-  CheckNesting(state, statement, print_statement);
+  // RESET
+  state.findings.clear();
+  state.arena.Reset();
+  Statement parsed{statement, state.tokens, Parse(statement, state.tokens, state.arena)};
 
-  CheckOr(state, statement, print_statement);
+  if(state.metrics.IsOpen()){
+    ClearMetrics(state.statement_metrics, statement.size());
+  }
 
-  CheckUnion(state, statement, print_statement);
+  // Check the statements in the body of a routine individually, with
+  // their tokens sliced from the routine instead of lexed again
+  if(SplitRoutineBody(statement, state.tokens, state.dialect,
+                      state.body_tokens, state.body_statements)){
+    for(auto& body_statement : state.body_statements){
+      auto& first = state.body_tokens[body_statement.first];
+      auto& last = state.body_tokens[body_statement.last - 1];
+      state.body_text.assign(statement, first.offset, last.offset + last.length - first.offset);
+      state.body_statement_tokens.assign(state.body_tokens.begin() + body_statement.first,
+                                         state.body_tokens.begin() + body_statement.last);
+      auto offset = first.offset;
+      for(auto& token : state.body_statement_tokens){
+        token.offset -= offset;
+      }
+      Statement parsed_body{state.body_text, state.body_statement_tokens,
+                            Parse(state.body_text, state.body_statement_tokens, state.arena)};
+      CheckRules(state, parsed_body);
+    }
+  }
+  else {
+    CheckRules(state, parsed);
+  }
 
-  CheckDistinctJoin(state, statement, print_statement);
+  if(state.metrics.IsOpen()){
+    state.metrics.Write(state.log_mode ? fingerprint : HashString(statement),
+                        state.statement_metrics);
+  }
 
-  // APPLICATION
+  // BASELINE
+  if(state.baseline_file.empty() == false && state.findings.empty() == false){
+    ApplyBaseline(state);
+  }
 
-  CheckReadablePasswords(state, statement, print_statement);
+  // REPORT
+  if(state.log_mode == true){
+    RecordFindings(state, fingerprint);
+  }
 
+  ReportFindings(state, statement);
 
 }
 
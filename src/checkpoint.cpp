@@ -0,0 +1,338 @@
+// CHECKPOINT SOURCE
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "include/checkpoint.h"
+#include "include/cache.h"
+#include "include/checker.h"
+#include "include/hash.h"
+#include "include/splitter.h"
+#include "include/workload.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Bytes before the checkpoint offset that must be unchanged on resume
+const unsigned long long CHECKPOINT_TAIL_SIZE = 4096;
+
+// Hash the bytes of the input preceding an offset; leaves the input at
+// the offset
+uint64_t HashTail(std::istream& input, const unsigned long long offset){
+  auto start = offset > CHECKPOINT_TAIL_SIZE ? offset - CHECKPOINT_TAIL_SIZE : 0;
+  std::string tail(offset - start, '\0');
+
+  input.clear();
+  input.seekg(start);
+  if(tail.empty() == false && !input.read(&tail[0], tail.size())){
+    throw std::runtime_error("Input is shorter than the checkpoint offset");
+  }
+  return HashString(tail);
+}
+
+std::string ConfigurationKey(const Configuration& state){
+  return std::to_string(state.risk_level) + " " + std::to_string(state.log_mode) +
+      " " + std::to_string(state.top_k) + " " + state.delimiter +
+      " " + std::to_string(state.dialect) + " " + std::to_string(state.write_baseline) +
+      " " + std::to_string(state.baseline.ContentHash()) +
+      " " + std::to_string(state.metrics.IsOpen());
+}
+
+void WriteCheckpoint(const Configuration& state,
+                     const unsigned long long offset,
+                     const std::string& delimiter,
+                     const uint64_t tail_hash){
+
+  // Write to a temporary file first so that a crash while writing keeps
+  // the previous checkpoint
+  auto temporary_path = state.checkpoint_file + ".tmp";
+  {
+    std::ofstream output(temporary_path.c_str(), std::ios::binary);
+    if(!output){
+      std::cerr << "Could not write checkpoint: " << temporary_path << "\n";
+      return;
+    }
+    SaveCheckpoint(state, output, offset, delimiter, tail_hash);
+  }
+  std::rename(temporary_path.c_str(), state.checkpoint_file.c_str());
+}
+
+}  // namespace
+
+void SaveCheckpoint(const Configuration& state,
+                    std::ostream& output,
+                    const unsigned long long offset,
+                    const std::string& delimiter,
+                    const uint64_t tail_hash){
+
+  output << CHECKPOINT_VERSION << "\n";
+  WriteString(output, state.file_name);
+  WriteString(output, ConfigurationKey(state));
+  output << offset << " " << tail_hash << "\n";
+  WriteString(output, delimiter);
+
+  output << state.checker_stats.size() << "\n";
+  for(auto& entry : state.checker_stats){
+    output << entry.first << " " << entry.second << "\n";
+  }
+
+  // Workload aggregation (log mode)
+  output << state.executions << " " << state.query_stats.size() << "\n";
+  for(auto& entry : state.query_stats){
+    output << entry.first << " " << entry.second.executions << " "
+        << entry.second.pattern_ids.size();
+    for(auto pattern_id : entry.second.pattern_ids){
+      output << " " << pattern_id;
+    }
+    output << " ";
+    WriteString(output, entry.second.query);
+  }
+
+  output << state.pattern_ranks.size() << "\n";
+  for(auto& entry : state.pattern_ranks){
+    output << entry.first << " " << entry.second.executions << " "
+        << entry.second.queries << "\n";
+  }
+
+  auto& query_counters = state.query_sketch.Counters();
+  output << state.query_sketch.Capacity() << " " << query_counters.size() << "\n";
+  for(auto& counter : query_counters){
+    output << counter.key << " " << counter.count << " " << counter.error << "\n";
+  }
+
+  auto& pattern_counters = state.pattern_sketch.Counters();
+  output << state.pattern_sketch.Capacity() << " " << pattern_counters.size() << "\n";
+  for(auto& counter : pattern_counters){
+    output << counter.key.fingerprint << " " << counter.key.pattern_id << " "
+        << counter.count << " " << counter.error << "\n";
+  }
+
+  state.query_shapes.Save(output);
+  output << state.pattern_shapes.size() << "\n";
+  for(auto& entry : state.pattern_shapes){
+    output << entry.first << " ";
+    entry.second.Save(output);
+  }
+
+  // Baseline suppression and the keys of a baseline being written
+  output << state.baselined_findings << " " << state.baseline_keys.size() << "\n";
+  for(auto key : state.baseline_keys){
+    output << key << "\n";
+  }
+
+  // Metrics written so far; a resumed check drops the lines written after
+  // the checkpoint
+  output << state.metrics.Statements() << " " << state.metrics.Size() << "\n";
+}
+
+bool LoadCheckpoint(Configuration& state,
+                    std::istream& input,
+                    unsigned long long& offset,
+                    std::string& delimiter,
+                    uint64_t& tail_hash){
+
+  std::string line, file_name, configuration_key;
+  if(!std::getline(input, line) || line != CHECKPOINT_VERSION ||
+      ReadString(input, file_name) == false ||
+      ReadString(input, configuration_key) == false){
+    return false;
+  }
+
+  if(file_name != state.file_name || configuration_key != ConfigurationKey(state)){
+    throw std::runtime_error("Checkpoint " + state.checkpoint_file +
+                             " was written for another input or configuration");
+  }
+
+  size_t count;
+  if(!(input >> offset >> tail_hash) || input.get() != '\n' ||
+      ReadString(input, delimiter) == false || !(input >> count)){
+    return false;
+  }
+  state.checker_stats.clear();
+  for(size_t itr = 0; itr < count; itr++){
+    int risk_level, findings;
+    if(!(input >> risk_level >> findings)){
+      return false;
+    }
+    state.checker_stats[risk_level] = findings;
+  }
+
+  if(!(input >> state.executions >> count)){
+    return false;
+  }
+  state.query_stats.clear();
+  state.query_clusters = LshClusters();
+  for(size_t itr = 0; itr < count; itr++){
+    uint64_t fingerprint;
+    size_t pattern_count;
+    QueryStats query_stats;
+    if(!(input >> fingerprint >> query_stats.executions >> pattern_count)){
+      return false;
+    }
+    for(size_t pattern = 0; pattern < pattern_count; pattern++){
+      int pattern_id;
+      if(!(input >> pattern_id)){
+        return false;
+      }
+      query_stats.pattern_ids.push_back(static_cast<PatternId>(pattern_id));
+    }
+    if(input.get() != ' ' || ReadString(input, query_stats.query) == false){
+      return false;
+    }
+    state.query_stats[fingerprint] = query_stats;
+
+    // Clusters are rebuilt from the normalized queries
+    if(state.cluster_queries == true){
+      ClusterQuery(state, fingerprint, query_stats.query);
+    }
+  }
+
+  if(!(input >> count)){
+    return false;
+  }
+  state.pattern_ranks.clear();
+  for(size_t itr = 0; itr < count; itr++){
+    int pattern_id;
+    PatternRank rank;
+    if(!(input >> pattern_id >> rank.executions >> rank.queries)){
+      return false;
+    }
+    rank.pattern_id = static_cast<PatternId>(pattern_id);
+    state.pattern_ranks[rank.pattern_id] = rank;
+  }
+
+  size_t capacity;
+  if(!(input >> capacity >> count)){
+    return false;
+  }
+  std::vector<SpaceSaving<uint64_t>::Counter> query_counters(count);
+  for(auto& counter : query_counters){
+    if(!(input >> counter.key >> counter.count >> counter.error)){
+      return false;
+    }
+  }
+  state.query_sketch.Restore(capacity, query_counters);
+
+  if(!(input >> capacity >> count)){
+    return false;
+  }
+  std::vector<SpaceSaving<QueryPattern, QueryPatternHash>::Counter> pattern_counters(count);
+  for(auto& counter : pattern_counters){
+    int pattern_id;
+    if(!(input >> counter.key.fingerprint >> pattern_id >> counter.count >> counter.error)){
+      return false;
+    }
+    counter.key.pattern_id = static_cast<PatternId>(pattern_id);
+  }
+  state.pattern_sketch.Restore(capacity, pattern_counters);
+
+  if(state.query_shapes.Load(input) == false || !(input >> count)){
+    return false;
+  }
+  state.pattern_shapes.clear();
+  for(size_t itr = 0; itr < count; itr++){
+    int pattern_id;
+    if(!(input >> pattern_id) ||
+        state.pattern_shapes[static_cast<PatternId>(pattern_id)].Load(input) == false){
+      return false;
+    }
+  }
+
+  if(!(input >> state.baselined_findings >> count)){
+    return false;
+  }
+  state.baseline_keys.resize(count);
+  for(auto& key : state.baseline_keys){
+    if(!(input >> key)){
+      return false;
+    }
+  }
+
+  unsigned long long metrics_statements, metrics_size;
+  if(!(input >> metrics_statements >> metrics_size)){
+    return false;
+  }
+  if(state.metrics.IsOpen()){
+    state.metrics.Restore(metrics_statements, metrics_size);
+  }
+
+  return true;
+}
+
+void CheckStreamWithCheckpoints(Configuration& state,
+                                std::istream& input){
+
+  // Delimiter at the resume offset, which DELIMITER directives before it
+  // may have changed
+  auto delimiter = state.delimiter;
+
+  if(state.resume == true){
+    std::ifstream checkpoint(state.checkpoint_file.c_str(), std::ios::binary);
+    unsigned long long offset;
+    uint64_t tail_hash;
+    if(!checkpoint){
+      std::cerr << "No checkpoint found: " << state.checkpoint_file
+          << ", starting from the beginning\n";
+      if(state.metrics.IsOpen()){
+        state.metrics.Restore(0, 0);
+      }
+    }
+    else if(LoadCheckpoint(state, checkpoint, offset, delimiter, tail_hash) == false){
+      throw std::runtime_error("Could not read checkpoint: " + state.checkpoint_file);
+    }
+    else if(HashTail(input, offset) != tail_hash){
+      throw std::runtime_error("Input changed since checkpoint: " + state.checkpoint_file);
+    }
+    else {
+      std::cout << "Resuming at byte " << offset << "\n";
+    }
+  }
+
+  auto interval = std::chrono::seconds(state.checkpoint_interval);
+  auto last_checkpoint = std::chrono::steady_clock::now();
+
+  StatementSplitter splitter(state, input);
+  splitter.SetDelimiter(delimiter);
+  std::string sql_statement;
+  while(splitter.Next(sql_statement)){
+    CheckStatement(state, sql_statement);
+
+    auto now = std::chrono::steady_clock::now();
+    if(now - last_checkpoint < interval){
+      continue;
+    }
+
+    // Streams that cannot seek are not checkpointed
+    auto position = input.tellg();
+    if(position < 0 && input.eof()){
+      input.clear();
+      position = input.seekg(0, std::ios::end).tellg();
+    }
+    if(position < 0){
+      continue;
+    }
+
+    // Resume at the first byte the splitter has not consumed; the rest of
+    // its last line may still hold statements that were not checked
+    auto offset = splitter.Offset();
+    auto tail_hash = HashTail(input, offset);
+    input.seekg(position);
+    if(state.metrics.IsOpen()){
+      state.metrics.Flush();
+    }
+    WriteCheckpoint(state, offset, splitter.Delimiter(), tail_hash);
+    last_checkpoint = now;
+  }
+
+  // A finished check does not need to be resumed
+  if(state.cancelled == false){
+    std::remove(state.checkpoint_file.c_str());
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,165 @@
+// COMPARE SOURCE
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include "include/compare.h"
+#include "include/checker.h"
+#include "include/hash.h"
+
+namespace sqlcheck {
+
+namespace {
+
+unsigned long long CountExecutions(const std::unordered_map<uint64_t, QueryStats>& query_stats){
+  unsigned long long executions = 0;
+  for(auto& entry : query_stats){
+    executions += entry.second.executions;
+  }
+  return executions;
+}
+
+// Aggregate a query log in log mode without reporting its findings
+void CollectQueryStats(const Configuration& state,
+                       const std::string& file_name,
+                       std::unordered_map<uint64_t, QueryStats>& query_stats){
+
+  std::ifstream input(file_name.c_str());
+  if(!input){
+    throw std::runtime_error("Could not open query log: " + file_name);
+  }
+
+  Configuration log_conf;
+  log_conf.file_name = file_name;
+  log_conf.delimiter = state.delimiter;
+  log_conf.dialect = state.dialect;
+  log_conf.risk_level = state.risk_level;
+  log_conf.log_mode = true;
+  log_conf.print_findings = false;
+
+  CheckStream(log_conf, input);
+
+  query_stats.swap(log_conf.query_stats);
+}
+
+void PrintFindings(const std::string& title,
+                   const std::vector<ComparedFinding>& findings){
+
+  const size_t query_width = 60;
+
+  std::cout << "> " << title << " (" << findings.size() << ")\n";
+  for(auto& finding : findings){
+    auto query = finding.query;
+    if(query.size() > query_width){
+      query = query.substr(0, query_width) + "...";
+    }
+
+    std::cout << std::setw(12) << finding.before << " -> " << std::setw(12) << finding.after
+        << " :: [" << HashToString(finding.fingerprint) << "] "
+        << PatternIdToString(finding.pattern_id) << "\n";
+    std::cout << std::setw(32) << "" << query << "\n";
+  }
+
+}
+
+}  // namespace
+
+Comparison CompareQueryStats(const std::unordered_map<uint64_t, QueryStats>& before,
+                             const std::unordered_map<uint64_t, QueryStats>& after){
+
+  Comparison comparison;
+  comparison.before_executions = CountExecutions(before);
+  comparison.after_executions = CountExecutions(after);
+
+  // Join by query shape and anti-pattern
+  std::unordered_map<QueryPattern, ComparedFinding, QueryPatternHash> findings;
+  for(auto& entry : before){
+    for(auto pattern_id : entry.second.pattern_ids){
+      findings[QueryPattern{entry.first, pattern_id}] =
+          ComparedFinding{entry.first, pattern_id, entry.second.query,
+                          entry.second.executions, 0};
+    }
+  }
+  for(auto& entry : after){
+    for(auto pattern_id : entry.second.pattern_ids){
+      auto key = QueryPattern{entry.first, pattern_id};
+      auto finding = findings.find(key);
+      if(finding != findings.end()){
+        finding->second.after = entry.second.executions;
+      }
+      else {
+        findings[key] = ComparedFinding{entry.first, pattern_id, entry.second.query,
+                                        0, entry.second.executions};
+      }
+    }
+  }
+
+  for(auto& entry : findings){
+    auto& finding = entry.second;
+    if(finding.before == 0){
+      comparison.new_findings.push_back(finding);
+      continue;
+    }
+    if(finding.after == 0){
+      comparison.fixed_findings.push_back(finding);
+      continue;
+    }
+
+    // Compare the shares of the executions, since the logs may cover
+    // different periods
+    double before_share = static_cast<double>(finding.before) / comparison.before_executions;
+    double after_share = static_cast<double>(finding.after) / comparison.after_executions;
+    if(after_share >= before_share * COMPARE_FREQUENCY_FACTOR ||
+        before_share >= after_share * COMPARE_FREQUENCY_FACTOR){
+      comparison.changed_findings.push_back(finding);
+    }
+  }
+
+  auto by_executions = [](const ComparedFinding& left, const ComparedFinding& right){
+    auto left_executions = std::max(left.before, left.after);
+    auto right_executions = std::max(right.before, right.after);
+    if(left_executions != right_executions){
+      return left_executions > right_executions;
+    }
+    if(left.fingerprint != right.fingerprint){
+      return left.fingerprint < right.fingerprint;
+    }
+    return left.pattern_id < right.pattern_id;
+  };
+  std::sort(comparison.new_findings.begin(), comparison.new_findings.end(), by_executions);
+  std::sort(comparison.fixed_findings.begin(), comparison.fixed_findings.end(), by_executions);
+  std::sort(comparison.changed_findings.begin(), comparison.changed_findings.end(), by_executions);
+
+  return comparison;
+}
+
+Comparison CheckCompare(Configuration& state){
+
+  std::unordered_map<uint64_t, QueryStats> before;
+  std::unordered_map<uint64_t, QueryStats> after;
+  CollectQueryStats(state, state.compare_before_file_name, before);
+  CollectQueryStats(state, state.compare_after_file_name, after);
+
+  auto comparison = CompareQueryStats(before, after);
+
+  std::cout << "==================== Comparison ================\n";
+  std::cout << "Executions   :: " << comparison.before_executions << " -> "
+      << comparison.after_executions << "\n";
+
+  if(comparison.new_findings.empty() && comparison.fixed_findings.empty() &&
+      comparison.changed_findings.empty()){
+    std::cout << "No differences found.\n";
+    return comparison;
+  }
+
+  PrintFindings("New anti-patterns", comparison.new_findings);
+  PrintFindings("Fixed anti-patterns", comparison.fixed_findings);
+  PrintFindings("Changed frequency", comparison.changed_findings);
+
+  return comparison;
+}
+
+}  // namespace sqlcheck
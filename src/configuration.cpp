@@ -68,6 +68,75 @@ std::string PatternTypeToString(const PatternType& pattern_type){
 
 }
 
+std::string PatternIdToString(const PatternId& pattern_id){
+
+  switch (pattern_id) {
+    case PATTERN_ID_MULTI_VALUED_ATTRIBUTE:
+      return "Multi-Valued Attribute";
+    case PATTERN_ID_RECURSIVE_DEPENDENCY:
+      return "Recursive Dependency";
+    case PATTERN_ID_PRIMARY_KEY_EXISTS:
+      return "Primary Key Does Not Exist";
+    case PATTERN_ID_GENERIC_PRIMARY_KEY:
+      return "Generic Primary Key";
+    case PATTERN_ID_FOREIGN_KEY_EXISTS:
+      return "Foreign Key Does Not Exist";
+    case PATTERN_ID_VARIABLE_ATTRIBUTE:
+      return "Entity-Attribute-Value Pattern";
+    case PATTERN_ID_METADATA_TRIBBLES:
+      return "Metadata Tribbles";
+    case PATTERN_ID_FLOAT:
+      return "Imprecise Data Type";
+    case PATTERN_ID_VALUES_IN_DEFINITION:
+      return "Values In Definition";
+    case PATTERN_ID_EXTERNAL_FILES:
+      return "Files Are Not SQL Data Types";
+    case PATTERN_ID_INDEX_COUNT:
+      return "Too Many Indexes";
+    case PATTERN_ID_INDEX_ATTRIBUTE_ORDER:
+      return "Index Attribute Order";
+    case PATTERN_ID_SELECT_STAR:
+      return "SELECT *";
+    case PATTERN_ID_NULL_USAGE:
+      return "NULL Usage";
+    case PATTERN_ID_NOT_NULL_USAGE:
+      return "NOT NULL Usage";
+    case PATTERN_ID_CONCATENATION:
+      return "String Concatenation";
+    case PATTERN_ID_GROUP_BY_USAGE:
+      return "GROUP BY Usage";
+    case PATTERN_ID_ORDER_BY_RAND:
+      return "ORDER BY RAND Usage";
+    case PATTERN_ID_PATTERN_MATCHING:
+      return "Pattern Matching Usage";
+    case PATTERN_ID_SPAGHETTI_QUERY:
+      return "Spaghetti Query Alert";
+    case PATTERN_ID_JOIN_COUNT:
+      return "Reduce Number of JOINs";
+    case PATTERN_ID_DISTINCT_COUNT:
+      return "Eliminate Unnecessary DISTINCT Conditions";
+    case PATTERN_ID_IMPLICIT_COLUMNS:
+      return "Implicit Column Usage";
+    case PATTERN_ID_HAVING:
+      return "HAVING Clause Usage";
+    case PATTERN_ID_NESTING:
+      return "Nested sub queries";
+    case PATTERN_ID_OR:
+      return "OR Usage";
+    case PATTERN_ID_UNION:
+      return "UNION Usage";
+    case PATTERN_ID_DISTINCT_JOIN:
+      return "DISTINCT & JOIN Usage";
+    case PATTERN_ID_READABLE_PASSWORDS:
+      return "Readable Passwords";
+
+    case PATTERN_ID_INVALID:
+    default:
+      return "INVALID";
+  }
+
+}
+
 std::string GetBooleanString(const bool& status){
   if(status == true){
     return "ENABLED";
@@ -111,4 +180,124 @@ void ValidateDelimiter(const Configuration &state) {
          state.delimiter.c_str());
 }
 
+void ValidateDialect(const Configuration &state) {
+  if (state.dialect != DIALECT_GENERIC) {
+    printf("> %s :: %s\n", "DIALECT      ",
+           GetLexerTable(state.dialect).name);
+  }
+}
+
+void ValidateMigrationDir(const Configuration &state) {
+  if (state.migration_dir.empty() == false) {
+    printf("> %s :: %s\n", "MIGRATION DIR",
+           state.migration_dir.c_str());
+    printf("> %s :: %s\n", "CACHE DIR    ",
+           state.cache_dir.c_str());
+  }
+}
+
+void ValidateResultCache(const Configuration &state) {
+  if (state.result_cache == true) {
+    printf("> %s :: %s\n", "RESULT CACHE ", state.cache_dir.c_str());
+  }
+}
+
+void ValidateChangedSince(const Configuration &state) {
+  if (state.changed_since.empty() == false) {
+    printf("> %s :: %s\n", "CHANGED SINCE", state.changed_since.c_str());
+  }
+}
+
+void ValidateWatchDir(const Configuration &state) {
+  if (state.watch_dir.empty() == false) {
+    printf("> %s :: %s\n", "WATCH DIR    ", state.watch_dir.c_str());
+  }
+}
+
+void ValidateCheckpoint(const Configuration &state) {
+  if (state.checkpoint_file.empty() == false) {
+    printf("> %s :: %s%s\n", "CHECKPOINT   ", state.checkpoint_file.c_str(),
+           state.resume ? " (RESUME)" : "");
+  }
+}
+
+void ValidateBaseline(const Configuration &state) {
+  if (state.baseline_file.empty() == false) {
+    printf("> %s :: %s%s\n", "BASELINE     ", state.baseline_file.c_str(),
+           state.write_baseline ? " (WRITE)" : "");
+  }
+}
+
+void ValidateMetrics(const Configuration &state) {
+  if (state.metrics_file.empty() == false) {
+    printf("> %s :: %s\n", "METRICS      ", state.metrics_file.c_str());
+  }
+}
+
+void ValidateDiff(const Configuration &state) {
+  if (state.diff_old_file_name.empty() == false) {
+    printf("> %s :: %s -> %s\n", "SCHEMA DIFF  ",
+           state.diff_old_file_name.c_str(),
+           state.diff_new_file_name.c_str());
+  }
+}
+
+void ValidateCompare(const Configuration &state) {
+  if (state.compare_before_file_name.empty() == false) {
+    printf("> %s :: %s -> %s\n", "COMPARE      ",
+           state.compare_before_file_name.c_str(),
+           state.compare_after_file_name.c_str());
+  }
+}
+
+void ValidateSampling(const Configuration &state) {
+  if (state.reservoir_size != 0) {
+    printf("> %s :: %lu statements\n", "RESERVOIR    ",
+           (unsigned long) state.reservoir_size);
+  }
+  else if (state.sample_rate < 1.0) {
+    printf("> %s :: %g\n", "SAMPLE RATE  ", state.sample_rate);
+  }
+}
+
+void ValidateTimeBudget(const Configuration &state) {
+  if (state.time_budget > 0) {
+    printf("> %s :: %gs\n", "TIME BUDGET  ", state.time_budget);
+  }
+}
+
+void ValidateFailFast(const Configuration &state) {
+  if (state.fail_fast == true) {
+    printf("> %s :: %s\n", "FAIL FAST    ",
+           RiskLevelToString(state.fail_fast_level).c_str());
+  }
+}
+
+void ValidateProgress(const Configuration &state) {
+  if (state.progress == true) {
+    printf("> %s :: %s\n", "PROGRESS     ", "ENABLED (stderr)");
+  }
+}
+
+void ValidateLogMode(const Configuration &state) {
+  if (state.log_mode == true) {
+    printf("> %s :: %s\n", "LOG MODE     ",
+           GetBooleanString(state.log_mode).c_str());
+  }
+}
+
+void ValidateTopK(const Configuration &state) {
+  if (state.top_k != 0) {
+    printf("> %s :: %lu\n", "TOP QUERIES  ",
+           (unsigned long) state.top_k);
+  }
+}
+
+void ValidateClusters(const Configuration &state) {
+  if (state.cluster_queries == true) {
+    printf("> %s :: %s\n", "CLUSTERS     ",
+           GetBooleanString(state.cluster_queries).c_str());
+  }
+}
+
 }  // namespace sqlcheck
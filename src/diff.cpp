@@ -0,0 +1,347 @@
+// DIFF SOURCE
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <stdexcept>
+
+#include "include/diff.h"
+#include "include/checker.h"
+#include "include/hash.h"
+#include "include/splitter.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Unnamed constraints and indexes are matched by the hash of their definition
+std::string ElementKey(const std::string& name, const std::string& definition){
+  if(name.empty() == false){
+    return name;
+  }
+  return "#" + HashToString(HashString(definition));
+}
+
+template <typename Element>
+uint64_t HashElements(const std::vector<Element>& elements, uint64_t hash){
+  for(auto& element : elements){
+    hash = HashString(element.name + "\t" + element.definition + "\n", hash);
+  }
+  return hash;
+}
+
+uint64_t HashTable(const TableInfo& table){
+  uint64_t hash = HashString(table.name + "\n");
+  hash = HashElements(table.columns, HashString("columns\n", hash));
+  hash = HashElements(table.constraints, HashString("constraints\n", hash));
+  hash = HashElements(table.indexes, HashString("indexes\n", hash));
+  return hash;
+}
+
+template <typename Element>
+void DiffElements(const std::vector<Element>& old_elements,
+                  const std::vector<Element>& new_elements,
+                  const ObjectType object_type,
+                  const std::string& table_name,
+                  std::vector<SchemaChange>& changes){
+
+  // Identical unnamed elements share a key, so each match consumes one of
+  // them
+  std::multimap<std::string, size_t> unmatched;
+  for(size_t itr = 0; itr < old_elements.size(); itr++){
+    auto& element = old_elements[itr];
+    unmatched.insert(std::make_pair(ElementKey(element.name, element.definition), itr));
+  }
+
+  std::vector<bool> matched(old_elements.size(), false);
+  for(auto& element : new_elements){
+    auto key = ElementKey(element.name, element.definition);
+    auto match = unmatched.find(key);
+    if(match == unmatched.end()){
+      changes.push_back(SchemaChange{CHANGE_TYPE_ADDED, object_type, table_name,
+                                     element.name, "", element.definition});
+      continue;
+    }
+    auto& old_element = old_elements[match->second];
+    if(old_element.definition != element.definition){
+      changes.push_back(SchemaChange{CHANGE_TYPE_MODIFIED, object_type, table_name,
+                                     element.name, old_element.definition,
+                                     element.definition});
+    }
+    matched[match->second] = true;
+    unmatched.erase(match);
+  }
+
+  for(size_t itr = 0; itr < old_elements.size(); itr++){
+    if(matched[itr] == false){
+      auto& element = old_elements[itr];
+      changes.push_back(SchemaChange{CHANGE_TYPE_REMOVED, object_type, table_name,
+                                     element.name, element.definition, ""});
+    }
+  }
+
+}
+
+std::string ColumnDefinition(const ColumnInfo& column){
+  return column.name + " " + column.definition;
+}
+
+std::string ConstraintDefinition(const ConstraintInfo& constraint){
+  if(constraint.name.empty()){
+    return constraint.definition;
+  }
+  return "constraint " + constraint.name + " " + constraint.definition;
+}
+
+std::string CreateTableStatement(const TableInfo& table){
+  std::vector<std::string> elements;
+  for(auto& column : table.columns){
+    elements.push_back(ColumnDefinition(column));
+  }
+  for(auto& constraint : table.constraints){
+    elements.push_back(ConstraintDefinition(constraint));
+  }
+  for(auto& index : table.indexes){
+    elements.push_back(index.definition);
+  }
+
+  std::string statement = "create table " + table.name + " (";
+  for(size_t itr = 0; itr < elements.size(); itr++){
+    statement += (itr == 0 ? "" : ", ") + elements[itr];
+  }
+  return statement + ");";
+}
+
+std::string ChangeTypeToString(const ChangeType& change_type){
+  switch (change_type) {
+    case CHANGE_TYPE_ADDED:
+      return "+";
+    case CHANGE_TYPE_REMOVED:
+      return "-";
+    case CHANGE_TYPE_MODIFIED:
+      return "~";
+
+    case CHANGE_TYPE_INVALID:
+    default:
+      return "?";
+  }
+}
+
+std::string ObjectTypeToString(const ObjectType& object_type){
+  switch (object_type) {
+    case OBJECT_TYPE_TABLE:
+      return "TABLE     ";
+    case OBJECT_TYPE_COLUMN:
+      return "COLUMN    ";
+    case OBJECT_TYPE_CONSTRAINT:
+      return "CONSTRAINT";
+    case OBJECT_TYPE_INDEX:
+      return "INDEX     ";
+
+    case OBJECT_TYPE_INVALID:
+    default:
+      return "INVALID   ";
+  }
+}
+
+// Highlight removals that are likely to hurt
+std::string ChangeNote(const SchemaChange& change){
+  if(change.change_type != CHANGE_TYPE_REMOVED){
+    return "";
+  }
+
+  switch (change.object_type) {
+    case OBJECT_TYPE_TABLE:
+      return "Table dropped";
+    case OBJECT_TYPE_INDEX:
+      return "Index dropped";
+    case OBJECT_TYPE_CONSTRAINT:
+      if(change.old_definition.compare(0, 11, "primary key") == 0){
+        return "Primary key dropped";
+      }
+      if(change.old_definition.compare(0, 11, "foreign key") == 0){
+        return "Foreign key dropped";
+      }
+      return "Constraint dropped";
+
+    default:
+      return "";
+  }
+}
+
+void PrintChange(const SchemaChange& change){
+  std::cout << ChangeTypeToString(change.change_type) << " "
+      << ObjectTypeToString(change.object_type) << " " << change.table_name;
+  if(change.object_type != OBJECT_TYPE_TABLE && change.name.empty() == false){
+    std::cout << "." << change.name;
+  }
+
+  switch (change.change_type) {
+    case CHANGE_TYPE_ADDED:
+      if(change.object_type != OBJECT_TYPE_TABLE){
+        std::cout << " :: " << change.new_definition;
+      }
+      break;
+    case CHANGE_TYPE_REMOVED:
+      if(change.object_type != OBJECT_TYPE_TABLE){
+        std::cout << " :: " << change.old_definition;
+      }
+      break;
+    case CHANGE_TYPE_MODIFIED:
+      std::cout << " :: " << change.old_definition << " -> " << change.new_definition;
+      break;
+    default:
+      break;
+  }
+
+  auto note = ChangeNote(change);
+  if(note.empty() == false){
+    std::cout << " [" << note << "]";
+  }
+  std::cout << "\n";
+}
+
+}  // namespace
+
+void BuildCatalog(Configuration& state,
+                  const std::string& file_name,
+                  Catalog& catalog){
+
+  std::ifstream input(file_name.c_str());
+  if(!input){
+    throw std::runtime_error("Could not open DDL file: " + file_name);
+  }
+
+  StatementSplitter splitter(state, input);
+  std::string sql_statement;
+  while(splitter.Next(sql_statement)){
+    std::transform(sql_statement.begin(),
+                   sql_statement.end(),
+                   sql_statement.begin(),
+                   ::tolower);
+    catalog.ApplyStatement(sql_statement);
+  }
+
+}
+
+std::vector<SchemaChange> DiffCatalogs(const Catalog& old_catalog,
+                                       const Catalog& new_catalog){
+
+  std::vector<SchemaChange> changes;
+
+  for(auto& entry : old_catalog.tables){
+    if(new_catalog.tables.count(entry.first) == 0){
+      changes.push_back(SchemaChange{CHANGE_TYPE_REMOVED, OBJECT_TYPE_TABLE, entry.first,
+                                     entry.first, CreateTableStatement(entry.second), ""});
+    }
+  }
+
+  for(auto& entry : new_catalog.tables){
+    auto& new_table = entry.second;
+    auto old_entry = old_catalog.tables.find(entry.first);
+    if(old_entry == old_catalog.tables.end()){
+      changes.push_back(SchemaChange{CHANGE_TYPE_ADDED, OBJECT_TYPE_TABLE, entry.first,
+                                     entry.first, "", CreateTableStatement(new_table)});
+      continue;
+    }
+
+    // Skip unchanged tables without comparing their elements
+    auto& old_table = old_entry->second;
+    if(HashTable(old_table) == HashTable(new_table)){
+      continue;
+    }
+
+    DiffElements(old_table.columns, new_table.columns,
+                 OBJECT_TYPE_COLUMN, entry.first, changes);
+    DiffElements(old_table.constraints, new_table.constraints,
+                 OBJECT_TYPE_CONSTRAINT, entry.first, changes);
+    DiffElements(old_table.indexes, new_table.indexes,
+                 OBJECT_TYPE_INDEX, entry.first, changes);
+  }
+
+  return changes;
+}
+
+std::vector<SchemaChange> CheckDiff(Configuration& state){
+
+  Catalog old_catalog;
+  Catalog new_catalog;
+  BuildCatalog(state, state.diff_old_file_name, old_catalog);
+  BuildCatalog(state, state.diff_new_file_name, new_catalog);
+
+  auto changes = DiffCatalogs(old_catalog, new_catalog);
+
+  std::cout << "==================== Schema Diff ===============\n";
+
+  if(changes.empty()){
+    std::cout << "No schema changes.\n";
+  }
+  std::set<std::string> dropped_primary_keys;
+  for(auto& change : changes){
+    PrintChange(change);
+    if(ChangeNote(change) == "Primary key dropped"){
+      dropped_primary_keys.insert(change.table_name);
+    }
+  }
+
+  // Primary keys declared inline are lost by modifying the column
+  for(auto& entry : new_catalog.tables){
+    auto old_entry = old_catalog.tables.find(entry.first);
+    if(old_entry != old_catalog.tables.end() &&
+        dropped_primary_keys.count(entry.first) == 0 &&
+        old_entry->second.HasPrimaryKey() && entry.second.HasPrimaryKey() == false){
+      std::cout << "! TABLE      " << entry.first << " [Primary key lost]\n";
+    }
+  }
+
+  // Collect the added and modified objects of each table
+  std::map<std::string, std::vector<std::string>> alterations;
+  std::vector<std::string> created_tables;
+  for(auto& change : changes){
+    if(change.change_type == CHANGE_TYPE_REMOVED){
+      continue;
+    }
+    switch (change.object_type) {
+      case OBJECT_TYPE_TABLE:
+        created_tables.push_back(change.new_definition);
+        break;
+      case OBJECT_TYPE_COLUMN:
+        alterations[change.table_name].push_back(
+            "add column " + change.name + " " + change.new_definition);
+        break;
+      case OBJECT_TYPE_CONSTRAINT:
+        alterations[change.table_name].push_back(
+            "add " + ConstraintDefinition(ConstraintInfo{change.name, change.new_definition}));
+        break;
+      case OBJECT_TYPE_INDEX:
+        alterations[change.table_name].push_back("add " + change.new_definition);
+        break;
+      default:
+        break;
+    }
+  }
+
+  std::cout << "==================== Results ===================\n";
+
+  state.file_name = state.diff_new_file_name;
+
+  for(auto& statement : created_tables){
+    CheckStatement(state, statement);
+  }
+
+  for(auto& entry : alterations){
+    std::string statement = "alter table " + entry.first + " ";
+    for(size_t itr = 0; itr < entry.second.size(); itr++){
+      statement += (itr == 0 ? "" : ", ") + entry.second[itr];
+    }
+    CheckStatement(state, statement + ";");
+  }
+
+  PrintSummary(state);
+
+  return changes;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,37 @@
+// HASH SOURCE
+
+#include <cstdio>
+
+#include "include/hash.h"
+
+namespace sqlcheck {
+
+uint64_t HashString(const std::string& data,
+                    const uint64_t seed){
+  return HashBytes(data.data(), data.size(), seed);
+}
+
+uint64_t HashBytes(const char* data,
+                   const size_t length,
+                   const uint64_t seed){
+
+  const uint64_t prime = 1099511628211ULL;
+  uint64_t hash = seed;
+
+  for(size_t itr = 0; itr < length; itr++){
+    hash ^= static_cast<unsigned char>(data[itr]);
+    hash *= prime;
+  }
+
+  return hash;
+}
+
+std::string HashToString(const uint64_t hash){
+
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long) hash);
+
+  return std::string(buffer);
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,56 @@
+// BASELINE HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+// Key of a finding in the baseline: statement fingerprint and rule id
+uint64_t BaselineKey(const uint64_t fingerprint, const int pattern_id);
+
+// Accepted findings, stored as an open-addressing hash table of keys that
+// is memory-mapped so that lookups do not depend on the baseline size
+class Baseline {
+
+ public:
+
+  Baseline();
+
+  ~Baseline();
+
+  Baseline(const Baseline&) = delete;
+
+  Baseline& operator=(const Baseline&) = delete;
+
+  // Map a baseline file, replacing a previously mapped one; throws if it
+  // cannot be read
+  void Open(const std::string& file_name);
+
+  // Unmap the baseline file
+  void Close();
+
+  bool Contains(const uint64_t key) const;
+
+  // Hash of the baseline contents
+  uint64_t ContentHash() const;
+
+  // Write the set of keys as a baseline file
+  static void Write(const std::string& file_name,
+                    std::vector<uint64_t> keys);
+
+ private:
+
+  // mapped file
+  void* mapping_;
+  size_t mapping_size_;
+
+  // hash table slots (0 marks an empty slot)
+  const uint64_t* slots_;
+  uint64_t slot_count_;
+
+};
+
+}  // namespace sqlcheck
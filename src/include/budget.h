@@ -0,0 +1,32 @@
+// BUDGET HEADER
+
+#pragma once
+
+#include <istream>
+#include <string>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Maximum number of byte ranges the input is divided into
+const size_t BUDGET_MAX_RANGES = 65536;
+
+// Minimum size of a byte range
+const unsigned long long BUDGET_MIN_RANGE_SIZE = 4096;
+
+// Parse a duration such as 30s, 500ms or 2m into seconds
+double ParseDuration(const std::string& duration);
+
+// Check the SQL statements in a seekable stream within the time budget;
+// the input is divided into byte ranges that are visited in an order that
+// keeps the covered ranges evenly spread over the input. A range starts
+// at the first statement boundary after its first byte, found without
+// reading the input before it.
+void CheckWithTimeBudget(Configuration& state,
+                         std::istream& input);
+
+// Print the share of the input covered within the time budget
+void PrintCoverage(const Configuration& state);
+
+}  // namespace sqlcheck
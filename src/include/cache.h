@@ -0,0 +1,40 @@
+// CACHE HEADER
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Version of the result cache format
+const std::string RESULT_CACHE_VERSION = "sqlcheck-results 2";
+
+// Findings in a statement
+struct StatementFindings {
+
+  std::string statement;
+  std::vector<Finding> findings;
+
+};
+
+// Serialize a string with its length since it may span lines
+void WriteString(std::ostream& output, const std::string& value);
+
+bool ReadString(std::istream& input, std::string& value);
+
+// Cache key of the results of checking the given contents: covers the
+// contents, the rule set and the configuration that affects the findings
+uint64_t ResultCacheKey(const Configuration& state,
+                        const std::string& contents);
+
+// Check the SQL statements in a stream, replaying the cached findings if
+// the same contents were checked before; returns true on a cache hit
+bool CheckCachedStream(Configuration& state,
+                       std::istream& input);
+
+}  // namespace sqlcheck
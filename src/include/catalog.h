@@ -0,0 +1,87 @@
+// CATALOG HEADER
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+// Version of the catalog format and of the DDL interpretation behind it
+const std::string CATALOG_VERSION = "sqlcheck-catalog 1";
+
+// Column definition
+struct ColumnInfo {
+
+  std::string name;
+  std::string definition;
+
+};
+
+// Table-level constraint (primary key, foreign key, unique, check)
+struct ConstraintInfo {
+
+  std::string name;
+  std::string definition;
+
+};
+
+// Index, either declared inline or through CREATE INDEX
+struct IndexInfo {
+
+  std::string name;
+  std::string definition;
+
+};
+
+// Table definition
+struct TableInfo {
+
+  std::string name;
+  std::vector<ColumnInfo> columns;
+  std::vector<ConstraintInfo> constraints;
+  std::vector<IndexInfo> indexes;
+
+  // Check if the table declares a primary key (inline or as a constraint)
+  bool HasPrimaryKey() const;
+
+};
+
+// Schema catalog built up from DDL statements
+class Catalog {
+ public:
+
+  // Apply a lower-cased DDL statement; other statements are ignored
+  void ApplyStatement(const std::string& sql_statement);
+
+  // Table that a lower-cased ALTER TABLE or CREATE INDEX statement
+  // changes, or null if the catalog does not have it
+  const TableInfo* FindTargetTable(const std::string& sql_statement) const;
+
+  // Serialize the catalog
+  void Save(std::ostream& output) const;
+
+  // Deserialize the catalog; returns false on a format mismatch
+  bool Load(std::istream& input);
+
+  // tables indexed by name
+  std::map<std::string, TableInfo> tables;
+
+ private:
+
+  void ApplyCreateTable(const std::string& sql_statement, size_t pos);
+
+  void ApplyAlterTable(const std::string& sql_statement, size_t pos);
+
+  void ApplyDropTable(const std::string& sql_statement, size_t pos);
+
+  void ApplyCreateIndex(const std::string& sql_statement, size_t pos);
+
+  void ApplyDropIndex(const std::string& sql_statement, size_t pos);
+
+};
+
+}  // namespace sqlcheck
@@ -0,0 +1,34 @@
+// CHANGES HEADER
+
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Range of changed lines in the current version of a file (1-based)
+struct LineRange {
+
+  size_t first;
+  size_t last;
+
+};
+
+// Parse the hunk headers of a unified diff into the changed line ranges
+// of the new file; deletions mark the lines around them
+std::vector<LineRange> ParseDiffHunks(std::istream& diff);
+
+// Lines of a file changed since a git revision
+std::vector<LineRange> ChangedLines(const std::string& revision,
+                                    const std::string& file_name);
+
+// Check only the statements overlapping the changed lines
+void CheckChangedStream(Configuration& state,
+                        std::istream& input,
+                        const std::vector<LineRange>& changes);
+
+}  // namespace sqlcheck
@@ -2,7 +2,7 @@
 
 #pragma once
 
-#include <regex>
+#include <functional>
 
 #include "configuration.h"
 
@@ -11,20 +11,33 @@ namespace sqlcheck {
 // Check a set of SQL statements
 void Check(Configuration& state);
 
+// Check the SQL statements in a stream
+void CheckStream(Configuration& state,
+                 std::istream& input);
+
+// Check or replay one statement of a sampled check, tracking the spread
+// of its findings for the estimates
+void CheckSample(Configuration& state,
+                 const std::function<void()>& check);
+
+// Print the summary of the checker stats
+void PrintSummary(Configuration& state);
+
 // Check a SQL statement
 void CheckStatement(Configuration& state,
                     const std::string& sql_statement);
 
-// Check a pattern
-void CheckPattern(Configuration& state,
-                  const std::string& sql_statement,
-                  bool& print_statement,
-                  const std::regex& anti_pattern,
-                  const RiskLevel pattern_level,
-                  const PatternType pattern_type,
-                  const std::string title,
-                  const std::string message,
-                  const bool exists,
-                  const size_t min_count = 0);
+// Print the findings in a statement
+void ReportFindings(Configuration& state,
+                    const std::string& sql_statement);
+
+// Record a finding in the current statement
+void AddFinding(Configuration& state,
+                const RiskLevel pattern_level,
+                const PatternType pattern_type,
+                const PatternId pattern_id,
+                const std::string& message,
+                const std::string& match,
+                const bool exists);
 
 }  // namespace machine
@@ -0,0 +1,38 @@
+// CHECKPOINT HEADER
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Version of the checkpoint format
+const std::string CHECKPOINT_VERSION = "sqlcheck-checkpoint 5";
+
+// Serialize the checker state after the statement ending at the given
+// offset of the input, with the delimiter in effect there
+void SaveCheckpoint(const Configuration& state,
+                    std::ostream& output,
+                    const unsigned long long offset,
+                    const std::string& delimiter,
+                    const uint64_t tail_hash);
+
+// Deserialize the checker state; throws if the checkpoint was written for
+// another input or configuration, returns false on a format mismatch
+bool LoadCheckpoint(Configuration& state,
+                    std::istream& input,
+                    unsigned long long& offset,
+                    std::string& delimiter,
+                    uint64_t& tail_hash);
+
+// Check the SQL statements in a stream, periodically writing a checkpoint
+// of the checker state; in resume mode the check continues from the last
+// checkpoint
+void CheckStreamWithCheckpoints(Configuration& state,
+                                std::istream& input);
+
+}  // namespace sqlcheck
@@ -0,0 +1,46 @@
+// COMPARE HEADER
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Factor by which the share of executions exhibiting an anti-pattern must
+// change to be reported
+const double COMPARE_FREQUENCY_FACTOR = 2.0;
+
+// Executions of a query shape exhibiting an anti-pattern in both inputs
+struct ComparedFinding {
+
+  uint64_t fingerprint;
+  PatternId pattern_id;
+  std::string query;
+  unsigned long long before;
+  unsigned long long after;
+
+};
+
+// Findings that appeared, disappeared or changed in frequency
+struct Comparison {
+
+  unsigned long long before_executions = 0;
+  unsigned long long after_executions = 0;
+  std::vector<ComparedFinding> new_findings;
+  std::vector<ComparedFinding> fixed_findings;
+  std::vector<ComparedFinding> changed_findings;
+
+};
+
+// Join the query stats of two workloads by query shape and anti-pattern
+Comparison CompareQueryStats(const std::unordered_map<uint64_t, QueryStats>& before,
+                             const std::unordered_map<uint64_t, QueryStats>& after);
+
+// Check two query logs and report the differences in their findings
+Comparison CheckCompare(Configuration& state);
+
+}  // namespace sqlcheck
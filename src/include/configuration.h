@@ -2,12 +2,23 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <memory>
 #include <map>
+#include <vector>
+#include <unordered_map>
+
+#include "baseline.h"
+#include "catalog.h"
+#include "lexer.h"
+#include "metrics.h"
+#include "parser.h"
+#include "sketch.h"
 
 namespace sqlcheck {
 
@@ -34,6 +45,48 @@ enum PatternType {
 
 };
 
+enum PatternId {
+  PATTERN_ID_INVALID = 0,
+
+  // Logical database design
+  PATTERN_ID_MULTI_VALUED_ATTRIBUTE = 1001,
+  PATTERN_ID_RECURSIVE_DEPENDENCY = 1002,
+  PATTERN_ID_PRIMARY_KEY_EXISTS = 1003,
+  PATTERN_ID_GENERIC_PRIMARY_KEY = 1004,
+  PATTERN_ID_FOREIGN_KEY_EXISTS = 1005,
+  PATTERN_ID_VARIABLE_ATTRIBUTE = 1006,
+  PATTERN_ID_METADATA_TRIBBLES = 1007,
+
+  // Physical database design
+  PATTERN_ID_FLOAT = 2001,
+  PATTERN_ID_VALUES_IN_DEFINITION = 2002,
+  PATTERN_ID_EXTERNAL_FILES = 2003,
+  PATTERN_ID_INDEX_COUNT = 2004,
+  PATTERN_ID_INDEX_ATTRIBUTE_ORDER = 2005,
+
+  // Query
+  PATTERN_ID_SELECT_STAR = 3001,
+  PATTERN_ID_NULL_USAGE = 3002,
+  PATTERN_ID_NOT_NULL_USAGE = 3003,
+  PATTERN_ID_CONCATENATION = 3004,
+  PATTERN_ID_GROUP_BY_USAGE = 3005,
+  PATTERN_ID_ORDER_BY_RAND = 3006,
+  PATTERN_ID_PATTERN_MATCHING = 3007,
+  PATTERN_ID_SPAGHETTI_QUERY = 3008,
+  PATTERN_ID_JOIN_COUNT = 3009,
+  PATTERN_ID_DISTINCT_COUNT = 3010,
+  PATTERN_ID_IMPLICIT_COLUMNS = 3011,
+  PATTERN_ID_HAVING = 3012,
+  PATTERN_ID_NESTING = 3013,
+  PATTERN_ID_OR = 3014,
+  PATTERN_ID_UNION = 3015,
+  PATTERN_ID_DISTINCT_JOIN = 3016,
+
+  // Application
+  PATTERN_ID_READABLE_PASSWORDS = 4001
+
+};
+
 // Checker stats
 struct CheckerStats {
 
@@ -46,6 +99,56 @@ struct CheckerStats {
 
 };
 
+// Anti-pattern found in a statement
+struct Finding {
+
+  PatternId pattern_id;
+  RiskLevel risk_level;
+  PatternType pattern_type;
+  std::string message;
+  std::string match;
+  bool exists;
+
+};
+
+// Query stats (log mode)
+struct QueryStats {
+
+  unsigned long long executions = 0;
+  std::string query;
+  std::vector<PatternId> pattern_ids;
+
+};
+
+// Anti-pattern weighted by the executions of the queries exhibiting it
+struct PatternRank {
+
+  PatternId pattern_id = PATTERN_ID_INVALID;
+  unsigned long long executions = 0;
+  unsigned long long queries = 0;
+
+};
+
+// Query shape exhibiting an anti-pattern (log mode)
+struct QueryPattern {
+
+  uint64_t fingerprint;
+  PatternId pattern_id;
+
+  bool operator==(const QueryPattern& other) const {
+    return fingerprint == other.fingerprint && pattern_id == other.pattern_id;
+  }
+
+};
+
+struct QueryPatternHash {
+
+  size_t operator()(const QueryPattern& query_pattern) const {
+    return query_pattern.fingerprint ^ (query_pattern.pattern_id * 0x9e3779b97f4a7c15ULL);
+  }
+
+};
+
 class Configuration {
  public:
 
@@ -55,9 +158,47 @@ class Configuration {
      color_mode(true),
      file_name(""),
      delimiter(";"),
+     dialect(DIALECT_GENERIC),
      risk_level(RiskLevel::RISK_LEVEL_ALL),
      verbose(false),
-     testing_mode(false) {
+     testing_mode(false),
+     migration_dir(""),
+     cache_dir(".sqlcheck-cache"),
+     result_cache(false),
+     changed_since(""),
+     watch_dir(""),
+     checkpoint_file(""),
+     checkpoint_interval(60),
+     resume(false),
+     baseline_file(""),
+     write_baseline(false),
+     baselined_findings(0),
+     metrics_file(""),
+     compare_before_file_name(""),
+     compare_after_file_name(""),
+     print_findings(true),
+     sample_rate(1.0),
+     reservoir_size(0),
+     scanned_statements(0),
+     sampled_statements(0),
+     time_budget(0),
+     covered_bytes(0),
+     total_bytes(0),
+     covered_ranges(0),
+     total_ranges(0),
+     fail_fast(false),
+     fail_fast_level(RiskLevel::RISK_LEVEL_NONE),
+     cancelled(false),
+     progress(false),
+     progress_bytes(0),
+     progress_statements(0),
+     progress_findings(0),
+     diff_old_file_name(""),
+     diff_new_file_name(""),
+     log_mode(false),
+     top_k(0),
+     executions(0),
+     cluster_queries(false) {
   }
 
   // color mode
@@ -69,6 +210,9 @@ class Configuration {
   // query delimiter
   std::string delimiter;
 
+  // SQL dialect (quoting, comments and batch separators)
+  Dialect dialect;
+
   // risk level
   RiskLevel risk_level;
 
@@ -84,6 +228,147 @@ class Configuration {
   /// checker stats
   std::map<int, int> checker_stats;
 
+  // migration directory
+  std::string migration_dir;
+
+  // cache directory
+  std::string cache_dir;
+
+  // reuse the cached results of unchanged files
+  bool result_cache;
+
+  // check only the statements changed since this git revision
+  std::string changed_since;
+
+  // directory to re-check whenever its files change
+  std::string watch_dir;
+
+  // file to periodically save the checker state to
+  std::string checkpoint_file;
+
+  // seconds between checkpoints
+  unsigned int checkpoint_interval;
+
+  // resume from the checkpoint
+  bool resume;
+
+  // baseline of accepted findings
+  std::string baseline_file;
+  Baseline baseline;
+
+  // record the findings as the new baseline instead of suppressing them
+  bool write_baseline;
+  std::vector<uint64_t> baseline_keys;
+
+  // findings suppressed by the baseline
+  unsigned long long baselined_findings;
+
+  // complexity metrics of the checked statements, and of the current one
+  std::string metrics_file;
+  MetricsWriter metrics;
+  StatementMetrics statement_metrics;
+
+  // query logs to compare
+  std::string compare_before_file_name;
+  std::string compare_after_file_name;
+
+  // print the findings of each statement
+  bool print_findings;
+
+  // probability of checking a statement (Bernoulli sampling)
+  double sample_rate;
+
+  // number of statements to check (reservoir sampling, 0 = all)
+  size_t reservoir_size;
+
+  // statements read and checked (sampling mode)
+  unsigned long long scanned_statements;
+  unsigned long long sampled_statements;
+
+  // sum of the squared findings per checked statement (sampling mode)
+  std::map<int, double> sampled_squares;
+
+  // seconds to spend checking (0 = unlimited)
+  double time_budget;
+
+  // input covered within the time budget
+  unsigned long long covered_bytes;
+  unsigned long long total_bytes;
+  size_t covered_ranges;
+  size_t total_ranges;
+
+  // stop at the first finding of at least the given risk level
+  bool fail_fast;
+  RiskLevel fail_fast_level;
+
+  // set to stop reading the input
+  std::atomic<bool> cancelled;
+
+  // report progress on stderr
+  bool progress;
+
+  // progress counters, read by the progress reporter
+  std::atomic<unsigned long long> progress_bytes;
+  std::atomic<unsigned long long> progress_statements;
+  std::atomic<unsigned long long> progress_findings;
+
+  // schema catalog
+  Catalog catalog;
+
+  // schema diff inputs
+  std::string diff_old_file_name;
+  std::string diff_new_file_name;
+
+  // current statement (lower-cased, with collapsed spaces)
+  std::string statement;
+
+  // tokens of the current statement
+  std::vector<Token> tokens;
+
+  // node allocator for the syntax tree of the current statement
+  Arena arena;
+
+  // tokens and statements of the body of the current routine, and the
+  // text and tokens of the body statement being checked
+  std::vector<Token> body_tokens;
+  std::vector<BodyStatement> body_statements;
+  std::string body_text;
+  std::vector<Token> body_statement_tokens;
+
+  // findings in the current statement
+  std::vector<Finding> findings;
+
+  // log mode
+  bool log_mode;
+
+  // query stats indexed by fingerprint (log mode)
+  std::unordered_map<uint64_t, QueryStats> query_stats;
+
+  // number of query shapes to track with fixed memory (log mode, 0 = all)
+  size_t top_k;
+
+  // query executions (log mode)
+  unsigned long long executions;
+
+  // anti-patterns weighted by executions (log mode)
+  std::map<PatternId, PatternRank> pattern_ranks;
+
+  // heaviest query shapes (top-k log mode)
+  SpaceSaving<uint64_t> query_sketch;
+
+  // heaviest (query shape, anti-pattern) pairs (top-k log mode)
+  SpaceSaving<QueryPattern, QueryPatternHash> pattern_sketch;
+
+  // distinct query shapes (log mode)
+  HyperLogLog query_shapes;
+
+  // distinct query shapes per anti-pattern (log mode)
+  std::map<PatternId, HyperLogLog> pattern_shapes;
+
+  // group near-duplicate query shapes into clusters (log mode)
+  bool cluster_queries;
+  LshClusters query_clusters;
+
 };
 
 std::string RiskLevelToString(const RiskLevel& risk_level);
@@ -92,6 +377,8 @@ std::string RiskLevelToDetailedString(const RiskLevel& risk_level);
 
 std::string PatternTypeToString(const PatternType& pattern_type);
 
+std::string PatternIdToString(const PatternId& pattern_id);
+
 void ValidateRiskLevel(const Configuration &state);
 
 void ValidateFileName(const Configuration &state);
@@ -102,5 +389,39 @@ void ValidateVerbose(const Configuration &state);
 
 void ValidateDelimiter(const Configuration &state);
 
+void ValidateDialect(const Configuration &state);
+
+void ValidateMigrationDir(const Configuration &state);
+
+void ValidateResultCache(const Configuration &state);
+
+void ValidateChangedSince(const Configuration &state);
+
+void ValidateWatchDir(const Configuration &state);
+
+void ValidateCheckpoint(const Configuration &state);
+
+void ValidateBaseline(const Configuration &state);
+
+void ValidateMetrics(const Configuration &state);
+
+void ValidateDiff(const Configuration &state);
+
+void ValidateCompare(const Configuration &state);
+
+void ValidateSampling(const Configuration &state);
+
+void ValidateTimeBudget(const Configuration &state);
+
+void ValidateFailFast(const Configuration &state);
+
+void ValidateProgress(const Configuration &state);
+
+void ValidateLogMode(const Configuration &state);
+
+void ValidateTopK(const Configuration &state);
+
+void ValidateClusters(const Configuration &state);
+
 
 }  // namespace sqlcheck
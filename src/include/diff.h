@@ -0,0 +1,56 @@
+// DIFF HEADER
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+enum ChangeType {
+  CHANGE_TYPE_INVALID = 0,
+
+  CHANGE_TYPE_ADDED = 1,
+  CHANGE_TYPE_REMOVED = 2,
+  CHANGE_TYPE_MODIFIED = 3
+
+};
+
+enum ObjectType {
+  OBJECT_TYPE_INVALID = 0,
+
+  OBJECT_TYPE_TABLE = 1,
+  OBJECT_TYPE_COLUMN = 2,
+  OBJECT_TYPE_CONSTRAINT = 3,
+  OBJECT_TYPE_INDEX = 4
+
+};
+
+// Difference between two schema catalogs
+struct SchemaChange {
+
+  ChangeType change_type;
+  ObjectType object_type;
+  std::string table_name;
+  std::string name;
+  std::string old_definition;
+  std::string new_definition;
+
+};
+
+// Build a schema catalog from a DDL file
+void BuildCatalog(Configuration& state,
+                  const std::string& file_name,
+                  Catalog& catalog);
+
+// Compute the differences between two catalogs
+std::vector<SchemaChange> DiffCatalogs(const Catalog& old_catalog,
+                                       const Catalog& new_catalog);
+
+// Print the differences between two DDL files and check the design
+// rules on the added or modified objects only
+std::vector<SchemaChange> CheckDiff(Configuration& state);
+
+}  // namespace sqlcheck
@@ -0,0 +1,25 @@
+// HASH HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace sqlcheck {
+
+// Seed for a fresh hash chain
+const uint64_t HASH_SEED = 14695981039346656037ULL;
+
+// Hash a byte string (64-bit FNV-1a), optionally chained from a previous hash
+uint64_t HashString(const std::string& data,
+                    const uint64_t seed = HASH_SEED);
+
+// Hash a byte range in place, such as a mapped file
+uint64_t HashBytes(const char* data,
+                   const size_t length,
+                   const uint64_t seed = HASH_SEED);
+
+// Fixed-width hexadecimal representation of a hash
+std::string HashToString(const uint64_t hash);
+
+}  // namespace sqlcheck
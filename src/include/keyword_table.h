@@ -0,0 +1,288 @@
+// KEYWORD TABLE HEADER
+// Generated by script/keywords.py from KeywordId in lexer.h; do not edit
+
+#pragma once
+
+#include "lexer.h"
+
+namespace sqlcheck {
+
+// Multipliers of the first, second and last byte and of the length
+const uint32_t KEYWORD_HASH_FIRST = 0xC3ECFA4Fu;
+const uint32_t KEYWORD_HASH_SECOND = 0x9CC7C2ADu;
+const uint32_t KEYWORD_HASH_LAST = 0xBACD5561u;
+const uint32_t KEYWORD_HASH_LENGTH = 0x7700C157u;
+
+const unsigned KEYWORD_HASH_BITS = 8;
+const size_t KEYWORD_MIN_LENGTH = 2;
+const size_t KEYWORD_MAX_LENGTH = 10;
+
+struct KeywordEntry {
+
+  const char* word;
+  uint8_t length;
+  KeywordId keyword;
+
+};
+
+// Keywords indexed by their hash
+const KeywordEntry KEYWORD_HASH_TABLE[1u << KEYWORD_HASH_BITS] = {
+  {"double", 6, KEYWORD_DOUBLE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"left", 4, KEYWORD_LEFT},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"end", 3, KEYWORD_END},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"constraint", 10, KEYWORD_CONSTRAINT},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"enum", 4, KEYWORD_ENUM},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"create", 6, KEYWORD_CREATE},
+  {"", 0, KEYWORD_NONE},
+  {"primary", 7, KEYWORD_PRIMARY},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"temporary", 9, KEYWORD_TEMPORARY},
+  {"outer", 5, KEYWORD_OUTER},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"with", 4, KEYWORD_WITH},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"text", 4, KEYWORD_TEXT},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"varchar", 7, KEYWORD_VARCHAR},
+  {"", 0, KEYWORD_NONE},
+  {"insert", 6, KEYWORD_INSERT},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"float", 5, KEYWORD_FLOAT},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"if", 2, KEYWORD_IF},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"distinct", 8, KEYWORD_DISTINCT},
+  {"not", 3, KEYWORD_NOT},
+  {"table", 5, KEYWORD_TABLE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"except", 6, KEYWORD_EXCEPT},
+  {"join", 4, KEYWORD_JOIN},
+  {"", 0, KEYWORD_NONE},
+  {"inner", 5, KEYWORD_INNER},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"from", 4, KEYWORD_FROM},
+  {"order", 5, KEYWORD_ORDER},
+  {"", 0, KEYWORD_NONE},
+  {"default", 7, KEYWORD_DEFAULT},
+  {"any", 3, KEYWORD_ANY},
+  {"", 0, KEYWORD_NONE},
+  {"asc", 3, KEYWORD_ASC},
+  {"select", 6, KEYWORD_SELECT},
+  {"view", 4, KEYWORD_VIEW},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"by", 2, KEYWORD_BY},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"between", 7, KEYWORD_BETWEEN},
+  {"", 0, KEYWORD_NONE},
+  {"full", 4, KEYWORD_FULL},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"unique", 6, KEYWORD_UNIQUE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"values", 6, KEYWORD_VALUES},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"key", 3, KEYWORD_KEY},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"using", 5, KEYWORD_USING},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"desc", 4, KEYWORD_DESC},
+  {"", 0, KEYWORD_NONE},
+  {"exists", 6, KEYWORD_EXISTS},
+  {"", 0, KEYWORD_NONE},
+  {"union", 5, KEYWORD_UNION},
+  {"null", 4, KEYWORD_NULL},
+  {"as", 2, KEYWORD_AS},
+  {"on", 2, KEYWORD_ON},
+  {"like", 4, KEYWORD_LIKE},
+  {"right", 5, KEYWORD_RIGHT},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"intersect", 9, KEYWORD_INTERSECT},
+  {"", 0, KEYWORD_NONE},
+  {"foreign", 7, KEYWORD_FOREIGN},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"all", 3, KEYWORD_ALL},
+  {"into", 4, KEYWORD_INTO},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"then", 4, KEYWORD_THEN},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"index", 5, KEYWORD_INDEX},
+  {"regexp", 6, KEYWORD_REGEXP},
+  {"update", 6, KEYWORD_UPDATE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"is", 2, KEYWORD_IS},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"references", 10, KEYWORD_REFERENCES},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"to", 2, KEYWORD_TO},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"group", 5, KEYWORD_GROUP},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"case", 4, KEYWORD_CASE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"similar", 7, KEYWORD_SIMILAR},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"real", 4, KEYWORD_REAL},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"where", 5, KEYWORD_WHERE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"column", 6, KEYWORD_COLUMN},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"cross", 5, KEYWORD_CROSS},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"add", 3, KEYWORD_ADD},
+  {"", 0, KEYWORD_NONE},
+  {"offset", 6, KEYWORD_OFFSET},
+  {"", 0, KEYWORD_NONE},
+  {"check", 5, KEYWORD_CHECK},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"delete", 6, KEYWORD_DELETE},
+  {"", 0, KEYWORD_NONE},
+  {"or", 2, KEYWORD_OR},
+  {"alter", 5, KEYWORD_ALTER},
+  {"when", 4, KEYWORD_WHEN},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"set", 3, KEYWORD_SET},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"in", 2, KEYWORD_IN},
+  {"limit", 5, KEYWORD_LIMIT},
+  {"", 0, KEYWORD_NONE},
+  {"drop", 4, KEYWORD_DROP},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"having", 6, KEYWORD_HAVING},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"and", 3, KEYWORD_AND},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"precision", 9, KEYWORD_PRECISION},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"", 0, KEYWORD_NONE},
+  {"else", 4, KEYWORD_ELSE}
+};
+
+}  // namespace sqlcheck
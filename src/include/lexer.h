@@ -0,0 +1,186 @@
+// LEXER HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sqlcheck {
+
+enum TokenKind : uint8_t {
+  TOKEN_KIND_INVALID = 0,
+
+  TOKEN_KIND_KEYWORD = 1,
+  TOKEN_KIND_IDENTIFIER = 2,
+  TOKEN_KIND_QUOTED_IDENTIFIER = 3,
+  TOKEN_KIND_STRING = 4,
+  TOKEN_KIND_NUMBER = 5,
+  TOKEN_KIND_PARAMETER = 6,
+  TOKEN_KIND_OPERATOR = 7,
+  TOKEN_KIND_PUNCTUATION = 8
+
+};
+
+enum KeywordId : uint16_t {
+  KEYWORD_NONE = 0,
+
+  KEYWORD_ADD,
+  KEYWORD_ALL,
+  KEYWORD_ALTER,
+  KEYWORD_AND,
+  KEYWORD_ANY,
+  KEYWORD_AS,
+  KEYWORD_ASC,
+  KEYWORD_BETWEEN,
+  KEYWORD_BY,
+  KEYWORD_CASE,
+  KEYWORD_CHECK,
+  KEYWORD_COLUMN,
+  KEYWORD_CONSTRAINT,
+  KEYWORD_CREATE,
+  KEYWORD_CROSS,
+  KEYWORD_DEFAULT,
+  KEYWORD_DELETE,
+  KEYWORD_DESC,
+  KEYWORD_DISTINCT,
+  KEYWORD_DOUBLE,
+  KEYWORD_DROP,
+  KEYWORD_ELSE,
+  KEYWORD_END,
+  KEYWORD_ENUM,
+  KEYWORD_EXCEPT,
+  KEYWORD_EXISTS,
+  KEYWORD_FLOAT,
+  KEYWORD_FOREIGN,
+  KEYWORD_FROM,
+  KEYWORD_FULL,
+  KEYWORD_GROUP,
+  KEYWORD_HAVING,
+  KEYWORD_IF,
+  KEYWORD_IN,
+  KEYWORD_INDEX,
+  KEYWORD_INNER,
+  KEYWORD_INSERT,
+  KEYWORD_INTERSECT,
+  KEYWORD_INTO,
+  KEYWORD_IS,
+  KEYWORD_JOIN,
+  KEYWORD_KEY,
+  KEYWORD_LEFT,
+  KEYWORD_LIKE,
+  KEYWORD_LIMIT,
+  KEYWORD_NOT,
+  KEYWORD_NULL,
+  KEYWORD_OFFSET,
+  KEYWORD_ON,
+  KEYWORD_OR,
+  KEYWORD_ORDER,
+  KEYWORD_OUTER,
+  KEYWORD_PRECISION,
+  KEYWORD_PRIMARY,
+  KEYWORD_REAL,
+  KEYWORD_REFERENCES,
+  KEYWORD_REGEXP,
+  KEYWORD_RIGHT,
+  KEYWORD_SELECT,
+  KEYWORD_SET,
+  KEYWORD_SIMILAR,
+  KEYWORD_TABLE,
+  KEYWORD_TEMPORARY,
+  KEYWORD_TEXT,
+  KEYWORD_THEN,
+  KEYWORD_TO,
+  KEYWORD_UNION,
+  KEYWORD_UNIQUE,
+  KEYWORD_UPDATE,
+  KEYWORD_USING,
+  KEYWORD_VALUES,
+  KEYWORD_VARCHAR,
+  KEYWORD_VIEW,
+  KEYWORD_WHEN,
+  KEYWORD_WHERE,
+  KEYWORD_WITH
+
+};
+
+enum Dialect : uint8_t {
+  DIALECT_GENERIC = 0,
+
+  DIALECT_MYSQL = 1,
+  DIALECT_POSTGRESQL = 2,
+  DIALECT_SQLSERVER = 3,
+  DIALECT_SQLITE = 4
+
+};
+
+// Quoting and comment conventions of a dialect
+struct LexerTable {
+
+  const char* name;
+
+  // # starts a line comment
+  bool hash_comments;
+
+  // block comments nest
+  bool nested_comments;
+
+  // backslash escapes in quoted strings
+  bool backslash_escapes;
+
+  // E'...' strings with backslash escapes
+  bool escape_strings;
+
+  // $tag$...$tag$ strings
+  bool dollar_quotes;
+
+  // "..." is a string rather than an identifier
+  bool double_quote_strings;
+
+  // `...` identifiers
+  bool backtick_identifiers;
+
+  // [...] identifiers
+  bool bracket_identifiers;
+
+  // GO on a line of its own ends a batch
+  bool batch_separator;
+
+};
+
+const LexerTable& GetLexerTable(const Dialect dialect);
+
+// Look up a dialect by name; returns false for unknown names
+bool ParseDialect(const std::string& name, Dialect& dialect);
+
+// Length of the $tag$ opening a dollar-quoted string at a position, or 0
+size_t DollarTagLength(const std::string& text, const size_t pos);
+
+// Lexical token; the text is a slice of the statement
+struct Token {
+
+  TokenKind kind;
+  KeywordId keyword;
+  uint32_t offset;
+  uint32_t length;
+
+};
+
+// Look up a keyword (case-insensitive); returns KEYWORD_NONE for other words
+KeywordId LookupKeyword(const char* word, const size_t length);
+
+// Split a statement into tokens, skipping white space and comments
+void Tokenize(const std::string& sql_statement,
+              std::vector<Token>& tokens,
+              const Dialect dialect = DIALECT_GENERIC);
+
+// Text of a token
+std::string TokenText(const std::string& sql_statement,
+                      const Token& token);
+
+// Text spanning a range of tokens
+std::string TokenText(const std::string& sql_statement,
+                      const Token& first,
+                      const Token& last);
+
+}  // namespace sqlcheck
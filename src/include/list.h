@@ -3,132 +3,135 @@
 #pragma once
 
 #include "configuration.h"
+#include "parser.h"
 
 namespace sqlcheck {
 
+// Version of the rule set; bump whenever a rule, the lexer or the
+// statement splitting changes so that cached results are invalidated
+const std::string RULE_SET_VERSION = "sqlcheck-rules 8";
+
 // LOGICAL DATABASE DESIGN
 
 void CheckMultiValuedAttribute(Configuration& state,
-                               const std::string& sql_statement,
-                               bool& print_statement);
+                               const Statement& statement);
 
 void CheckRecursiveDependency(Configuration& state,
-                              const std::string& sql_statement,
-                              bool& print_statement);
+                              const Statement& statement);
 
 void CheckPrimaryKeyExists(Configuration& state,
-                           const std::string& sql_statement,
-                           bool& print_statement);
+                           const Statement& statement);
 
 void CheckGenericPrimaryKey(Configuration& state,
-                            const std::string& sql_statement,
-                            bool& print_statement);
+                            const Statement& statement);
 
 void CheckForeignKeyExists(Configuration& state,
-                           const std::string& sql_statement,
-                           bool& print_statement);
+                           const Statement& statement);
 
 void CheckVariableAttribute(Configuration& state,
-                            const std::string& sql_statement,
-                            bool& print_statement);
+                            const Statement& statement);
 
 void CheckMetadataTribbles(Configuration& state,
-                           const std::string& sql_statement,
-                           bool& print_statement);
+                           const Statement& statement);
 
 // PHYSICAL DATABASE DESIGN
 
 void CheckFloat(Configuration& state,
-                const std::string& sql_statement,
-                bool& print_statement);
+                const Statement& statement);
 
 void CheckValuesInDefinition(Configuration& state,
-                             const std::string& sql_statement,
-                             bool& print_statement);
+                             const Statement& statement);
 
 void CheckExternalFiles(Configuration& state,
-                        const std::string& sql_statement,
-                        bool& print_statement);
+                        const Statement& statement);
 
 void CheckIndexCount(Configuration& state,
-                     const std::string& sql_statement,
-                     bool& print_statement);
+                     const Statement& statement);
 
 void CheckIndexAttributeOrder(Configuration& state,
-                              const std::string& sql_statement,
-                              bool& print_statement);
+                              const Statement& statement);
 
 // QUERY
 
 void CheckSelectStar(Configuration& state,
-                     const std::string& sql_statement,
-                     bool& print_statement);
+                     const Statement& statement);
 
 void CheckNullUsage(Configuration& state,
-                    const std::string& sql_statement,
-                    bool& print_statement);
+                    const Statement& statement);
 
 void CheckNotNullUsage(Configuration& state,
-                       const std::string& sql_statement,
-                       bool& print_statement);
+                       const Statement& statement);
 
 void CheckConcatenation(Configuration& state,
-                        const std::string& sql_statement,
-                        bool& print_statement);
+                        const Statement& statement);
 
 void CheckGroupByUsage(Configuration& state,
-                       const std::string& sql_statement,
-                       bool& print_statement);
+                       const Statement& statement);
 
 void CheckOrderByRand(Configuration& state,
-                      const std::string& sql_statement,
-                      bool& print_statement);
+                      const Statement& statement);
 
 void CheckPatternMatching(Configuration& state,
-                          const std::string& sql_statement,
-                          bool& print_statement);
+                          const Statement& statement);
 
 void CheckSpaghettiQuery(Configuration& state,
-                         const std::string& sql_statement,
-                         bool& print_statement);
+                    const Statement& statement);
 
 void CheckJoinCount(Configuration& state,
-                         const std::string& sql_statement,
-                         bool& print_statement);
+                    const Statement& statement);
 
 void CheckDistinctCount(Configuration& state,
-                        const std::string& sql_statement,
-                        bool& print_statement);
+                        const Statement& statement);
 
 void CheckImplicitColumns(Configuration& state,
-                          const std::string& sql_statement,
-                          bool& print_statement);
+                          const Statement& statement);
 
 void CheckHaving(Configuration& state,
-                 const std::string& sql_statement,
-                 bool& print_statement);
+                 const Statement& statement);
 
 void CheckNesting(Configuration& state,
-                  const std::string& sql_statement,
-                  bool& print_statement);
+                  const Statement& statement);
 
 void CheckOr(Configuration& state,
-             const std::string& sql_statement,
-             bool& print_statement);
+             const Statement& statement);
 
 void CheckUnion(Configuration& state,
-                const std::string& sql_statement,
-                bool& print_statement);
+                const Statement& statement);
 
 void CheckDistinctJoin(Configuration& state,
-                       const std::string& sql_statement,
-                       bool& print_statement);
+                       const Statement& statement);
 
 // APPLICATION
 
 void CheckReadablePasswords(Configuration& state,
-                            const std::string& sql_statement,
-                            bool& print_statement);
+                            const Statement& statement);
+
+// DISPATCH
+
+// Kind of a statement, which selects the rules that can match it
+enum StatementKind : uint8_t {
+  // queries, DML and the remaining single statements
+  STATEMENT_KIND_QUERY = 0,
+  STATEMENT_KIND_CREATE_TABLE = 1,
+  STATEMENT_KIND_ALTER_TABLE = 2,
+  STATEMENT_KIND_CREATE_INDEX = 3,
+  // CREATE TABLE ... AS SELECT and texts with several statements, which
+  // run every rule
+  STATEMENT_KIND_OTHER = 4,
+
+  STATEMENT_KIND_COUNT = 5
+};
+
+typedef void (*Rule)(Configuration& state, const Statement& statement);
+
+StatementKind ClassifyStatement(const Statement& statement);
+
+// Rules for a kind of statement in report order, built once at startup
+const std::vector<Rule>& GetRules(const StatementKind kind);
+
+// Rules that can report other patterns for the same query shape when its
+// literals change; log mode runs them on every execution of a shape
+const std::vector<Rule>& GetLiteralRules();
 
 
 }  // namespace machine
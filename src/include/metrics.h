@@ -0,0 +1,102 @@
+// METRICS HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "parser.h"
+
+namespace sqlcheck {
+
+// Complexity metrics of a statement (summed over the statements in the
+// body of a routine)
+struct StatementMetrics {
+
+  // characters in the normalized statement
+  size_t length;
+
+  // table references, and joins (explicit or comma-separated)
+  size_t tables;
+  size_t joins;
+
+  // deepest nesting of subqueries, and correlated subqueries
+  size_t subquery_depth;
+  size_t correlated_subqueries;
+
+  // comparisons, IN, LIKE, BETWEEN, IS and EXISTS predicates
+  size_t predicates;
+  size_t ors;
+
+  // items in the longest IN list
+  size_t in_list;
+
+  bool distinct;
+  bool group_by;
+  bool order_by;
+
+};
+
+// Reset the metrics of a statement
+void ClearMetrics(StatementMetrics& metrics,
+                  const size_t length);
+
+// Add the metrics of a parsed statement
+void AddMetrics(const Statement& statement,
+                StatementMetrics& metrics);
+
+// Writes the metrics of the checked statements to a file, one JSON object
+// per line (NDJSON)
+class MetricsWriter {
+
+ public:
+
+  MetricsWriter();
+
+  MetricsWriter(const MetricsWriter&) = delete;
+
+  MetricsWriter& operator=(const MetricsWriter&) = delete;
+
+  // Create the metrics file, or append to it when resuming a check;
+  // throws if it cannot be written
+  void Open(const std::string& file_name,
+            const bool append = false);
+
+  bool IsOpen() const {
+    return output_.is_open();
+  }
+
+  void Write(const uint64_t fingerprint,
+             const StatementMetrics& metrics);
+
+  // Flush the metrics written so far to the file
+  void Flush();
+
+  unsigned long long Statements() const {
+    return statements_;
+  }
+
+  // Bytes of the metrics file on disk
+  unsigned long long Size() const;
+
+  // Continue after the given number of statements, dropping the metrics
+  // written after the file had the given size; throws if it is shorter
+  void Restore(const unsigned long long statements,
+               const unsigned long long size);
+
+  // Flush and close the metrics file; throws if it could not be written
+  void Close();
+
+ private:
+
+  // metrics file
+  std::string file_name_;
+  std::ofstream output_;
+
+  // statements written so far
+  unsigned long long statements_;
+
+};
+
+}  // namespace sqlcheck
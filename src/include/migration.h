@@ -0,0 +1,28 @@
+// MIGRATION HEADER
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Versioned migration script (V<version>__<description>.sql)
+struct Migration {
+
+  std::vector<unsigned long long> version;
+  std::string file_name;
+
+};
+
+// List the versioned migrations in a directory, in version order
+std::vector<Migration> ListMigrations(const std::string& directory);
+
+// Check the migrations in version order on top of the cached schema
+// catalog of the longest unchanged prefix; returns the number of
+// migrations that were checked
+size_t CheckMigrations(Configuration& state);
+
+}  // namespace sqlcheck
@@ -0,0 +1,192 @@
+// PARSER HEADER
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+
+namespace sqlcheck {
+
+// Size of the arena blocks (fits the nodes of typical statements)
+const size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+// Bump allocator for the nodes of a statement; the blocks are kept and
+// reused for the next statement
+class Arena {
+
+ public:
+
+  explicit Arena(const size_t block_size = ARENA_BLOCK_SIZE);
+
+  template <typename T>
+  T* New(){
+    return new (Allocate(sizeof(T), alignof(T))) T();
+  }
+
+  void* Allocate(const size_t size, const size_t alignment);
+
+  // Release all allocations (without running destructors)
+  void Reset();
+
+ private:
+
+  // size of each block
+  size_t block_size_;
+
+  // allocated blocks
+  std::vector<std::unique_ptr<char[]>> blocks_;
+
+  // current block and offset within it
+  size_t block_;
+  size_t offset_;
+
+};
+
+enum NodeKind : uint8_t {
+  NODE_KIND_INVALID = 0,
+
+  // statements
+  NODE_KIND_QUERY = 1,
+  NODE_KIND_SET_OPERATION = 2,
+  NODE_KIND_WITH = 3,
+  NODE_KIND_INSERT = 4,
+  NODE_KIND_UPDATE = 5,
+  NODE_KIND_DELETE = 6,
+  NODE_KIND_CREATE_TABLE = 7,
+  NODE_KIND_CREATE_INDEX = 8,
+  NODE_KIND_ALTER_TABLE = 9,
+  NODE_KIND_DROP = 10,
+  NODE_KIND_OTHER = 11,
+
+  // clauses
+  NODE_KIND_CTE = 20,
+  NODE_KIND_SELECT_LIST = 21,
+  NODE_KIND_FROM = 22,
+  NODE_KIND_WHERE = 23,
+  NODE_KIND_GROUP_BY = 24,
+  NODE_KIND_HAVING = 25,
+  NODE_KIND_ORDER_BY = 26,
+  NODE_KIND_LIMIT = 27,
+  NODE_KIND_COLUMN_LIST = 28,
+  NODE_KIND_VALUES = 29,
+  NODE_KIND_SET = 30,
+
+  // table expressions
+  NODE_KIND_TABLE = 40,
+  NODE_KIND_JOIN = 41,
+  NODE_KIND_DERIVED_TABLE = 42,
+
+  // expressions
+  NODE_KIND_COLUMN = 50,
+  NODE_KIND_STAR = 51,
+  NODE_KIND_LITERAL = 52,
+  NODE_KIND_PARAMETER = 53,
+  NODE_KIND_FUNCTION = 54,
+  NODE_KIND_UNARY = 55,
+  NODE_KIND_BINARY = 56,
+  NODE_KIND_LIST = 57,
+  NODE_KIND_SUBQUERY = 58,
+  NODE_KIND_CASE = 59,
+  NODE_KIND_ALIAS = 60,
+
+  // definitions
+  NODE_KIND_COLUMN_DEFINITION = 70,
+  NODE_KIND_CONSTRAINT = 71
+
+};
+
+// Syntax tree node; children are linked through next
+struct Node {
+
+  NodeKind kind;
+
+  // distinguishing keyword (join type, set operation, predicate, constraint)
+  KeywordId keyword;
+
+  // tokens spanned by the node (inclusive)
+  uint32_t first;
+  uint32_t last;
+
+  // principal token (name, operator)
+  uint32_t token;
+
+  Node* child;
+  Node* next;
+
+};
+
+// Statement handed to the rules
+struct Statement {
+
+  // lower-cased text
+  const std::string& text;
+
+  const std::vector<Token>& tokens;
+
+  // syntax tree (never null)
+  const Node* tree;
+
+};
+
+// Parse a tokenized statement with nodes allocated in the arena; syntax
+// outside the supported subset is skipped, so parsing never fails
+Node* Parse(const std::string& sql_statement,
+            const std::vector<Token>& tokens,
+            Arena& arena);
+
+// Visit a node and its descendants in pre-order
+template <typename Visitor>
+void VisitNodes(const Node* node, Visitor visitor){
+  for(; node != nullptr; node = node->next){
+    visitor(node);
+    VisitNodes(node->child, visitor);
+  }
+}
+
+// First child of a kind, or null
+const Node* FindChild(const Node* node, const NodeKind kind);
+
+// Subqueries of a statement
+struct SubqueryInfo {
+
+  // deepest nesting of subqueries and derived tables (0 without any), and
+  // the first subquery at that depth
+  size_t max_depth;
+  const Node* deepest;
+
+  // subqueries that reference a table of an enclosing query, in order
+  std::vector<const Node*> correlated;
+
+};
+
+// Find the nesting depth and the correlated subqueries of a statement;
+// only qualified column references are resolved
+void AnalyzeSubqueries(const std::string& sql_statement,
+                       const std::vector<Token>& tokens,
+                       const Node* tree,
+                       SubqueryInfo& subqueries);
+
+// Statement in the body of a routine (body tokens [first, last))
+struct BodyStatement {
+
+  size_t first;
+  size_t last;
+
+};
+
+// Split the body of a routine (CREATE PROCEDURE, FUNCTION or TRIGGER) into
+// its statements. The body is either the tokens between BEGIN and the last
+// END or a dollar-quoted string, which is tokenized once; the body tokens
+// keep their offsets in the routine. Returns false for other statements.
+bool SplitRoutineBody(const std::string& sql_statement,
+                      const std::vector<Token>& tokens,
+                      const Dialect dialect,
+                      std::vector<Token>& body_tokens,
+                      std::vector<BodyStatement>& body_statements);
+
+}  // namespace sqlcheck
@@ -0,0 +1,54 @@
+// PROGRESS HEADER
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Milliseconds between progress updates
+const unsigned int PROGRESS_INTERVAL_MS = 500;
+
+// Prints a progress line on stderr from a background thread; the checker
+// only bumps the progress counters of the configuration
+class ProgressReporter {
+
+ public:
+
+  // total_bytes is 0 when the size of the input is unknown
+  ProgressReporter(const Configuration& state,
+                   const unsigned long long total_bytes);
+
+  // Print the final progress line and stop the thread
+  ~ProgressReporter();
+
+  ProgressReporter(const ProgressReporter&) = delete;
+
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+ private:
+
+  void Run();
+
+  void Print();
+
+  const Configuration& state_;
+
+  unsigned long long total_bytes_;
+
+  std::chrono::steady_clock::time_point start_;
+
+  std::mutex mutex_;
+  std::condition_variable stop_condition_;
+  bool stopped_;
+
+  std::thread thread_;
+
+};
+
+}  // namespace sqlcheck
@@ -0,0 +1,299 @@
+// SKETCH HEADER
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace sqlcheck {
+
+// Space-Saving top-k counter: tracks the heaviest keys of a stream with a
+// fixed number of counters; each count overestimates the true count by at
+// most its error
+template <typename Key, typename Hash = std::hash<Key>>
+class SpaceSaving {
+
+ public:
+
+  struct Counter {
+
+    Key key;
+    unsigned long long count;
+    unsigned long long error;
+
+  };
+
+  explicit SpaceSaving(size_t capacity = 0)
+ : capacity_(capacity){
+  }
+
+  size_t Capacity() const {
+    return capacity_;
+  }
+
+  size_t Size() const {
+    return heap_.size();
+  }
+
+  bool Contains(const Key& key) const {
+    return positions_.count(key) != 0;
+  }
+
+  // Count occurrences of a key; returns true and sets the evicted key when
+  // the key replaced the least frequent tracked key
+  bool Add(const Key& key, const unsigned long long count, Key& evicted){
+
+    if(capacity_ == 0){
+      return false;
+    }
+
+    auto position = positions_.find(key);
+    if(position != positions_.end()){
+      heap_[position->second].count += count;
+      SiftDown(position->second);
+      return false;
+    }
+
+    if(heap_.size() < capacity_){
+      heap_.push_back(Counter{key, count, 0});
+      positions_[key] = heap_.size() - 1;
+      SiftUp(heap_.size() - 1);
+      return false;
+    }
+
+    // Replace the least frequent key and inherit its count as error
+    evicted = heap_[0].key;
+    positions_.erase(evicted);
+    heap_[0] = Counter{key, heap_[0].count + count, heap_[0].count};
+    positions_[key] = 0;
+    SiftDown(0);
+    return true;
+  }
+
+  // Merge a sketch built over another part of the stream (another thread
+  // or shard); keys missing from a full sketch may have occurred up to its
+  // minimum count there
+  void Merge(const SpaceSaving& other){
+
+    auto minimum = MinimumCount();
+    auto other_minimum = other.MinimumCount();
+
+    std::unordered_map<Key, Counter, Hash> merged;
+    for(auto& counter : heap_){
+      merged[counter.key] = Counter{counter.key,
+                                    counter.count + other_minimum,
+                                    counter.error + other_minimum};
+    }
+    for(auto& counter : other.heap_){
+      auto entry = merged.find(counter.key);
+      if(entry != merged.end()){
+        entry->second.count += counter.count - other_minimum;
+        entry->second.error += counter.error - other_minimum;
+      }
+      else {
+        merged[counter.key] = Counter{counter.key,
+                                      counter.count + minimum,
+                                      counter.error + minimum};
+      }
+    }
+
+    capacity_ = std::max(capacity_, other.capacity_);
+    heap_.clear();
+    for(auto& entry : merged){
+      heap_.push_back(entry.second);
+    }
+
+    // Keep the heaviest keys
+    if(heap_.size() > capacity_){
+      std::nth_element(heap_.begin(), heap_.begin() + capacity_, heap_.end(),
+                       [](const Counter& left, const Counter& right){
+                         return left.count > right.count;
+                       });
+      heap_.resize(capacity_);
+    }
+
+    positions_.clear();
+    for(size_t itr = 0; itr < heap_.size(); itr++){
+      positions_[heap_[itr].key] = itr;
+    }
+    for(size_t itr = heap_.size() / 2; itr > 0; itr--){
+      SiftDown(itr - 1);
+    }
+  }
+
+  // Tracked counters in heap order
+  const std::vector<Counter>& Counters() const {
+    return heap_;
+  }
+
+  // Restore counters saved in heap order
+  void Restore(const size_t capacity, const std::vector<Counter>& counters){
+    capacity_ = capacity;
+    heap_ = counters;
+    positions_.clear();
+    for(size_t itr = 0; itr < heap_.size(); itr++){
+      positions_[heap_[itr].key] = itr;
+    }
+  }
+
+  // Heaviest tracked keys by decreasing count
+  std::vector<Counter> Top(const size_t k) const {
+    auto counters = heap_;
+    auto count = std::min(k, counters.size());
+    std::partial_sort(counters.begin(), counters.begin() + count, counters.end(),
+                      [](const Counter& left, const Counter& right){
+                        return left.count > right.count;
+                      });
+    counters.resize(count);
+    return counters;
+  }
+
+ private:
+
+  unsigned long long MinimumCount() const {
+    if(heap_.size() < capacity_ || heap_.empty()){
+      return 0;
+    }
+    return heap_[0].count;
+  }
+
+  void Swap(const size_t left, const size_t right){
+    std::swap(heap_[left], heap_[right]);
+    positions_[heap_[left].key] = left;
+    positions_[heap_[right].key] = right;
+  }
+
+  void SiftUp(size_t position){
+    while(position > 0){
+      auto parent = (position - 1) / 2;
+      if(heap_[parent].count <= heap_[position].count){
+        break;
+      }
+      Swap(parent, position);
+      position = parent;
+    }
+  }
+
+  void SiftDown(size_t position){
+    while(true){
+      auto smallest = position;
+      auto left = 2 * position + 1;
+      auto right = left + 1;
+      if(left < heap_.size() && heap_[left].count < heap_[smallest].count){
+        smallest = left;
+      }
+      if(right < heap_.size() && heap_[right].count < heap_[smallest].count){
+        smallest = right;
+      }
+      if(smallest == position){
+        break;
+      }
+      Swap(smallest, position);
+      position = smallest;
+    }
+  }
+
+  // number of counters
+  size_t capacity_;
+
+  // counters in a min-heap on count
+  std::vector<Counter> heap_;
+
+  // heap position of each tracked key
+  std::unordered_map<Key, size_t, Hash> positions_;
+
+};
+
+// Precision of the HyperLogLog counters (2^12 registers, ~1.6% error)
+const uint8_t HYPERLOGLOG_PRECISION = 12;
+
+// HyperLogLog estimator of the number of distinct 64-bit hashes
+class HyperLogLog {
+
+ public:
+
+  explicit HyperLogLog(const uint8_t precision = HYPERLOGLOG_PRECISION);
+
+  void Add(const uint64_t hash);
+
+  // Merge a counter built over another part of the stream
+  void Merge(const HyperLogLog& other);
+
+  double Estimate() const;
+
+  // Serialize the registers
+  void Save(std::ostream& output) const;
+
+  // Deserialize the registers; returns false on a format mismatch
+  bool Load(std::istream& input);
+
+ private:
+
+  // number of index bits
+  uint8_t precision_;
+
+  // maximum rank seen per register
+  std::vector<uint8_t> registers_;
+
+};
+
+// Hashes in a MinHash signature, split into LSH bands of equal rows; with
+// 8 bands of 4 rows, sets with a Jaccard similarity of 0.6 share a band
+// with probability 0.6 and sets with 0.8 with probability 0.97
+const size_t MINHASH_SIZE = 32;
+const size_t MINHASH_BANDS = 8;
+
+typedef std::array<uint32_t, MINHASH_SIZE> MinHash;
+
+// MinHash signature of a set of 64-bit element hashes
+MinHash ComputeMinHash(const std::vector<uint64_t>& elements);
+
+// Estimated Jaccard similarity of the sets of two signatures
+double EstimateSimilarity(const MinHash& left, const MinHash& right);
+
+// Clusters of near-duplicate sets: a new set is compared with the first
+// set of each LSH band bucket it falls into, and merged with it (union-find)
+// when their estimated similarity is high enough, so that adding a set
+// takes constant time
+class LshClusters {
+
+ public:
+
+  explicit LshClusters(const double min_similarity = 0.5);
+
+  // Add a set (once per key)
+  void Add(const uint64_t key, const MinHash& signature);
+
+  // Representative key of the cluster of a key
+  uint64_t Find(uint64_t key) const;
+
+  // Number of clusters
+  size_t Size() const {
+    return clusters_;
+  }
+
+ private:
+
+  // minimum estimated similarity of merged sets
+  double min_similarity_;
+
+  // signatures of the first sets of the buckets
+  std::unordered_map<uint64_t, MinHash> signatures_;
+
+  // first set of each bucket (by band and rows)
+  std::unordered_map<uint64_t, uint64_t> buckets_;
+
+  // parent of each merged key (roots are absent)
+  std::unordered_map<uint64_t, uint64_t> parents_;
+
+  size_t clusters_;
+
+};
+
+}  // namespace sqlcheck
@@ -0,0 +1,164 @@
+// SPLITTER HEADER
+
+#pragma once
+
+#include <atomic>
+#include <istream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Seed of the statement sampler, fixed so that sampled runs are repeatable
+const uint64_t SAMPLE_SEED = 0x5eed;
+
+// Leading words of a statement searched for CREATE PROCEDURE, FUNCTION or
+// TRIGGER
+const size_t ROUTINE_HEADER_WORDS = 6;
+
+// Splits an input stream into SQL statements at delimiters outside quotes
+// and comments (and at batch separators), following the conventions of the
+// configured dialect. DELIMITER directives change the delimiter for the
+// rest of the input, and the BEGIN ... END body of a routine is kept in
+// one statement. When sampling is enabled only a random subset of the
+// statements is returned and the others are skipped without being
+// assembled. Splitting stops once the check is cancelled.
+class StatementSplitter {
+
+ public:
+  StatementSplitter(Configuration& state, std::istream& input);
+
+  // Get the next statement; returns false at the end of the input
+  bool Next(std::string& sql_statement);
+
+  // Return only a random subset of the statements: each one with a
+  // probability, or a uniform sample of a fixed size (0 = no reservoir);
+  // call before the first statement
+  void SetSampling(const double sample_rate,
+                   const size_t reservoir_size);
+
+  // Lines spanned by the last statement (1-based)
+  size_t FirstLine() const {
+    return first_line_;
+  }
+
+  size_t LastLine() const {
+    return line_;
+  }
+
+  // Statements read so far, including skipped ones
+  unsigned long long Statements() const {
+    return statements_;
+  }
+
+  // Offset in the input of the first non-blank byte of the last statement
+  unsigned long long StatementOffset() const {
+    return statement_offset_;
+  }
+
+  // Offset in the input of the first byte not consumed by the statements
+  // read so far, and the delimiter in effect there; a splitter created at
+  // that offset with that delimiter continues with the next statement
+  unsigned long long Offset() const {
+    return pending_.empty() ? offset_ : pending_offset_;
+  }
+
+  const std::string& Delimiter() const {
+    return delimiter_;
+  }
+
+  void SetDelimiter(const std::string& delimiter){
+    delimiter_ = delimiter;
+  }
+
+ private:
+
+  // Read the next statement; skipped when sql_statement is null
+  bool ReadStatement(std::string* sql_statement);
+
+  // Scan a line from a position, tracking quotes and comments across lines;
+  // returns true with the position past the delimiter when one is found.
+  // A trailing line comment is cut off.
+  bool ScanFragment(std::string& statement_fragment, size_t& pos);
+
+  // Track the header and the blocks of a routine at a word; returns the
+  // number of characters consumed
+  size_t ScanWord(const std::string& line, const size_t pos);
+
+  // Number of statements to skip before the next Bernoulli sample
+  unsigned long long DrawSkip();
+
+  // Sample the whole input into the reservoir (algorithm L)
+  void FillReservoir();
+
+  // query delimiter (changed by DELIMITER directives)
+  std::string delimiter_;
+
+  // quoting and comment conventions of the dialect
+  const LexerTable& table_;
+
+  // closing quote of an open string or identifier (empty outside quotes)
+  std::string closing_;
+  bool backslash_escapes_;
+
+  // nesting depth of an open block comment
+  size_t comment_depth_;
+
+  // words scanned in the current statement, whether it defines a routine,
+  // and the nesting depth of its BEGIN ... END blocks
+  size_t words_;
+  bool routine_;
+  size_t block_depth_;
+
+  // rest of the last line after a delimiter, and its offset in the input
+  std::string pending_;
+  unsigned long long pending_offset_;
+
+  // offset in the input after the lines read so far
+  unsigned long long offset_;
+
+  // offset of the first non-blank byte of the last statement
+  unsigned long long statement_offset_;
+
+  // input stream
+  std::istream& input_;
+
+  // cancellation token of the check
+  const std::atomic<bool>& cancelled_;
+
+  // progress counters of the check
+  std::atomic<unsigned long long>& progress_bytes_;
+  std::atomic<unsigned long long>& progress_statements_;
+
+  // lines read so far
+  size_t line_;
+
+  // first non-empty line of the last statement
+  size_t first_line_;
+
+  // statements read so far
+  unsigned long long statements_;
+
+  // probability of sampling a statement
+  double sample_rate_;
+
+  // statements to skip before the next sample
+  unsigned long long skip_;
+
+  // number of statements in the reservoir (0 = no reservoir sampling)
+  size_t reservoir_size_;
+
+  // sampled statements with their positions, and the next one to return
+  std::vector<std::pair<unsigned long long, std::string>> reservoir_;
+  size_t reservoir_position_;
+  bool reservoir_filled_;
+
+  std::mt19937_64 random_;
+
+};
+
+}  // namespace sqlcheck
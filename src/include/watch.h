@@ -0,0 +1,48 @@
+// WATCH HEADER
+
+#pragma once
+
+#include <istream>
+#include <map>
+#include <string>
+
+#include "configuration.h"
+#include "cache.h"
+
+namespace sqlcheck {
+
+// Statement of a watched file with its findings, and the number of its
+// copies in the file
+struct WatchedStatement {
+
+  StatementFindings result;
+  size_t copies = 0;
+
+};
+
+// Statements of a watched file, indexed by the hash of the statement
+struct WatchedFile {
+
+  std::map<uint64_t, WatchedStatement> statements;
+
+};
+
+// Findings that appeared or disappeared in an update
+struct WatchDelta {
+
+  size_t new_findings;
+  size_t resolved_findings;
+
+};
+
+// Re-split a watched file and check only its new or changed statements;
+// findings of statements that are gone are reported as resolved
+WatchDelta UpdateWatchedFile(Configuration& state,
+                             std::istream& input,
+                             WatchedFile& file);
+
+// Check the SQL files in a directory, then re-check them incrementally
+// whenever they change (does not return)
+void WatchDirectory(Configuration& state);
+
+}  // namespace sqlcheck
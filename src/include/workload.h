@@ -0,0 +1,67 @@
+// WORKLOAD HEADER
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "configuration.h"
+
+namespace sqlcheck {
+
+// Counters per reported query shape in top-k log mode
+const size_t SKETCH_CAPACITY_FACTOR = 8;
+
+// Cluster of near-duplicate query shapes (log mode)
+struct QueryCluster {
+
+  unsigned long long executions = 0;
+  size_t queries = 0;
+
+  // heaviest query shape of the cluster
+  uint64_t representative = 0;
+  unsigned long long representative_executions = 0;
+
+  // anti-patterns found in any query of the cluster
+  std::vector<PatternId> pattern_ids;
+
+};
+
+// Normalize a lower-cased statement into its query shape from its tokens:
+// literals and parameters are replaced by ?, value lists are collapsed,
+// and comments and white space are squeezed into single spaces
+std::string NormalizeQuery(const std::string& sql_statement,
+                           const std::vector<Token>& tokens);
+
+std::string NormalizeQuery(const std::string& sql_statement);
+
+// Record an execution of a query; returns false if its shape is already
+// known, in which case its findings are counted again without checking it.
+// In top-k log mode only the heaviest shapes are remembered, so an evicted
+// shape is checked again when it recurs.
+bool RecordQuery(Configuration& state,
+                 const std::string& sql_statement,
+                 const std::vector<Token>& tokens,
+                 uint64_t& fingerprint);
+
+// Add a new query shape to the clusters of near-duplicate queries, from a
+// MinHash signature over the tokens of its normalized text
+void ClusterQuery(Configuration& state,
+                  const uint64_t fingerprint,
+                  const std::string& query);
+
+// Clusters of near-duplicate queries with findings, by executions
+std::vector<QueryCluster> RankClusters(const Configuration& state);
+
+// Record the findings of a newly checked query
+void RecordFindings(Configuration& state,
+                    const uint64_t fingerprint);
+
+// Rank the anti-patterns by the total executions of the queries
+// exhibiting them
+std::vector<PatternRank> RankPatterns(const Configuration& state);
+
+// Print the frequency-weighted findings of a query workload
+void PrintWorkloadSummary(const Configuration& state);
+
+}  // namespace sqlcheck
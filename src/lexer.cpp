@@ -0,0 +1,293 @@
+// LEXER SOURCE
+
+#include <cstring>
+
+#include "include/lexer.h"
+#include "include/keyword_table.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Fold an ASCII letter to lower case; no other byte folds onto a letter
+inline uint32_t FoldCase(const char c){
+  return static_cast<unsigned char>(c) | 0x20;
+}
+
+// Must match keyword_hash in script/keywords.py
+inline uint32_t KeywordHash(const char* word, const size_t length){
+  auto hash = FoldCase(word[0]) * KEYWORD_HASH_FIRST +
+      FoldCase(word[1]) * KEYWORD_HASH_SECOND +
+      FoldCase(word[length - 1]) * KEYWORD_HASH_LAST +
+      static_cast<uint32_t>(length) * KEYWORD_HASH_LENGTH;
+  return hash >> (32 - KEYWORD_HASH_BITS);
+}
+
+bool IsIdentifierStart(const char c){
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+      static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool IsIdentifierPart(const char c){
+  return IsIdentifierStart(c) || (c >= '0' && c <= '9') || c == '$';
+}
+
+bool IsDigit(const char c){
+  return c >= '0' && c <= '9';
+}
+
+bool IsSpace(const char c){
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Skip past a quoted string or identifier; a doubled closing quote escapes
+// itself
+size_t SkipQuoted(const std::string& sql_statement,
+                  size_t pos,
+                  const char closing,
+                  const bool backslash_escapes){
+  for(pos = pos + 1; pos < sql_statement.size(); pos++){
+    auto c = sql_statement[pos];
+    if(c == '\\' && backslash_escapes){
+      pos++;
+      continue;
+    }
+    if(c == closing){
+      if(pos + 1 < sql_statement.size() && sql_statement[pos + 1] == closing){
+        pos++;
+        continue;
+      }
+      return pos + 1;
+    }
+  }
+  return pos;
+}
+
+size_t SkipBlockComment(const std::string& sql_statement,
+                        size_t pos,
+                        const bool nested){
+  size_t depth = 0;
+  auto size = sql_statement.size();
+  while(pos + 1 < size){
+    if(sql_statement[pos] == '/' && sql_statement[pos + 1] == '*'){
+      depth = (nested || depth == 0) ? depth + 1 : depth;
+      pos += 2;
+    }
+    else if(sql_statement[pos] == '*' && sql_statement[pos + 1] == '/'){
+      pos += 2;
+      if(--depth == 0){
+        return pos;
+      }
+    }
+    else {
+      pos++;
+    }
+  }
+  return size;
+}
+
+size_t SkipNumber(const std::string& sql_statement, size_t pos){
+  auto size = sql_statement.size();
+  while(pos < size && IsDigit(sql_statement[pos])){
+    pos++;
+  }
+  if(pos < size && sql_statement[pos] == '.'){
+    pos++;
+    while(pos < size && IsDigit(sql_statement[pos])){
+      pos++;
+    }
+  }
+  if(pos < size && (sql_statement[pos] == 'e' || sql_statement[pos] == 'E')){
+    auto exponent = pos + 1;
+    if(exponent < size && (sql_statement[exponent] == '+' || sql_statement[exponent] == '-')){
+      exponent++;
+    }
+    if(exponent < size && IsDigit(sql_statement[exponent])){
+      pos = exponent;
+      while(pos < size && IsDigit(sql_statement[pos])){
+        pos++;
+      }
+    }
+  }
+  return pos;
+}
+
+// Length of the operator at a position
+size_t OperatorLength(const std::string& sql_statement, const size_t pos){
+  static const char* operators[] = {
+    "<=>", "->>", "||", "<=", ">=", "<>", "!=", "::", "->", "<<", ">>"
+  };
+  for(auto op : operators){
+    auto length = strlen(op);
+    if(sql_statement.compare(pos, length, op) == 0){
+      return length;
+    }
+  }
+  return 1;
+}
+
+// Indexed by Dialect
+const LexerTable LEXER_TABLES[] = {
+  // name, #, nested, \\, E'', $$, "", ``, [], GO
+  {"generic", false, false, false, false, false, false, true, false, false},
+  {"mysql", true, false, true, false, false, true, true, false, false},
+  {"postgresql", false, true, false, true, true, false, false, false, false},
+  {"sqlserver", false, false, false, false, false, false, false, true, true},
+  {"sqlite", false, false, false, false, false, false, true, true, false}
+};
+
+}  // namespace
+
+const LexerTable& GetLexerTable(const Dialect dialect){
+  return LEXER_TABLES[dialect];
+}
+
+bool ParseDialect(const std::string& name, Dialect& dialect){
+  for(size_t itr = 0; itr < sizeof(LEXER_TABLES) / sizeof(LEXER_TABLES[0]); itr++){
+    if(name == LEXER_TABLES[itr].name){
+      dialect = static_cast<Dialect>(itr);
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t DollarTagLength(const std::string& text, const size_t pos){
+  if(pos >= text.size() || text[pos] != '$'){
+    return 0;
+  }
+  auto end = pos + 1;
+  if(end < text.size() && IsIdentifierStart(text[end])){
+    while(end < text.size() && IsIdentifierPart(text[end]) && text[end] != '$'){
+      end++;
+    }
+  }
+  if(end < text.size() && text[end] == '$'){
+    return end - pos + 1;
+  }
+  return 0;
+}
+
+KeywordId LookupKeyword(const char* word, const size_t length){
+
+  if(length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH){
+    return KEYWORD_NONE;
+  }
+
+  // One probe; the table has no collisions
+  auto& entry = KEYWORD_HASH_TABLE[KeywordHash(word, length)];
+  if(entry.length != length){
+    return KEYWORD_NONE;
+  }
+  for(size_t itr = 0; itr < length; itr++){
+    if(FoldCase(word[itr]) != static_cast<unsigned char>(entry.word[itr])){
+      return KEYWORD_NONE;
+    }
+  }
+  return entry.keyword;
+}
+
+void Tokenize(const std::string& sql_statement,
+              std::vector<Token>& tokens,
+              const Dialect dialect){
+
+  tokens.clear();
+
+  auto& table = GetLexerTable(dialect);
+  auto size = sql_statement.size();
+  size_t pos = 0;
+  while(pos < size){
+    auto c = sql_statement[pos];
+    auto start = pos;
+    auto kind = TOKEN_KIND_INVALID;
+    auto keyword = KEYWORD_NONE;
+
+    if(IsSpace(c)){
+      pos++;
+      continue;
+    }
+
+    // Comments
+    if((c == '-' && pos + 1 < size && sql_statement[pos + 1] == '-') ||
+        (c == '#' && table.hash_comments)){
+      pos = sql_statement.find('\n', pos);
+      pos = (pos == std::string::npos) ? size : pos + 1;
+      continue;
+    }
+    if(c == '/' && pos + 1 < size && sql_statement[pos + 1] == '*'){
+      pos = SkipBlockComment(sql_statement, pos, table.nested_comments);
+      continue;
+    }
+
+    if((c == 'e' || c == 'E') && table.escape_strings &&
+        pos + 1 < size && sql_statement[pos + 1] == '\''){
+      pos = SkipQuoted(sql_statement, pos + 1, '\'', true);
+      kind = TOKEN_KIND_STRING;
+    }
+    else if(IsIdentifierStart(c)){
+      while(pos < size && IsIdentifierPart(sql_statement[pos])){
+        pos++;
+      }
+      keyword = LookupKeyword(sql_statement.data() + start, pos - start);
+      kind = (keyword == KEYWORD_NONE) ? TOKEN_KIND_IDENTIFIER : TOKEN_KIND_KEYWORD;
+    }
+    else if(IsDigit(c) || (c == '.' && pos + 1 < size && IsDigit(sql_statement[pos + 1]))){
+      pos = SkipNumber(sql_statement, pos);
+      kind = TOKEN_KIND_NUMBER;
+    }
+    else if(c == '\''){
+      pos = SkipQuoted(sql_statement, pos, c, table.backslash_escapes);
+      kind = TOKEN_KIND_STRING;
+    }
+    else if(c == '"'){
+      pos = SkipQuoted(sql_statement, pos, c, table.backslash_escapes);
+      kind = table.double_quote_strings ? TOKEN_KIND_STRING : TOKEN_KIND_QUOTED_IDENTIFIER;
+    }
+    else if((c == '`' && table.backtick_identifiers) ||
+        (c == '[' && table.bracket_identifiers)){
+      pos = SkipQuoted(sql_statement, pos, (c == '[') ? ']' : c, false);
+      kind = TOKEN_KIND_QUOTED_IDENTIFIER;
+    }
+    else if(c == '$' && table.dollar_quotes && DollarTagLength(sql_statement, pos) != 0){
+      auto length = DollarTagLength(sql_statement, pos);
+      pos = sql_statement.find(sql_statement.data() + start, start + length, length);
+      pos = (pos == std::string::npos) ? size : pos + length;
+      kind = TOKEN_KIND_STRING;
+    }
+    else if(c == '?' ||
+        ((c == ':' || c == '@' || c == '$') && pos + 1 < size &&
+         IsIdentifierPart(sql_statement[pos + 1]) && sql_statement[pos + 1] != '$')){
+      for(pos = pos + 1; pos < size && IsIdentifierPart(sql_statement[pos]); pos++){
+      }
+      kind = TOKEN_KIND_PARAMETER;
+    }
+    else if(c == '(' || c == ')' || c == ',' || c == ';' || c == '.' ||
+        c == '[' || c == ']' || c == '{' || c == '}'){
+      pos++;
+      kind = TOKEN_KIND_PUNCTUATION;
+    }
+    else {
+      pos += OperatorLength(sql_statement, pos);
+      kind = TOKEN_KIND_OPERATOR;
+    }
+
+    tokens.push_back(Token{kind,
+                           keyword,
+                           static_cast<uint32_t>(start),
+                           static_cast<uint32_t>(pos - start)});
+  }
+
+}
+
+std::string TokenText(const std::string& sql_statement,
+                      const Token& token){
+  return sql_statement.substr(token.offset, token.length);
+}
+
+std::string TokenText(const std::string& sql_statement,
+                      const Token& first,
+                      const Token& last){
+  return sql_statement.substr(first.offset, last.offset + last.length - first.offset);
+}
+
+}  // namespace sqlcheck
@@ -1,6 +1,6 @@
 // LIST SOURCE
 
-#include <regex>
+#include <cstring>
 
 #include "include/list.h"
 #include "include/checker.h"
@@ -9,57 +9,283 @@ namespace sqlcheck {
 
 // UTILITY
 
-std::string GetTableName(const std::string& sql_statement){
-  std::string table_template = "create table";
-  std::size_t found = sql_statement.find(table_template);
-  if (found == std::string::npos) {
-    return "";
-  }
+namespace {
+
+bool IsDigit(const char c){
+  return c >= '0' && c <= '9';
+}
 
-  // Locate table name
-  auto rest = sql_statement.substr(found + table_template.size());
-  // Strip space at beginning
-  rest = std::regex_replace(rest, std::regex("^ +| +$|( ) +"), "$1");
-  auto table_name = rest.substr(0, rest.find(' '));
+bool IsKeyword(const std::vector<Token>& tokens,
+               const size_t pos,
+               const KeywordId keyword){
+  return pos < tokens.size() && tokens[pos].keyword == keyword;
+}
 
-  return table_name;
+bool TextEquals(const std::string& sql_statement,
+                const Token& token,
+                const char* text){
+  auto length = strlen(text);
+  return token.length == length && sql_statement.compare(token.offset, length, text) == 0;
 }
 
-bool IsDDLStatement(const std::string& sql_statement){
-  std::string create_table_template = "create table";
-  std::size_t found = sql_statement.find(create_table_template);
-  if (found != std::string::npos) {
+bool SameText(const std::string& sql_statement,
+              const Token& left,
+              const Token& right){
+  return left.length == right.length &&
+      sql_statement.compare(left.offset, left.length,
+                            sql_statement, right.offset, right.length) == 0;
+}
+
+bool StartsWith(const std::string& sql_statement,
+                const Token& token,
+                const char* prefix){
+  auto length = strlen(prefix);
+  return token.length >= length && sql_statement.compare(token.offset, length, prefix) == 0;
+}
+
+bool EndsWith(const std::string& sql_statement,
+              const Token& token,
+              const char* suffix){
+  auto length = strlen(suffix);
+  return token.length >= length &&
+      sql_statement.compare(token.offset + token.length - length, length, suffix) == 0;
+}
+
+// Check for an operator or punctuation symbol
+bool IsSymbol(const std::string& sql_statement,
+              const std::vector<Token>& tokens,
+              const size_t pos,
+              const char* symbol){
+  return pos < tokens.size() &&
+      (tokens[pos].kind == TOKEN_KIND_OPERATOR || tokens[pos].kind == TOKEN_KIND_PUNCTUATION) &&
+      TextEquals(sql_statement, tokens[pos], symbol);
+}
+
+// Position of the first token from start satisfying a predicate, or npos
+template <typename Predicate>
+size_t FindToken(const std::vector<Token>& tokens,
+                 Predicate predicate,
+                 const size_t start = 0){
+  for(size_t pos = start; pos < tokens.size(); pos++){
+    if(predicate(pos)){
+      return pos;
+    }
+  }
+  return std::string::npos;
+}
+
+// Position of the first occurrence of a keyword sequence from start, or npos
+size_t FindKeywords(const std::vector<Token>& tokens,
+                    std::initializer_list<KeywordId> keywords,
+                    const size_t start = 0){
+  return FindToken(tokens, [&](const size_t pos){
+    size_t offset = 0;
+    for(auto keyword : keywords){
+      if(IsKeyword(tokens, pos + offset++, keyword) == false){
+        return false;
+      }
+    }
     return true;
+  }, start);
+}
+
+size_t CountKeyword(const std::vector<Token>& tokens,
+                    const KeywordId keyword){
+  size_t count = 0;
+  for(auto& token : tokens){
+    count += (token.keyword == keyword);
+  }
+  return count;
+}
+
+// Position after CREATE [TEMPORARY] TABLE, or npos
+size_t CreateTableEnd(const std::vector<Token>& tokens){
+  size_t pos = IsKeyword(tokens, 1, KEYWORD_TEMPORARY) ? 2 : 1;
+  if(IsKeyword(tokens, 0, KEYWORD_CREATE) && IsKeyword(tokens, pos, KEYWORD_TABLE)){
+    return pos + 1;
+  }
+  return std::string::npos;
+}
+
+// Position of the table name in a CREATE TABLE statement, or npos
+size_t FindTableName(const std::vector<Token>& tokens){
+  auto pos = CreateTableEnd(tokens);
+  if(pos == std::string::npos){
+    return pos;
   }
 
-  std::string alter_table_template = "alter table";
-  found = sql_statement.find(alter_table_template);
-  if (found != std::string::npos) {
+  if(IsKeyword(tokens, pos, KEYWORD_IF) &&
+      IsKeyword(tokens, pos + 1, KEYWORD_NOT) &&
+      IsKeyword(tokens, pos + 2, KEYWORD_EXISTS)){
+    pos += 3;
+  }
+  if(pos >= tokens.size() ||
+      (tokens[pos].kind != TOKEN_KIND_IDENTIFIER &&
+       tokens[pos].kind != TOKEN_KIND_QUOTED_IDENTIFIER)){
+    return std::string::npos;
+  }
+  return pos;
+}
+
+bool IsCreateStatement(const std::vector<Token>& tokens){
+  return CreateTableEnd(tokens) != std::string::npos;
+}
+
+bool IsDDLStatement(const std::vector<Token>& tokens){
+  if(IsCreateStatement(tokens)){
     return true;
   }
 
+  return IsKeyword(tokens, 0, KEYWORD_ALTER) && IsKeyword(tokens, 1, KEYWORD_TABLE);
+}
+
+// First node in pre-order (over siblings and descendants) satisfying a
+// predicate, or null
+template <typename Predicate>
+const Node* FindNode(const Node* node,
+                     Predicate predicate){
+  for(; node != nullptr; node = node->next){
+    if(predicate(node)){
+      return node;
+    }
+    auto match = FindNode(node->child, predicate);
+    if(match != nullptr){
+      return match;
+    }
+  }
+  return nullptr;
+}
+
+const Node* FindNode(const Node* node,
+                     const NodeKind kind){
+  return FindNode(node, [&](const Node* itr){
+    return itr->kind == kind;
+  });
+}
+
+std::string NodeText(const Statement& statement,
+                     const Node* node){
+  return TokenText(statement.text,
+                   statement.tokens[node->first],
+                   statement.tokens[node->last]);
+}
+
+// Check whether two nodes span the same token text
+bool SameNodes(const Statement& statement,
+               const Node* left,
+               const Node* right){
+  if(left->last - left->first != right->last - right->first){
+    return false;
+  }
+  for(uint32_t offset = 0; offset <= left->last - left->first; offset++){
+    if(SameText(statement.text,
+                statement.tokens[left->first + offset],
+                statement.tokens[right->first + offset]) == false){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsFunction(const Statement& statement,
+                const Node* node,
+                std::initializer_list<const char*> names){
+  if(node->kind != NODE_KIND_FUNCTION){
+    return false;
+  }
+  for(auto name : names){
+    if(TextEquals(statement.text, statement.tokens[node->token], name)){
+      return true;
+    }
+  }
   return false;
 }
 
-bool IsCreateStatement(const std::string& sql_statement){
-  std::string create_table_template = "create table";
-  std::size_t found = sql_statement.find(create_table_template);
-  if (found != std::string::npos) {
+bool IsAggregate(const Statement& statement,
+                 const Node* node){
+  return IsFunction(statement, node, {
+      "count", "sum", "avg", "min", "max", "group_concat", "string_agg",
+      "array_agg", "json_agg", "json_arrayagg", "listagg", "bit_and", "bit_or",
+      "bool_and", "bool_or", "every", "stddev", "variance", "any_value"
+    });
+}
+
+// Check whether a column is listed in a GROUP BY clause, by its full or
+// last name (ROLLUP and CUBE lists are searched too)
+bool IsGroupedColumn(const Statement& statement,
+                     const Node* column,
+                     const Node* keys){
+  for(auto key = keys; key != nullptr; key = key->next){
+    if(key->kind == NODE_KIND_COLUMN &&
+        (SameNodes(statement, column, key) ||
+         SameText(statement.text,
+                  statement.tokens[column->token],
+                  statement.tokens[key->token]))){
+      return true;
+    }
+    if((key->kind == NODE_KIND_LIST || IsFunction(statement, key, {"rollup", "cube"})) &&
+        IsGroupedColumn(statement, column, key->child)){
+      return true;
+    }
+  }
+  return false;
+}
+
+// Check whether an expression has a single value per group: it is a
+// grouping key, or its columns are all grouped or aggregated
+bool IsGroupedExpression(const Statement& statement,
+                         const Node* expression,
+                         const Node* group_by){
+  for(auto key = group_by->child; key != nullptr; key = key->next){
+    if(SameNodes(statement, expression, key)){
+      return true;
+    }
+  }
+
+  switch(expression->kind){
+    case NODE_KIND_STAR:
+      return false;
+    case NODE_KIND_COLUMN:
+      return IsGroupedColumn(statement, expression, group_by->child);
+    case NODE_KIND_SUBQUERY:
+      return true;
+    default:
+      break;
+  }
+  if(IsAggregate(statement, expression)){
     return true;
   }
 
-  return false;
+  for(auto child = expression->child; child != nullptr; child = child->next){
+    if(IsGroupedExpression(statement, child, group_by) == false){
+      return false;
+    }
+  }
+  return true;
 }
 
-// LOGICAL DATABASE DESIGN
+}  // namespace
 
+// LOGICAL DATABASE DESIGN
 
 void CheckMultiValuedAttribute(Configuration& state,
-                               const std::string& sql_statement,
-                               bool& print_statement){
+                               const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return tokens[itr].kind == TOKEN_KIND_IDENTIFIER &&
+        EndsWith(sql_statement, tokens[itr], "id") &&
+        (IsKeyword(tokens, itr + 1, KEYWORD_VARCHAR) ||
+         IsKeyword(tokens, itr + 1, KEYWORD_TEXT) ||
+         IsKeyword(tokens, itr + 1, KEYWORD_REGEXP));
+  });
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("(id\\s+varchar)|(id\\s+text)|(id\\s+regexp)");
-  std::string title = "Multi-Valued Attribute";
+  PatternId pattern_id = PATTERN_ID_MULTI_VALUED_ATTRIBUTE;
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
   auto message =
@@ -74,29 +300,37 @@ void CheckMultiValuedAttribute(Configuration& state,
       "between the two referenced tables. This will greatly simplify querying and validating "
       "the IDs.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_HIGH,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_HIGH,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[pos + 1]),
+             true);
 
 }
 
 void CheckRecursiveDependency(Configuration& state,
-                              const std::string& sql_statement,
-                              bool& print_statement){
+                              const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto table = FindTableName(tokens);
+  if(table == std::string::npos){
+    return;
+  }
 
-  std::string table_name = GetTableName(sql_statement);
-  if(table_name.empty()){
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return IsKeyword(tokens, itr, KEYWORD_REFERENCES) &&
+        itr + 1 < tokens.size() &&
+        SameText(sql_statement, tokens[itr + 1], tokens[table]);
+  });
+  if(pos == std::string::npos){
     return;
   }
 
-  std::regex pattern("(references\\s+" + table_name+ ")");
-  std::string title = "Recursive Dependency";
+  PatternId pattern_id = PATTERN_ID_RECURSIVE_DEPENDENCY;
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
   auto message =
@@ -111,29 +345,33 @@ void CheckRecursiveDependency(Configuration& state,
       "You might want to compare different hierarchical data designs -- closure table, "
       "path enumeration, nested sets -- and pick one based on your application's needs.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_HIGH,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_HIGH,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[pos + 1]),
+             true);
 
 }
 
 void CheckPrimaryKeyExists(Configuration& state,
-                           const std::string& sql_statement,
-                           bool& print_statement){
+                           const Statement& statement){
 
-  auto create_statement = IsCreateStatement(sql_statement);
-  if(create_statement == false){
+  auto table = FindNode(statement.tree, NODE_KIND_CREATE_TABLE);
+  if(table == nullptr){
+    return;
+  }
+
+  // Primary keys are declared as table or column constraints
+  auto key = FindNode(table->child, [](const Node* node){
+    return node->kind == NODE_KIND_CONSTRAINT && node->keyword == KEYWORD_PRIMARY;
+  });
+  if(key != nullptr){
     return;
   }
 
-  std::regex pattern("(primary key)");
-  std::string title = "Primary Key Does Not Exist";
+  PatternId pattern_id = PATTERN_ID_PRIMARY_KEY_EXISTS;
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
   auto message =
@@ -146,29 +384,40 @@ void CheckPrimaryKeyExists(Configuration& state,
       "checking for duplicate rows. More often than not, you will need to define "
       "a primary key for every table. Use compound keys when they are appropriate.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               false);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             "",
+             false);
 
 }
 
 void CheckGenericPrimaryKey(Configuration& state,
-                            const std::string& sql_statement,
-                            bool& print_statement){
+                            const Statement& statement){
 
-  auto ddl_statement = IsDDLStatement(sql_statement);
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto ddl_statement = IsDDLStatement(tokens);
   if(ddl_statement == false){
     return;
   }
 
-  std::regex pattern("(\\s+[\\(]?id\\s+)|(,id\\s+)|(\\s+id\\s+serial)");
-  std::string title = "Generic Primary Key";
+  // Column named id followed by its type
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return tokens[itr].kind == TOKEN_KIND_IDENTIFIER &&
+        TextEquals(sql_statement, tokens[itr], "id") &&
+        itr + 1 < tokens.size() &&
+        (tokens[itr + 1].kind == TOKEN_KIND_KEYWORD ||
+         tokens[itr + 1].kind == TOKEN_KIND_IDENTIFIER);
+  });
+  if(pos == std::string::npos){
+    return;
+  }
+
+  PatternId pattern_id = PATTERN_ID_GENERIC_PRIMARY_KEY;
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
   auto message =
@@ -180,29 +429,34 @@ void CheckGenericPrimaryKey(Configuration& state,
       "important when you join two tables and they have the same primary "
       "key column name.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_HIGH,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_HIGH,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[pos + 1]),
+             true);
 
 }
 
 void CheckForeignKeyExists(Configuration& state,
-                           const std::string& sql_statement,
-                           bool& print_statement){
+                           const Statement& statement){
 
-  auto create_statement = IsCreateStatement(sql_statement);
-  if(create_statement == false){
+  auto table = FindNode(statement.tree, NODE_KIND_CREATE_TABLE);
+  if(table == nullptr){
+    return;
+  }
+
+  // Foreign keys are declared as table constraints or inline references
+  auto key = FindNode(table->child, [](const Node* node){
+    return node->kind == NODE_KIND_CONSTRAINT &&
+        (node->keyword == KEYWORD_FOREIGN || node->keyword == KEYWORD_REFERENCES);
+  });
+  if(key != nullptr){
     return;
   }
 
-  std::regex pattern("(foreign key)");
-  std::string title = "Foreign Key Does Not Exist";
+  PatternId pattern_id = PATTERN_ID_FOREIGN_KEY_EXISTS;
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
   auto message =
@@ -219,34 +473,34 @@ void CheckForeignKeyExists(Configuration& state,
       "in the foreign key constraint allow you to control the result of a cascading "
       "operation. Make your database mistake-proof with constraints.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               false);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             "",
+             false);
 
 }
 
 void CheckVariableAttribute(Configuration& state,
-                            const std::string& sql_statement,
-                            bool& print_statement){
+                            const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
 
-  std::string table_name = GetTableName(sql_statement);
-  if(table_name.empty()){
+  auto table = FindTableName(tokens);
+  if(table == std::string::npos){
     return;
   }
 
+  auto table_name = TokenText(sql_statement, tokens[table]);
   auto found = table_name.find("attribute");
-  if (found == std::string::npos) {
+  if(found == std::string::npos){
     return;
   }
 
-  std::regex pattern("(attribute)");
-  std::string title = "Entity-Attribute-Value Pattern";
+  PatternId pattern_id = PATTERN_ID_VARIABLE_ATTRIBUTE;
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
   auto message =
@@ -275,29 +529,38 @@ void CheckVariableAttribute(Configuration& state,
       "This design is best when you can’t limit yourself to a finite set of subtypes "
       "and when you need complete flexibility to define new attributes at any time.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             table_name,
+             true);
 
 }
 
 void CheckMetadataTribbles(Configuration& state,
-                           const std::string& sql_statement,
-                           bool& print_statement){
+                           const Statement& statement){
 
-  auto ddl_statement = IsDDLStatement(sql_statement);
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto ddl_statement = IsDDLStatement(tokens);
   if(ddl_statement == false){
     return;
   }
 
-  std::regex pattern("[A-za-z\\-_@]+[0-9]+ ");
-  std::string title = "Metadata Tribbles";
+  // Names ending with a number
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    auto& token = tokens[itr];
+    return token.kind == TOKEN_KIND_IDENTIFIER &&
+        IsDigit(sql_statement[token.offset + token.length - 1]);
+  });
+  if(pos == std::string::npos){
+    return;
+  }
+
+  PatternId pattern_id = PATTERN_ID_METADATA_TRIBBLES;
   PatternType pattern_type = PatternType::PATTERN_TYPE_LOGICAL_DATABASE_DESIGN;
 
   std::string message1 =
@@ -329,26 +592,38 @@ void CheckMetadataTribbles(Configuration& state,
 
   auto message = message1 + "\n" + message2;
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 // PHYSICAL DATABASE DESIGN
 
 void CheckFloat(Configuration& state,
-                const std::string& sql_statement,
-                bool& print_statement){
+                const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return IsKeyword(tokens, itr, KEYWORD_FLOAT) ||
+        IsKeyword(tokens, itr, KEYWORD_REAL) ||
+        IsKeyword(tokens, itr, KEYWORD_DOUBLE) ||
+        (tokens[itr].kind == TOKEN_KIND_NUMBER &&
+         StartsWith(sql_statement, tokens[itr], "0.000"));
+  });
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("(float)|(real)|(double precision)|(0\\.000[0-9]*)");
-  std::string title = "Imprecise Data Type";
+  auto last = IsKeyword(tokens, pos + 1, KEYWORD_PRECISION) ? pos + 1 : pos;
+
+  PatternId pattern_id = PATTERN_ID_FLOAT;
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
   auto message =
@@ -362,29 +637,39 @@ void CheckFloat(Configuration& state,
       "exactly, up to the precision you specify in the column definition. "
       "Do not use FLOAT if you can avoid it.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[last]),
+             true);
 
 }
 
 void CheckValuesInDefinition(Configuration& state,
-                             const std::string& sql_statement,
-                             bool& print_statement){
+                             const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
 
-  auto ddl_statement = IsDDLStatement(sql_statement);
+  auto ddl_statement = IsDDLStatement(tokens);
   if(ddl_statement == false){
     return;
   }
 
-  std::regex pattern("(enum)|(in \\()");
-  std::string title = "Values In Definition";
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return IsKeyword(tokens, itr, KEYWORD_ENUM) ||
+        (IsKeyword(tokens, itr, KEYWORD_IN) &&
+         IsSymbol(sql_statement, tokens, itr + 1, "("));
+  });
+  if(pos == std::string::npos){
+    return;
+  }
+
+  auto last = IsKeyword(tokens, pos, KEYWORD_IN) ? pos + 1 : pos;
+
+  PatternId pattern_id = PATTERN_ID_VALUES_IN_DEFINITION;
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
   auto message =
@@ -406,24 +691,34 @@ void CheckValuesInDefinition(Configuration& state,
       "Use metadata when validating against a fixed set of values. "
       "Use data when validating against a fluid set of values.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[last]),
+             true);
 
 }
 
 void CheckExternalFiles(Configuration& state,
-                        const std::string& sql_statement,
-                        bool& print_statement){
+                        const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return tokens[itr].kind == TOKEN_KIND_IDENTIFIER &&
+        ((EndsWith(sql_statement, tokens[itr], "path") &&
+          IsKeyword(tokens, itr + 1, KEYWORD_VARCHAR)) ||
+         (TextEquals(sql_statement, tokens[itr], "unlink") &&
+          IsSymbol(sql_statement, tokens, itr + 1, "(")));
+  });
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("(path varchar)|(unlink\\s?\\()");
-  std::string title = "Files Are Not SQL Data Types";
+  PatternId pattern_id = PATTERN_ID_EXTERNAL_FILES;
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
   auto message =
@@ -437,30 +732,44 @@ void CheckExternalFiles(Configuration& state,
       "You should consider storing blobs inside the database instead of in "
       "external files. You can save the contents of a BLOB column to a file.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[pos + 1]),
+             true);
 
 }
 
 void CheckIndexCount(Configuration& state,
-                     const std::string& sql_statement,
-                     bool& print_statement){
+                     const Statement& statement){
 
-  auto create_statement = IsCreateStatement(sql_statement);
-  if(create_statement == false){
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  if(IsDDLStatement(tokens) == false &&
+      FindNode(statement.tree, NODE_KIND_CREATE_INDEX) == nullptr){
     return;
   }
 
+  auto index_count = CountKeyword(tokens, KEYWORD_INDEX);
+
+  // Migrations keep a schema catalog with the indexes that earlier
+  // statements added to the table
+  auto table = state.catalog.FindTargetTable(sql_statement);
+  if(table != nullptr){
+    index_count += table->indexes.size();
+  }
+
   std::size_t min_count = 3;
-  std::regex pattern("(index)");
-  std::string title = "Too Many Indexes";
+  if(index_count <= min_count){
+    return;
+  }
+
+  auto pos = FindKeywords(tokens, {KEYWORD_INDEX});
+
+  PatternId pattern_id = PATTERN_ID_INDEX_COUNT;
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
   auto message =
@@ -474,26 +783,29 @@ void CheckIndexCount(Configuration& state,
       "rows of data from the table at all. Consider using such covering indexes. "
       "Know your data, know your queries, and maintain the right set of indexes.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true,
-               min_count);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckIndexAttributeOrder(Configuration& state,
-                              const std::string& sql_statement,
-                              bool& print_statement){
+                              const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
 
+  auto pos = IsKeyword(tokens, 1, KEYWORD_UNIQUE) ? 2 : 1;
+  if(IsKeyword(tokens, 0, KEYWORD_CREATE) == false ||
+      IsKeyword(tokens, pos, KEYWORD_INDEX) == false){
+    return;
+  }
 
-  std::regex pattern("(create index)");
-  std::string title = "Index Attribute Order";
+  PatternId pattern_id = PATTERN_ID_INDEX_ATTRIBUTE_ORDER;
   PatternType pattern_type = PatternType::PATTERN_TYPE_PHYSICAL_DATABASE_DESIGN;
 
   auto message =
@@ -506,15 +818,13 @@ void CheckIndexAttributeOrder(Configuration& state,
       "EX: CREATE INDEX TelephoneBook ON Accounts(last_name, first_name); "
       "SELECT * FROM Accounts ORDER BY first_name, last_name;";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[0], tokens[pos]),
+             true);
 
 }
 
@@ -522,11 +832,26 @@ void CheckIndexAttributeOrder(Configuration& state,
 // QUERY
 
 void CheckSelectStar(Configuration& state,
-                     const std::string& sql_statement,
-                     bool& print_statement){
+                     const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  // Star (or qualified star) in a select list, not as a function argument
+  const Node* star = nullptr;
+  auto query = FindNode(statement.tree, [&](const Node* node){
+    if(node->kind != NODE_KIND_QUERY){
+      return false;
+    }
+    auto select_list = FindChild(node, NODE_KIND_SELECT_LIST);
+    star = FindChild(select_list, NODE_KIND_STAR);
+    return star != nullptr;
+  });
+  if(query == nullptr){
+    return;
+  }
 
-  std::regex pattern("(select\\s+\\*)");
-  std::string title = "SELECT *";
+  PatternId pattern_id = PATTERN_ID_SELECT_STAR;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   std::string message1 =
@@ -564,24 +889,28 @@ void CheckSelectStar(Configuration& state,
 
   auto message = message1 + "\n" + message2 + "\n" + message3;
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_HIGH,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_HIGH,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[query->first], tokens[star->last]),
+             true);
 
 }
 
 void CheckNullUsage(Configuration& state,
-                    const std::string& sql_statement,
-                    bool& print_statement) {
+                    const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindKeywords(tokens, {KEYWORD_NULL});
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("(null)");
-  std::string title = "NULL Usage";
+  PatternId pattern_id = PATTERN_ID_NULL_USAGE;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -595,29 +924,33 @@ void CheckNullUsage(Configuration& state,
       "for the row to exist without a value in that column. "
       "Use null to signify a missing value for any data type.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_NONE,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_NONE,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckNotNullUsage(Configuration& state,
-                       const std::string& sql_statement,
-                       bool& print_statement) {
+                       const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
 
-  auto create_statement = IsCreateStatement(sql_statement);
+  auto create_statement = IsCreateStatement(tokens);
   if(create_statement == false){
     return;
   }
 
-  std::regex pattern("(not null)");
-  std::string title = "NOT NULL Usage";
+  auto pos = FindKeywords(tokens, {KEYWORD_NOT, KEYWORD_NULL});
+  if(pos == std::string::npos){
+    return;
+  }
+
+  PatternId pattern_id = PATTERN_ID_NOT_NULL_USAGE;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -626,25 +959,30 @@ void CheckNotNullUsage(Configuration& state,
       "for the row to exist without a value in that column. "
       "Use null to signify a missing value for any data type.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_NONE,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_NONE,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[pos + 1]),
+             true);
 
 }
 
 void CheckConcatenation(Configuration& state,
-                        const std::string& sql_statement,
-                        bool& print_statement) {
+                        const Statement& statement){
 
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return IsSymbol(sql_statement, tokens, itr, "||");
+  });
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("\\|\\|");
-  std::string title = "String Concatenation";
+  PatternId pattern_id = PATTERN_ID_CONCATENATION;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -656,24 +994,62 @@ void CheckConcatenation(Configuration& state,
       "EX: SELECT first_name || COALESCE(' ' || middle_initial || ' ', ' ') || last_name "
       "AS full_name FROM Accounts;";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckGroupByUsage(Configuration& state,
-                       const std::string& sql_statement,
-                       bool& print_statement){
+                       const Statement& statement){
+
+  // Select item that is neither grouped nor aggregated
+  const Node* item = nullptr;
+  FindNode(statement.tree, [&](const Node* node){
+    if(node->kind != NODE_KIND_QUERY){
+      return false;
+    }
+    auto group_by = FindChild(node, NODE_KIND_GROUP_BY);
+    if(group_by == nullptr){
+      return false;
+    }
+
+    // Positional references are not resolved
+    auto ordinal = FindChild(group_by, NODE_KIND_LITERAL);
+    if(ordinal != nullptr){
+      return false;
+    }
+
+    auto select_list = FindChild(node, NODE_KIND_SELECT_LIST);
+    for(item = select_list->child; item != nullptr; item = item->next){
+      auto expression = (item->kind == NODE_KIND_ALIAS) ? item->child : item;
+      if(IsGroupedExpression(statement, expression, group_by)){
+        continue;
+      }
+
+      // Grouped by its alias
+      auto alias = FindNode(group_by->child, [&](const Node* key){
+        return item->kind == NODE_KIND_ALIAS && key->kind == NODE_KIND_COLUMN &&
+            key->first == key->last &&
+            SameText(statement.text,
+                     statement.tokens[key->token],
+                     statement.tokens[item->token]);
+      });
+      if(alias == nullptr){
+        return true;
+      }
+    }
+    return false;
+  });
+  if(item == nullptr){
+    return;
+  }
 
-  std::regex pattern("(group by)");
-  std::string title = "GROUP BY Usage";
+  PatternId pattern_id = PATTERN_ID_GROUP_BY_USAGE;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -689,25 +1065,40 @@ void CheckGroupByUsage(Configuration& state,
       "aggregate function or the GROUP BY clause. "
       "Follow the single-value rule to avoid ambiguous query results.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
-
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             NodeText(statement, item),
+             true);
 
 }
 
 void CheckOrderByRand(Configuration& state,
-                      const std::string& sql_statement,
-                      bool& print_statement){
+                      const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  // Random function as a sort key
+  const Node* function = nullptr;
+  auto order_by = FindNode(statement.tree, [&](const Node* node){
+    if(node->kind != NODE_KIND_ORDER_BY){
+      return false;
+    }
+    for(function = node->child; function != nullptr; function = function->next){
+      if(IsFunction(statement, function, {"rand", "random"})){
+        return true;
+      }
+    }
+    return false;
+  });
+  if(order_by == nullptr){
+    return;
+  }
 
-  std::regex pattern("(order by rand\\()");
-  std::string title = "ORDER BY RAND Usage";
+  PatternId pattern_id = PATTERN_ID_ORDER_BY_RAND;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -725,24 +1116,34 @@ void CheckOrderByRand(Configuration& state,
       "the count. Then use this number as an offset when querying the data set. "
       "Some queries just cannot be optimized; consider taking a different approach.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[order_by->first], tokens[function->last]),
+             true);
 
 }
 
 void CheckPatternMatching(Configuration& state,
-                          const std::string& sql_statement,
-                          bool& print_statement){
+                          const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
 
-  std::regex pattern("(\blike\b)|(\bregexp\b)|(\bsimilar to\b)");
-  std::string title = "Pattern Matching Usage";
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return IsKeyword(tokens, itr, KEYWORD_LIKE) ||
+        IsKeyword(tokens, itr, KEYWORD_REGEXP) ||
+        (IsKeyword(tokens, itr, KEYWORD_SIMILAR) && IsKeyword(tokens, itr + 1, KEYWORD_TO));
+  });
+  if(pos == std::string::npos){
+    return;
+  }
+
+  auto last = IsKeyword(tokens, pos, KEYWORD_SIMILAR) ? pos + 1 : pos;
+
+  PatternId pattern_id = PATTERN_ID_PATTERN_MATCHING;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -755,37 +1156,40 @@ void CheckPatternMatching(Configuration& state,
       "Consider using vendor extensions like FULLTEXT INDEX in MySQL. "
       "More broadly, you don't have to use SQL to solve every problem.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_MEDIUM,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_MEDIUM,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[last]),
+             true);
 
 }
 
 void CheckSpaghettiQuery(Configuration& state,
-                         const std::string& sql_statement,
-                         bool& print_statement){
-
-  std::regex true_pattern(".+");
-  std::regex false_pattern("pattern must not exist");
-  std::regex pattern;
+                         const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  // Length of the code, without comments and with each string literal
+  // counted as a single character
+  std::size_t length = 0;
+  std::size_t end = 0;
+  for(auto& token : tokens){
+    length += (token.kind == TOKEN_KIND_STRING) ? 1 : token.length;
+    length += (token.offset > end && end != 0);
+    end = token.offset + token.length;
+  }
 
-  std::string title = "Spaghetti Query Alert";
-  PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
   std::size_t spaghetti_query_char_count = 500;
-
-  if(sql_statement.size() >= spaghetti_query_char_count){
-    pattern = true_pattern;
-  }
-  else {
-    pattern = false_pattern;
+  if(length < spaghetti_query_char_count){
+    return;
   }
 
+  PatternId pattern_id = PATTERN_ID_SPAGHETTI_QUERY;
+  PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
+
   auto message =
       "● Split up a complex spaghetti query into several simpler queries:  "
       "SQL is a very expressive language—you can accomplish a lot in a single query or statement. "
@@ -809,53 +1213,78 @@ void CheckSpaghettiQuery(Configuration& state,
       "Although SQL makes it seem possible to solve a complex problem in a single line of code, "
       "don't be tempted to build a house of cards.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             sql_statement,
+             true);
 
 }
 
 void CheckJoinCount(Configuration& state,
-                    const std::string& sql_statement,
-                    bool& print_statement){
+                    const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  // Explicit joins and comma-separated tables
+  std::size_t join_count = 0;
+  const Node* first_join = nullptr;
+  VisitNodes(statement.tree, [&](const Node* node){
+    if(node->kind == NODE_KIND_JOIN){
+      join_count++;
+      first_join = (first_join == nullptr) ? node : first_join;
+    }
+    else if(node->kind == NODE_KIND_FROM){
+      for(auto table = node->child; table != nullptr && table->next != nullptr; table = table->next){
+        join_count++;
+        first_join = (first_join == nullptr) ? node : first_join;
+      }
+    }
+  });
 
-  std::regex pattern("(\bjoin\b)");
-  std::string title = "Reduce Number of JOINs";
-  PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
   std::size_t min_count = 5;
+  if(join_count <= min_count){
+    return;
+  }
+
+  auto pos = first_join->token;
+
+  PatternId pattern_id = PATTERN_ID_JOIN_COUNT;
+  PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
       "● Reduce Number of JOINs:  "
       "Too many JOINs is a symptom of complex spaghetti queries. Consider splitting "
       "up the complex query into many simpler queries, and reduce the number of JOINs";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true,
-               min_count);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckDistinctCount(Configuration& state,
-                        const std::string& sql_statement,
-                        bool& print_statement){
+                        const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
 
-  std::regex pattern("(\bdistinct\b)");
-  std::string title = "Eliminate Unnecessary DISTINCT Conditions";
-  PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
   std::size_t min_count = 5;
+  if(CountKeyword(tokens, KEYWORD_DISTINCT) <= min_count){
+    return;
+  }
+
+  auto pos = FindKeywords(tokens, {KEYWORD_DISTINCT});
+
+  PatternId pattern_id = PATTERN_ID_DISTINCT_COUNT;
+  PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
       "● Eliminate Unnecessary DISTINCT Conditions:  "
@@ -865,25 +1294,39 @@ void CheckDistinctCount(Configuration& state,
       "It is possible that the DISTINCT condition has no effect if a primary key "
       "column is part of the result set of columns";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true,
-               min_count);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckImplicitColumns(Configuration& state,
-                          const std::string& sql_statement,
-                          bool& print_statement){
+                          const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  // Inserted rows without a column list
+  const Node* rows = nullptr;
+  auto insert = FindNode(statement.tree, [&](const Node* node){
+    if(node->kind != NODE_KIND_INSERT || FindChild(node, NODE_KIND_COLUMN_LIST) != nullptr){
+      return false;
+    }
+    rows = FindNode(node->child, [](const Node* child){
+      return child->kind == NODE_KIND_VALUES || child->kind == NODE_KIND_QUERY ||
+          child->kind == NODE_KIND_SET_OPERATION || child->kind == NODE_KIND_WITH;
+    });
+    return rows != nullptr;
+  });
+  if(insert == nullptr){
+    return;
+  }
 
-  std::regex pattern("(insert into \\S+ values)");
-  std::string title = "Implicit Column Usage";
+  PatternId pattern_id = PATTERN_ID_IMPLICIT_COLUMNS;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -894,24 +1337,28 @@ void CheckImplicitColumns(Configuration& state,
       "Always spell out all the columns you need, instead of relying on "
       "wild-cards or implicit column lists.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[insert->first], tokens[rows->first]),
+             true);
 
 }
 
 void CheckHaving(Configuration& state,
-                 const std::string& sql_statement,
-                 bool& print_statement){
+                 const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindKeywords(tokens, {KEYWORD_HAVING});
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("(\bhaving\b)");
-  std::string title = "HAVING Clause Usage";
+  PatternId pattern_id = PATTERN_ID_HAVING;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -923,26 +1370,45 @@ void CheckHaving(Configuration& state,
       "SELECT s.cust_id,count(cust_id) FROM SH.sales s WHERE s.cust_id != '1660' "
       "AND s.cust_id !='2' GROUP BY s.cust_id;";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckNesting(Configuration& state,
-                  const std::string& sql_statement,
-                  bool& print_statement){
+                  const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  // Subquery within an expression (derived tables and CTEs are not nested),
+  // or derived tables nested too deeply
+  SubqueryInfo subqueries;
+  AnalyzeSubqueries(sql_statement, tokens, statement.tree, subqueries);
+  std::size_t max_depth = 3;
+  auto subquery = FindNode(statement.tree, NODE_KIND_SUBQUERY);
+  if((subquery == nullptr || subquery->child == nullptr) && subqueries.max_depth < max_depth){
+    return;
+  }
+
+  // Correlated subqueries run once per row of the enclosing query
+  auto risk_level = RISK_LEVEL_LOW;
+  if(subqueries.correlated.empty() == false){
+    subquery = subqueries.correlated.front();
+    risk_level = RISK_LEVEL_MEDIUM;
+  }
+  else if(subqueries.max_depth >= max_depth){
+    subquery = subqueries.deepest;
+    risk_level = RISK_LEVEL_MEDIUM;
+  }
 
-  std::regex pattern("(\bselect\b)");
-  std::string title = "Nested sub queries";
+  PatternId pattern_id = PATTERN_ID_NESTING;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
-  std::size_t min_count = 2;
 
   auto message =
       "● Un-nest sub queries:  "
@@ -958,26 +1424,28 @@ void CheckNesting(Configuration& state,
       "SELECT p.* FROM SH.products p, sales s WHERE p.prod_id = s.prod_id AND "
       "s.cust_id = 100996 AND s.quantity_sold = 1;";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true,
-               min_count);
-
+  AddFinding(state,
+             risk_level,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[subquery->first], tokens[subquery->child->first]),
+             true);
 
 }
 
 void CheckOr(Configuration& state,
-                 const std::string& sql_statement,
-                 bool& print_statement){
+                 const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindKeywords(tokens, {KEYWORD_OR});
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("(\bor\b)");
-  std::string title = "OR Usage";
+  PatternId pattern_id = PATTERN_ID_OR;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -991,24 +1459,34 @@ void CheckOr(Configuration& state,
       "can be rewritten as:  "
       "SELECT s.* FROM SH.sales s WHERE s.prod_id IN (14, 17);";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckUnion(Configuration& state,
-                const std::string& sql_statement,
-                bool& print_statement){
+                const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
 
-  std::regex pattern("(union)");
-  std::string title = "UNION Usage";
+  // UNION without ALL
+  auto operation = FindNode(statement.tree, [&](const Node* node){
+    return node->kind == NODE_KIND_SET_OPERATION && node->keyword == KEYWORD_UNION &&
+        IsKeyword(tokens, node->token + 1, KEYWORD_ALL) == false;
+  });
+  if(operation == nullptr){
+    return;
+  }
+
+  auto pos = operation->token;
+
+  PatternId pattern_id = PATTERN_ID_UNION;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -1017,24 +1495,37 @@ void CheckUnion(Configuration& state,
       "If you do not care about duplicate tuples, then using UNION ALL would be "
       "a faster option.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos]),
+             true);
 
 }
 
 void CheckDistinctJoin(Configuration& state,
-                       const std::string& sql_statement,
-                       bool& print_statement){
+                       const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  // Distinct query over joined (or comma-separated) tables
+  const Node* from = nullptr;
+  auto query = FindNode(statement.tree, [&](const Node* node){
+    if(node->kind != NODE_KIND_QUERY || node->keyword != KEYWORD_DISTINCT){
+      return false;
+    }
+    from = FindChild(node, NODE_KIND_FROM);
+    return from != nullptr && from->child != nullptr &&
+        (from->child->next != nullptr || FindChild(from, NODE_KIND_JOIN) != nullptr);
+  });
+  if(query == nullptr){
+    return;
+  }
 
-  std::regex pattern("(distinct.*join)");
-  std::string title = "DISTINCT & JOIN Usage";
+  PatternId pattern_id = PATTERN_ID_DISTINCT_JOIN;
   PatternType pattern_type = PatternType::PATTERN_TYPE_QUERY;
 
   auto message =
@@ -1048,15 +1539,13 @@ void CheckDistinctJoin(Configuration& state,
       "SELECT c.country_id, c.country_name FROM SH.countries c WHERE  EXISTS "
       "(SELECT 'X' FROM  SH.customers e WHERE e.country_id = c.country_id);";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[query->first], tokens[from->last]),
+             true);
 
 }
 
@@ -1065,12 +1554,24 @@ void CheckDistinctJoin(Configuration& state,
 // APPLICATION
 
 void CheckReadablePasswords(Configuration& state,
-                            const std::string& sql_statement,
-                            bool& print_statement){
+                            const Statement& statement){
+
+  auto& sql_statement = statement.text;
+  auto& tokens = statement.tokens;
+
+  auto pos = FindToken(tokens, [&](const size_t itr){
+    return tokens[itr].kind == TOKEN_KIND_IDENTIFIER &&
+        (EndsWith(sql_statement, tokens[itr], "password") ||
+         EndsWith(sql_statement, tokens[itr], "pwd")) &&
+        (IsKeyword(tokens, itr + 1, KEYWORD_VARCHAR) ||
+         IsKeyword(tokens, itr + 1, KEYWORD_TEXT) ||
+         IsSymbol(sql_statement, tokens, itr + 1, "="));
+  });
+  if(pos == std::string::npos){
+    return;
+  }
 
-  std::regex pattern("(password varchar)|(password text)|(password =)| "
-      "(pwd varchar)|(pwd text)|(pwd =)");
-  std::string title = "Readable Passwords";
+  PatternId pattern_id = PATTERN_ID_READABLE_PASSWORDS;
   PatternType pattern_type = PatternType::PATTERN_TYPE_APPLICATION;
 
   auto message =
@@ -1088,16 +1589,144 @@ void CheckReadablePasswords(Configuration& state,
       "into the SQL query. Instead, compute the hash in your application code, "
       "and use only the hash in the SQL query.";
 
-  CheckPattern(state,
-               sql_statement,
-               print_statement,
-               pattern,
-               RISK_LEVEL_LOW,
-               pattern_type,
-               title,
-               message,
-               true);
+  AddFinding(state,
+             RISK_LEVEL_LOW,
+             pattern_type,
+             pattern_id,
+             message,
+             TokenText(sql_statement, tokens[pos], tokens[pos + 1]),
+             true);
+
+}
+
+// DISPATCH
+
+namespace {
+
+const unsigned QUERY_KINDS = 1u << STATEMENT_KIND_QUERY;
+const unsigned CREATE_TABLE_KINDS = 1u << STATEMENT_KIND_CREATE_TABLE;
+const unsigned DDL_KINDS = CREATE_TABLE_KINDS | (1u << STATEMENT_KIND_ALTER_TABLE);
+const unsigned INDEX_KINDS = 1u << STATEMENT_KIND_CREATE_INDEX;
+const unsigned ALL_KINDS = (1u << STATEMENT_KIND_COUNT) - 1;
+
+struct RuleEntry {
+
+  Rule rule;
+
+  // statement kinds the rule can match
+  unsigned kinds;
+
+};
+
+// Every rule in report order; the token rules run on all statements when
+// their patterns also occur in table definitions (NOT NULL, CHECK
+// constraints with OR, LIKE or ||, password and path columns), and only on
+// queries when they cannot (HAVING, DISTINCT)
+const RuleEntry RULE_ENTRIES[] = {
+
+  // LOGICAL DATABASE DESIGN
+  {CheckMultiValuedAttribute, ALL_KINDS},
+  {CheckRecursiveDependency, CREATE_TABLE_KINDS},
+  {CheckPrimaryKeyExists, CREATE_TABLE_KINDS},
+  {CheckGenericPrimaryKey, DDL_KINDS},
+  {CheckForeignKeyExists, CREATE_TABLE_KINDS},
+  {CheckVariableAttribute, CREATE_TABLE_KINDS},
+  {CheckMetadataTribbles, DDL_KINDS},
+
+  // PHYSICAL DATABASE DESIGN
+  {CheckFloat, ALL_KINDS},
+  {CheckValuesInDefinition, DDL_KINDS},
+  {CheckExternalFiles, ALL_KINDS},
+  {CheckIndexCount, DDL_KINDS | INDEX_KINDS},
+  {CheckIndexAttributeOrder, INDEX_KINDS},
+
+  // QUERY
+  {CheckSelectStar, QUERY_KINDS},
+  {CheckNullUsage, ALL_KINDS},
+  {CheckNotNullUsage, CREATE_TABLE_KINDS},
+  {CheckConcatenation, ALL_KINDS},
+  {CheckGroupByUsage, QUERY_KINDS},
+  {CheckOrderByRand, QUERY_KINDS},
+  {CheckPatternMatching, ALL_KINDS},
+  {CheckSpaghettiQuery, ALL_KINDS},
+  {CheckJoinCount, QUERY_KINDS},
+  {CheckDistinctCount, QUERY_KINDS},
+  {CheckImplicitColumns, QUERY_KINDS},
+  {CheckHaving, QUERY_KINDS},
+  {CheckNesting, QUERY_KINDS},
+  {CheckOr, ALL_KINDS},
+  {CheckUnion, QUERY_KINDS},
+  {CheckDistinctJoin, QUERY_KINDS},
+
+  // APPLICATION
+  {CheckReadablePasswords, ALL_KINDS}
+
+};
+
+std::vector<std::vector<Rule>> BuildRules(){
+  std::vector<std::vector<Rule>> rules(STATEMENT_KIND_COUNT);
+  for(unsigned kind = 0; kind < STATEMENT_KIND_COUNT; kind++){
+    for(auto& entry : RULE_ENTRIES){
+      if(kind == STATEMENT_KIND_OTHER || (entry.kinds & (1u << kind)) != 0){
+        rules[kind].push_back(entry.rule);
+      }
+    }
+  }
+  return rules;
+}
+
+const std::vector<std::vector<Rule>> RULES = BuildRules();
+
+// Rules whose findings depend on the values of literals, which the shape
+// of a query masks
+const std::vector<Rule> LITERAL_RULES = {
+  CheckFloat,
+  CheckSpaghettiQuery
+};
+
+bool IsQueryNode(const Node* node){
+  return node->kind == NODE_KIND_QUERY ||
+      node->kind == NODE_KIND_SET_OPERATION ||
+      node->kind == NODE_KIND_WITH;
+}
+
+}  // namespace
+
+StatementKind ClassifyStatement(const Statement& statement){
+
+  auto& tokens = statement.tokens;
+  auto tree = statement.tree;
+
+  // Several statements under a custom delimiter
+  if(tree->next != nullptr){
+    return STATEMENT_KIND_OTHER;
+  }
+
+  if(IsCreateStatement(tokens) || tree->kind == NODE_KIND_CREATE_TABLE){
+    for(auto child = tree->child; child != nullptr; child = child->next){
+      if(IsQueryNode(child)){
+        return STATEMENT_KIND_OTHER;
+      }
+    }
+    return STATEMENT_KIND_CREATE_TABLE;
+  }
+  if(IsDDLStatement(tokens)){
+    return STATEMENT_KIND_ALTER_TABLE;
+  }
+
+  auto pos = IsKeyword(tokens, 1, KEYWORD_UNIQUE) ? 2 : 1;
+  if(IsKeyword(tokens, 0, KEYWORD_CREATE) && IsKeyword(tokens, pos, KEYWORD_INDEX)){
+    return STATEMENT_KIND_CREATE_INDEX;
+  }
+  return STATEMENT_KIND_QUERY;
+}
+
+const std::vector<Rule>& GetRules(const StatementKind kind){
+  return RULES[kind];
+}
 
+const std::vector<Rule>& GetLiteralRules(){
+  return LITERAL_RULES;
 }
 
 }  // namespace machine
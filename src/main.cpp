@@ -2,9 +2,16 @@
 
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <stdexcept>
 
 #include "checker.h"
 #include "include/configuration.h"
+#include "include/migration.h"
+#include "include/diff.h"
+#include "include/compare.h"
+#include "include/budget.h"
+#include "include/watch.h"
 
 #include "gflags/gflags.h"
 
@@ -20,6 +27,7 @@ DEFINE_bool(v, false, "Display verbose warnings");
 DEFINE_bool(verbose, false, "Display verbose warnings");
 DEFINE_string(d, "", "Query delimiter string (default -- ;)");
 DEFINE_string(delimiter, "", "Query delimiter string (default -- ;)");
+DEFINE_string(dialect, "", "SQL dialect (generic, mysql, postgresql, sqlserver or sqlite)");
 DEFINE_bool(h, false, "Print help message");
 DEFINE_uint64(r, sqlcheck::RISK_LEVEL_ALL,
               "Set of anti-patterns to check \n"
@@ -33,20 +41,84 @@ DEFINE_uint64(risk_level, sqlcheck::RISK_LEVEL_ALL,
               "3 (only high risk anti-patterns) \n");
 DEFINE_string(f, "", "SQL file name"); // standard input
 DEFINE_string(file_name, "", "SQL file name"); // standard input
+DEFINE_string(m, "", "Migration directory (V<version>__<description>.sql)");
+DEFINE_string(migration_dir, "", "Migration directory (V<version>__<description>.sql)");
+DEFINE_string(cache_dir, ".sqlcheck-cache", "Cache directory");
+DEFINE_bool(cache, false, "Reuse the cached results of unchanged files");
+DEFINE_string(changed_since, "", "Check only the statements changed since a git revision");
+DEFINE_string(watch, "", "Re-check the SQL files in a directory whenever they change");
+DEFINE_string(checkpoint, "", "Periodically save the checker state to a file");
+DEFINE_uint64(checkpoint_interval, 60, "Seconds between checkpoints");
+DEFINE_bool(resume, false, "Resume from the checkpoint file");
+DEFINE_string(baseline, "", "Suppress the findings recorded in a baseline file");
+DEFINE_bool(write_baseline, false, "Record the findings as the new baseline file");
+DEFINE_string(metrics, "", "Write the complexity metrics of each statement to a file (NDJSON)");
+DEFINE_double(sample_rate, 1.0, "Check a random fraction of the statements");
+DEFINE_uint64(reservoir, 0, "Check a uniform random sample of N statements");
+DEFINE_string(fail_fast, "", "Stop at the first finding of at least a risk level "
+              "(high, medium, low or any) and exit with a failure");
+DEFINE_bool(progress, false, "Report progress on stderr");
+DEFINE_string(time_budget, "", "Check as much of the input as possible within a duration (30s)");
+DEFINE_bool(l, false, "Check a query log, weighting findings by query executions");
+DEFINE_bool(log_mode, false, "Check a query log, weighting findings by query executions");
+DEFINE_uint64(top_k, 0, "Track only the K heaviest query shapes with fixed memory (log mode)");
+DEFINE_bool(cluster, false, "Group near-duplicate query shapes into clusters (log mode)");
+DEFINE_bool(diff, false, "Compare two DDL files (--diff old.sql new.sql)");
+DEFINE_bool(compare, false, "Compare the findings of two query logs "
+            "(--compare before.log after.log)");
 
-void ConfigureChecker(sqlcheck::Configuration &state) {
+void ConfigureChecker(sqlcheck::Configuration &state,
+                      int argc,
+                      char **argv) {
 
   // Default Values
   state.risk_level = sqlcheck::RISK_LEVEL_ALL;
   state.file_name = "";
   state.delimiter = ";";
+  state.dialect = sqlcheck::DIALECT_GENERIC;
   state.testing_mode = false;
   state.verbose = false;
   state.color_mode = false;
+  state.migration_dir = "";
+  state.cache_dir = ".sqlcheck-cache";
+  state.result_cache = false;
+  state.changed_since = "";
+  state.watch_dir = "";
+  state.checkpoint_file = "";
+  state.checkpoint_interval = 60;
+  state.resume = false;
+  state.baseline_file = "";
+  state.write_baseline = false;
+  state.metrics_file = "";
+  state.sample_rate = 1.0;
+  state.reservoir_size = 0;
+  state.time_budget = 0;
+  state.fail_fast = false;
+  state.progress = false;
+  state.diff_old_file_name = "";
+  state.diff_new_file_name = "";
+  state.compare_before_file_name = "";
+  state.compare_after_file_name = "";
+  state.log_mode = false;
+  state.top_k = 0;
+  state.cluster_queries = false;
 
   // Configure checker
   state.color_mode = FLAGS_c || FLAGS_color_mode;
   state.verbose = FLAGS_v || FLAGS_verbose;
+  state.log_mode = FLAGS_l || FLAGS_log_mode;
+  if(FLAGS_top_k != 0){
+    state.log_mode = true;
+    state.top_k = FLAGS_top_k;
+  }
+  if(FLAGS_cluster == true){
+    if(FLAGS_top_k != 0){
+      throw std::invalid_argument("Clustering keeps every query shape and cannot "
+                                  "be combined with -top_k");
+    }
+    state.log_mode = true;
+    state.cluster_queries = true;
+  }
   if(FLAGS_f.empty() == false){
     state.file_name = FLAGS_f;
   }
@@ -54,11 +126,126 @@ void ConfigureChecker(sqlcheck::Configuration &state) {
     state.file_name = FLAGS_file_name;
   }
   if(FLAGS_d.empty() == false){
-    state.delimiter = FLAGS_f;
+    state.delimiter = FLAGS_d;
   }
   if(FLAGS_delimiter.empty() == false){
     state.delimiter = FLAGS_delimiter;
   }
+  if(FLAGS_dialect.empty() == false &&
+      sqlcheck::ParseDialect(FLAGS_dialect, state.dialect) == false){
+    throw std::invalid_argument("Invalid dialect: " + FLAGS_dialect +
+                                " (generic, mysql, postgresql, sqlserver or sqlite)");
+  }
+  if(FLAGS_m.empty() == false){
+    state.migration_dir = FLAGS_m;
+  }
+  if(FLAGS_migration_dir.empty() == false){
+    state.migration_dir = FLAGS_migration_dir;
+  }
+  if(FLAGS_cache_dir.empty() == false){
+    state.cache_dir = FLAGS_cache_dir;
+  }
+  state.result_cache = FLAGS_cache;
+  if(FLAGS_changed_since.empty() == false){
+    if(state.file_name.empty()){
+      throw std::invalid_argument("Checking changed statements requires a file: "
+                                  "sqlcheck -changed_since <rev> -f file.sql");
+    }
+    state.changed_since = FLAGS_changed_since;
+  }
+  if(FLAGS_watch.empty() == false){
+    state.watch_dir = FLAGS_watch;
+  }
+  if(FLAGS_checkpoint.empty() == false){
+    if(state.file_name.empty()){
+      throw std::invalid_argument("Checkpoints require a file: "
+                                  "sqlcheck --checkpoint state.ckpt -f queries.log");
+    }
+    state.checkpoint_file = FLAGS_checkpoint;
+    state.checkpoint_interval = FLAGS_checkpoint_interval;
+  }
+  if(FLAGS_resume == true){
+    if(state.checkpoint_file.empty()){
+      throw std::invalid_argument("Resuming requires a checkpoint file: "
+                                  "sqlcheck --resume --checkpoint state.ckpt -f queries.log");
+    }
+    state.resume = true;
+  }
+  if(FLAGS_sample_rate <= 0.0 || FLAGS_sample_rate > 1.0){
+    throw std::invalid_argument("Sample rate must be in (0, 1]");
+  }
+  if(FLAGS_sample_rate < 1.0 && FLAGS_reservoir != 0){
+    throw std::invalid_argument("Choose either a sample rate or a reservoir size");
+  }
+  state.sample_rate = FLAGS_sample_rate;
+  state.reservoir_size = FLAGS_reservoir;
+  if((state.sample_rate < 1.0 || state.reservoir_size != 0) &&
+      state.checkpoint_file.empty() == false){
+    throw std::invalid_argument("Sampled checks cannot be checkpointed");
+  }
+  if(FLAGS_fail_fast.empty() == false){
+    std::map<std::string, sqlcheck::RiskLevel> fail_fast_levels = {
+      {"high", sqlcheck::RISK_LEVEL_HIGH},
+      {"medium", sqlcheck::RISK_LEVEL_MEDIUM},
+      {"low", sqlcheck::RISK_LEVEL_LOW},
+      {"any", sqlcheck::RISK_LEVEL_NONE}
+    };
+    if(fail_fast_levels.count(FLAGS_fail_fast) == 0){
+      throw std::invalid_argument("Invalid fail-fast risk level: " + FLAGS_fail_fast +
+                                  " (high, medium, low or any)");
+    }
+    if(state.watch_dir.empty() == false){
+      throw std::invalid_argument("Watched directories cannot fail fast");
+    }
+    state.fail_fast = true;
+    state.fail_fast_level = fail_fast_levels[FLAGS_fail_fast];
+  }
+  state.progress = FLAGS_progress;
+  if(FLAGS_time_budget.empty() == false){
+    if(state.file_name.empty()){
+      throw std::invalid_argument("Time-budgeted checks require a file: "
+                                  "sqlcheck --time-budget 30s -f queries.log");
+    }
+    state.time_budget = sqlcheck::ParseDuration(FLAGS_time_budget);
+  }
+  if(FLAGS_write_baseline == true && FLAGS_baseline.empty()){
+    throw std::invalid_argument("Writing a baseline requires a file: "
+                                "sqlcheck --write-baseline --baseline accepted.bin");
+  }
+  if(FLAGS_baseline.empty() == false){
+    state.baseline_file = FLAGS_baseline;
+    state.write_baseline = FLAGS_write_baseline;
+    if(state.write_baseline == false){
+      state.baseline.Open(state.baseline_file);
+    }
+  }
+  if(FLAGS_metrics.empty() == false){
+    state.metrics_file = FLAGS_metrics;
+    // Metrics of a resumed check continue the file of the interrupted one
+    state.metrics.Open(state.metrics_file, state.resume);
+  }
+  if(FLAGS_diff == true){
+    if(argc != 3){
+      throw std::invalid_argument("Schema diff requires two DDL files: "
+                                  "sqlcheck --diff old.sql new.sql");
+    }
+    state.diff_old_file_name = argv[1];
+    state.diff_new_file_name = argv[2];
+  }
+  if(FLAGS_compare == true){
+    if(argc != 3){
+      throw std::invalid_argument("Comparison requires two query logs: "
+                                  "sqlcheck --compare before.log after.log");
+    }
+    state.compare_before_file_name = argv[1];
+    state.compare_after_file_name = argv[2];
+  }
+  if((state.sample_rate < 1.0 || state.reservoir_size != 0) &&
+      (state.migration_dir.empty() == false || state.diff_old_file_name.empty() == false ||
+       state.compare_before_file_name.empty() == false || state.watch_dir.empty() == false ||
+       state.changed_since.empty() == false || state.time_budget > 0)){
+    throw std::invalid_argument("Only whole files and the standard input can be sampled");
+  }
   if(FLAGS_r != 0){
     state.risk_level = (sqlcheck::RiskLevel) FLAGS_r;
   }
@@ -76,6 +263,23 @@ void ConfigureChecker(sqlcheck::Configuration &state) {
   ValidateColorMode(state);
   ValidateVerbose(state);
   ValidateDelimiter(state);
+  ValidateDialect(state);
+  ValidateMigrationDir(state);
+  ValidateResultCache(state);
+  ValidateChangedSince(state);
+  ValidateWatchDir(state);
+  ValidateCheckpoint(state);
+  ValidateBaseline(state);
+  ValidateMetrics(state);
+  ValidateDiff(state);
+  ValidateCompare(state);
+  ValidateSampling(state);
+  ValidateTimeBudget(state);
+  ValidateFailFast(state);
+  ValidateProgress(state);
+  ValidateLogMode(state);
+  ValidateTopK(state);
+  ValidateClusters(state);
 
   std::cout << "-------------------------------------------------\n";
 
@@ -92,6 +296,44 @@ void Usage() {
       "   -c -color_mode         :  Display warnings in color mode \n"
       "   -v -verbose            :  Display verbose warnings \n"
       "   -d -delimiter          :  Query delimiter string (; by default) \n"
+      "   -dialect <name>        :  Quoting, comments and batch separators of a \n"
+      "                          :  dialect (generic, mysql, postgresql, \n"
+      "                          :  sqlserver or sqlite) \n"
+      "   -l -log_mode           :  Check a query log: repeated queries are checked \n"
+      "                          :  once and findings are ranked by executions \n"
+      "   -top_k                 :  Track only the K heaviest query shapes with \n"
+      "                          :  fixed memory (implies log mode) \n"
+      "   -cluster               :  Report the findings per cluster of \n"
+      "                          :  near-duplicate queries (implies log mode) \n"
+      "   -m -migration_dir      :  Check versioned migrations (V1__init.sql, ...) \n"
+      "                          :  in version order \n"
+      "   -cache                 :  Reuse the cached results of unchanged files \n"
+      "   -cache_dir             :  Cache directory (.sqlcheck-cache by default) \n"
+      "   -changed_since <rev>   :  Check only the statements changed since a git \n"
+      "                          :  revision \n"
+      "   -watch <dir>           :  Re-check the changed statements of the SQL \n"
+      "                          :  files in a directory whenever they change \n"
+      "   -checkpoint <file>     :  Periodically save the checker state of a long \n"
+      "                          :  check (every -checkpoint_interval seconds) \n"
+      "   -resume                :  Resume from the checkpoint file \n"
+      "   -sample_rate <p>       :  Check a random fraction p of the statements \n"
+      "   -reservoir <n>         :  Check a uniform random sample of n statements \n"
+      "   -fail_fast <risk>      :  Stop at the first finding of at least the risk \n"
+      "                          :  level (high, medium, low or any) and exit with \n"
+      "                          :  a failure \n"
+      "   -progress              :  Report bytes, statements and findings per \n"
+      "                          :  second and the ETA on stderr \n"
+      "   -time_budget <30s>     :  Check as much of the input as possible within \n"
+      "                          :  the duration, spread evenly over the input \n"
+      "   -baseline <file>       :  Suppress the findings recorded in a baseline \n"
+      "   -write_baseline        :  Record the findings as the new baseline \n"
+      "   -metrics <file>        :  Write the complexity metrics of each statement \n"
+      "                          :  (joins, subquery depth, predicates, ...) as \n"
+      "                          :  one JSON object per line \n"
+      "   -diff old.sql new.sql  :  Check only the schema objects changed between \n"
+      "                          :  two DDL files \n"
+      "   -compare before after  :  Report the anti-patterns that are new, fixed or \n"
+      "                          :  changed in frequency between two query logs \n"
       "   -h -help               :  Print help message \n";
 }
 
@@ -115,10 +357,38 @@ int main(int argc, char **argv) {
     }
 
     // Customize the checker configuration
-    ConfigureChecker(sqlcheck::state);
+    ConfigureChecker(sqlcheck::state, argc, argv);
 
     // Invoke the checker
-    sqlcheck::Check(sqlcheck::state);
+    if(sqlcheck::state.migration_dir.empty() == false){
+      sqlcheck::CheckMigrations(sqlcheck::state);
+    }
+    else if(sqlcheck::state.diff_old_file_name.empty() == false){
+      sqlcheck::CheckDiff(sqlcheck::state);
+    }
+    else if(sqlcheck::state.compare_before_file_name.empty() == false){
+      sqlcheck::CheckCompare(sqlcheck::state);
+    }
+    else if(sqlcheck::state.watch_dir.empty() == false){
+      sqlcheck::WatchDirectory(sqlcheck::state);
+    }
+    else {
+      sqlcheck::Check(sqlcheck::state);
+    }
+
+    if(sqlcheck::state.write_baseline == true){
+      sqlcheck::Baseline::Write(sqlcheck::state.baseline_file,
+                                sqlcheck::state.baseline_keys);
+    }
+    if(sqlcheck::state.metrics.IsOpen()){
+      sqlcheck::state.metrics.Close();
+    }
+
+    // Fail the run if it stopped at a finding
+    if(sqlcheck::state.cancelled == true){
+      gflags::ShutDownCommandLineFlags();
+      return (EXIT_FAILURE);
+    }
 
   }
   // Catching at the top level ensures that
@@ -0,0 +1,172 @@
+// METRICS SOURCE
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "include/metrics.h"
+#include "include/hash.h"
+
+namespace sqlcheck {
+
+namespace {
+
+bool IsComparison(const Statement& statement,
+                  const Node* node){
+  auto& token = statement.tokens[node->token];
+  if(token.kind != TOKEN_KIND_OPERATOR){
+    return false;
+  }
+  auto c = statement.text[token.offset];
+  return (c == '=' || c == '<' || c == '>' ||
+          (c == '!' && token.length == 2 && statement.text[token.offset + 1] == '='));
+}
+
+size_t CountChildren(const Node* node){
+  size_t count = 0;
+  for(auto child = node->child; child != nullptr; child = child->next){
+    count++;
+  }
+  return count;
+}
+
+const char* BoolToString(const bool value){
+  return value ? "true" : "false";
+}
+
+}  // namespace
+
+void ClearMetrics(StatementMetrics& metrics,
+                  const size_t length){
+  metrics = StatementMetrics();
+  metrics.length = length;
+}
+
+void AddMetrics(const Statement& statement,
+                StatementMetrics& metrics){
+
+  VisitNodes(statement.tree, [&](const Node* node){
+    switch(node->kind){
+      case NODE_KIND_TABLE:
+        metrics.tables++;
+        break;
+      case NODE_KIND_JOIN:
+        metrics.joins++;
+        break;
+      case NODE_KIND_FROM:
+        metrics.joins += (node->child != nullptr) ? CountChildren(node) - 1 : 0;
+        break;
+      case NODE_KIND_GROUP_BY:
+        metrics.group_by = true;
+        break;
+      case NODE_KIND_ORDER_BY:
+        metrics.order_by = true;
+        break;
+      case NODE_KIND_UNARY:
+        metrics.predicates += (node->keyword == KEYWORD_EXISTS);
+        break;
+      case NODE_KIND_BINARY:
+        if(node->keyword == KEYWORD_OR){
+          metrics.ors++;
+        }
+        else if(node->keyword == KEYWORD_IN){
+          metrics.predicates++;
+          auto list = (node->child != nullptr) ? node->child->next : nullptr;
+          if(list != nullptr && list->kind == NODE_KIND_LIST){
+            metrics.in_list = std::max(metrics.in_list, CountChildren(list));
+          }
+        }
+        else if(node->keyword != KEYWORD_AND &&
+            (node->keyword != KEYWORD_NONE || IsComparison(statement, node))){
+          metrics.predicates++;
+        }
+        break;
+      default:
+        break;
+    }
+  });
+
+  for(auto& token : statement.tokens){
+    metrics.distinct |= (token.keyword == KEYWORD_DISTINCT);
+  }
+
+  SubqueryInfo subqueries;
+  AnalyzeSubqueries(statement.text, statement.tokens, statement.tree, subqueries);
+  metrics.subquery_depth = std::max(metrics.subquery_depth, subqueries.max_depth);
+  metrics.correlated_subqueries += subqueries.correlated.size();
+
+}
+
+MetricsWriter::MetricsWriter()
+ : statements_(0){
+}
+
+void MetricsWriter::Open(const std::string& file_name,
+                         const bool append){
+
+  file_name_ = file_name;
+  output_.open(file_name.c_str(), append ? std::ios::app : std::ios::trunc);
+  if(output_.is_open() == false){
+    throw std::runtime_error("Could not write the metrics file: " + file_name);
+  }
+}
+
+void MetricsWriter::Flush(){
+  output_.flush();
+}
+
+unsigned long long MetricsWriter::Size() const {
+  struct stat file_stat;
+  if(stat(file_name_.c_str(), &file_stat) != 0){
+    return 0;
+  }
+  return file_stat.st_size;
+}
+
+void MetricsWriter::Restore(const unsigned long long statements,
+                            const unsigned long long size){
+
+  output_.flush();
+  if(Size() < size){
+    throw std::runtime_error("Metrics file is shorter than the checkpoint: " + file_name_);
+  }
+
+  output_.close();
+  if(truncate(file_name_.c_str(), size) != 0){
+    throw std::runtime_error("Could not truncate the metrics file: " + file_name_);
+  }
+  Open(file_name_, true);
+  statements_ = statements;
+}
+
+void MetricsWriter::Write(const uint64_t fingerprint,
+                          const StatementMetrics& metrics){
+
+  statements_++;
+  output_ << "{\"statement\":" << statements_
+      << ",\"fingerprint\":\"" << HashToString(fingerprint) << "\""
+      << ",\"length\":" << metrics.length
+      << ",\"tables\":" << metrics.tables
+      << ",\"joins\":" << metrics.joins
+      << ",\"subquery_depth\":" << metrics.subquery_depth
+      << ",\"correlated_subqueries\":" << metrics.correlated_subqueries
+      << ",\"predicates\":" << metrics.predicates
+      << ",\"ors\":" << metrics.ors
+      << ",\"in_list\":" << metrics.in_list
+      << ",\"distinct\":" << BoolToString(metrics.distinct)
+      << ",\"group_by\":" << BoolToString(metrics.group_by)
+      << ",\"order_by\":" << BoolToString(metrics.order_by)
+      << "}\n";
+}
+
+void MetricsWriter::Close(){
+
+  output_.close();
+  if(output_.fail()){
+    throw std::runtime_error("Could not write the metrics file");
+  }
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,209 @@
+// MIGRATION SOURCE
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <cctype>
+#include <cstdio>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "include/migration.h"
+#include "include/checker.h"
+#include "include/hash.h"
+#include "include/splitter.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Parse the version of a migration file name; returns false for files
+// that are not versioned migrations
+bool ParseVersion(const std::string& file_name,
+                  std::vector<unsigned long long>& version){
+
+  auto separator = file_name.find("__");
+  if(file_name.size() < 2 || (file_name[0] != 'V' && file_name[0] != 'v') ||
+      separator == std::string::npos || separator < 2){
+    return false;
+  }
+
+  auto suffix = std::string(".sql");
+  if(file_name.size() < suffix.size() ||
+      file_name.compare(file_name.size() - suffix.size(), suffix.size(), suffix) != 0){
+    return false;
+  }
+
+  // Version parts are separated by dots or single underscores (V1_2 == V1.2)
+  version.clear();
+  unsigned long long part = 0;
+  bool digits = false;
+  for(size_t pos = 1; pos < separator; pos++){
+    char c = file_name[pos];
+    if(std::isdigit(static_cast<unsigned char>(c))){
+      part = part * 10 + (c - '0');
+      digits = true;
+    }
+    else if((c == '.' || c == '_') && digits){
+      version.push_back(part);
+      part = 0;
+      digits = false;
+    }
+    else {
+      return false;
+    }
+  }
+  if(digits == false){
+    return false;
+  }
+  version.push_back(part);
+
+  return true;
+}
+
+bool ReadFile(const std::string& file_name, std::string& contents){
+  std::ifstream input(file_name.c_str(), std::ios::binary);
+  if(!input){
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << input.rdbuf();
+  contents = buffer.str();
+  return true;
+}
+
+std::string CatalogCachePath(const Configuration& state, const uint64_t hash){
+  return state.cache_dir + "/catalog-" + HashToString(hash);
+}
+
+bool LoadCatalog(const std::string& path, Catalog& catalog){
+  std::ifstream input(path.c_str());
+  if(!input){
+    return false;
+  }
+  return catalog.Load(input);
+}
+
+void SaveCatalog(const std::string& cache_dir,
+                 const std::string& path,
+                 const Catalog& catalog){
+  mkdir(cache_dir.c_str(), 0755);
+
+  // Write to a temporary file first so that an interrupted run never
+  // leaves behind a truncated catalog
+  auto temporary_path = path + ".tmp";
+  {
+    std::ofstream output(temporary_path.c_str());
+    if(!output){
+      std::cerr << "Could not write catalog cache: " << temporary_path << "\n";
+      return;
+    }
+    catalog.Save(output);
+  }
+  std::rename(temporary_path.c_str(), path.c_str());
+}
+
+}  // namespace
+
+std::vector<Migration> ListMigrations(const std::string& directory){
+
+  DIR* handle = opendir(directory.c_str());
+  if(handle == nullptr){
+    throw std::runtime_error("Could not open migration directory: " + directory);
+  }
+
+  std::vector<Migration> migrations;
+  struct dirent* entry;
+  while((entry = readdir(handle)) != nullptr){
+    Migration migration;
+    if(ParseVersion(entry->d_name, migration.version)){
+      migration.file_name = directory + "/" + entry->d_name;
+      migrations.push_back(migration);
+    }
+  }
+  closedir(handle);
+
+  std::sort(migrations.begin(), migrations.end(),
+            [](const Migration& left, const Migration& right){
+              return left.version < right.version;
+            });
+
+  for(size_t itr = 1; itr < migrations.size(); itr++){
+    if(migrations[itr].version == migrations[itr - 1].version){
+      throw std::runtime_error("Duplicate migration version: " +
+                               migrations[itr - 1].file_name + " and " +
+                               migrations[itr].file_name);
+    }
+  }
+
+  return migrations;
+}
+
+size_t CheckMigrations(Configuration& state){
+
+  auto migrations = ListMigrations(state.migration_dir);
+
+  // The catalog state after a migration is keyed by the hash chain over
+  // the contents of that migration and all of its predecessors
+  std::vector<uint64_t> hashes;
+  uint64_t hash = HashString(CATALOG_VERSION);
+  for(auto& migration : migrations){
+    std::string contents;
+    if(ReadFile(migration.file_name, contents) == false){
+      throw std::runtime_error("Could not read migration: " + migration.file_name);
+    }
+    hash = HashString(contents, hash);
+    hashes.push_back(hash);
+  }
+
+  // Resume from the longest prefix with a cached catalog
+  size_t first_unchecked = 0;
+  for(size_t itr = migrations.size(); itr > 0; itr--){
+    Catalog catalog;
+    if(LoadCatalog(CatalogCachePath(state, hashes[itr - 1]), catalog)){
+      state.catalog = catalog;
+      first_unchecked = itr;
+      break;
+    }
+  }
+
+  printf("> %s :: %lu (%lu cached)\n", "MIGRATIONS   ",
+         (unsigned long) migrations.size(),
+         (unsigned long) first_unchecked);
+
+  std::cout << "==================== Results ===================\n";
+
+  auto file_name = state.file_name;
+  for(size_t itr = first_unchecked; itr < migrations.size(); itr++){
+    std::ifstream input(migrations[itr].file_name.c_str());
+    state.file_name = migrations[itr].file_name;
+
+    // Only migrations keep the schema catalog, which is cached after each
+    // of them; each statement is checked against the schema left by the
+    // statements before it
+    StatementSplitter splitter(state, input);
+    std::string sql_statement;
+    while(splitter.Next(sql_statement)){
+      CheckStatement(state, sql_statement);
+      state.catalog.ApplyStatement(state.statement);
+    }
+    if(state.cancelled == true){
+      break;
+    }
+
+    SaveCatalog(state.cache_dir,
+                CatalogCachePath(state, hashes[itr]),
+                state.catalog);
+  }
+  state.file_name = file_name;
+
+  PrintSummary(state);
+
+  return migrations.size() - first_unchecked;
+}
+
+}  // namespace sqlcheck
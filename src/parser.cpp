@@ -0,0 +1,1682 @@
+// PARSER SOURCE
+
+#include <algorithm>
+#include <cstring>
+
+#include "include/parser.h"
+
+namespace sqlcheck {
+
+// ARENA
+
+Arena::Arena(const size_t block_size)
+ : block_size_(block_size),
+   block_(0),
+   offset_(0){
+}
+
+void* Arena::Allocate(const size_t size, const size_t alignment){
+
+  auto offset = (offset_ + alignment - 1) & ~(alignment - 1);
+  if(blocks_.empty() || offset + size > block_size_){
+    if(blocks_.empty() == false){
+      block_++;
+    }
+    if(block_ == blocks_.size()){
+      blocks_.emplace_back(new char[block_size_]);
+    }
+    offset = 0;
+  }
+
+  offset_ = offset + size;
+  return blocks_[block_].get() + offset;
+}
+
+void Arena::Reset(){
+  block_ = 0;
+  offset_ = 0;
+}
+
+// PARSER
+
+namespace {
+
+// Nesting beyond this depth is skipped instead of parsed
+const size_t PARSER_MAX_DEPTH = 256;
+
+// Aggregation of the children of a node
+class ChildList {
+
+ public:
+
+  explicit ChildList(Node* parent)
+ : tail_(&parent->child){
+  }
+
+  void Add(Node* child){
+    if(child == nullptr){
+      return;
+    }
+    *tail_ = child;
+    tail_ = &child->next;
+  }
+
+ private:
+
+  Node** tail_;
+
+};
+
+// Recursive-descent parser over the tokens of a statement
+class Parser {
+
+ public:
+
+  Parser(const std::string& sql_statement,
+         const std::vector<Token>& tokens,
+         Arena& arena)
+ : sql_statement_(sql_statement),
+   tokens_(tokens),
+   arena_(arena),
+   pos_(0),
+   depth_(0){
+  }
+
+  Node* ParseStatements(){
+
+    Node root;
+    root.child = nullptr;
+    ChildList statements(&root);
+
+    while(AtEnd() == false){
+      if(AcceptSymbol(";")){
+        continue;
+      }
+      statements.Add(ParseStatement());
+    }
+
+    if(root.child == nullptr){
+      return NewNode(NODE_KIND_OTHER);
+    }
+    return root.child;
+  }
+
+ private:
+
+  // TOKENS
+
+  bool AtEnd() const {
+    return pos_ >= tokens_.size();
+  }
+
+  bool IsKeyword(const KeywordId keyword, const size_t offset = 0) const {
+    return pos_ + offset < tokens_.size() && tokens_[pos_ + offset].keyword == keyword;
+  }
+
+  bool IsText(const char* text, const size_t offset) const {
+    auto& token = tokens_[pos_ + offset];
+    auto data = sql_statement_.data() + token.offset;
+    return data[0] == text[0] && token.length == strlen(text) &&
+        memcmp(data, text, token.length) == 0;
+  }
+
+  bool IsSymbol(const char* symbol, const size_t offset = 0) const {
+    if(pos_ + offset >= tokens_.size()){
+      return false;
+    }
+    auto kind = tokens_[pos_ + offset].kind;
+    return (kind == TOKEN_KIND_OPERATOR || kind == TOKEN_KIND_PUNCTUATION) &&
+        IsText(symbol, offset);
+  }
+
+  // Non-reserved word (not in the keyword table)
+  bool IsWord(const char* word, const size_t offset = 0) const {
+    return pos_ + offset < tokens_.size() &&
+        tokens_[pos_ + offset].kind == TOKEN_KIND_IDENTIFIER &&
+        IsText(word, offset);
+  }
+
+  bool IsName(const size_t offset = 0) const {
+    if(pos_ + offset >= tokens_.size()){
+      return false;
+    }
+    auto kind = tokens_[pos_ + offset].kind;
+    return kind == TOKEN_KIND_IDENTIFIER || kind == TOKEN_KIND_QUOTED_IDENTIFIER;
+  }
+
+  bool IsQueryStart(const size_t offset = 0) const {
+    return IsKeyword(KEYWORD_SELECT, offset) || IsKeyword(KEYWORD_WITH, offset);
+  }
+
+  bool Accept(const KeywordId keyword){
+    if(IsKeyword(keyword)){
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool AcceptSymbol(const char* symbol){
+    if(IsSymbol(symbol)){
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool AcceptWord(const char* word){
+    if(IsWord(word)){
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool IsComparison() const {
+    if(AtEnd() || tokens_[pos_].kind != TOKEN_KIND_OPERATOR){
+      return false;
+    }
+    static const char* comparisons[] = {
+      "=", "<>", "!=", "<", ">", "<=", ">=", "<=>", "=="
+    };
+    for(auto comparison : comparisons){
+      if(IsSymbol(comparison)){
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Keywords that end an expression
+  bool IsExpressionEnd() const {
+    if(AtEnd() || IsSymbol(")") || IsSymbol(",") || IsSymbol(";")){
+      return true;
+    }
+    switch(tokens_[pos_].keyword){
+      case KEYWORD_FROM:
+      case KEYWORD_WHERE:
+      case KEYWORD_GROUP:
+      case KEYWORD_HAVING:
+      case KEYWORD_ORDER:
+      case KEYWORD_LIMIT:
+      case KEYWORD_OFFSET:
+      case KEYWORD_UNION:
+      case KEYWORD_INTERSECT:
+      case KEYWORD_EXCEPT:
+      case KEYWORD_ON:
+      case KEYWORD_USING:
+      case KEYWORD_AND:
+      case KEYWORD_OR:
+      case KEYWORD_WHEN:
+      case KEYWORD_THEN:
+      case KEYWORD_ELSE:
+      case KEYWORD_END:
+      case KEYWORD_AS:
+      case KEYWORD_JOIN:
+      case KEYWORD_INNER:
+      case KEYWORD_CROSS:
+      case KEYWORD_FULL:
+      case KEYWORD_OUTER:
+      case KEYWORD_SET:
+      case KEYWORD_INTO:
+      case KEYWORD_ASC:
+      case KEYWORD_DESC:
+      case KEYWORD_BY:
+      case KEYWORD_IS:
+      case KEYWORD_IN:
+      case KEYWORD_LIKE:
+      case KEYWORD_BETWEEN:
+      case KEYWORD_REGEXP:
+      case KEYWORD_SIMILAR:
+      case KEYWORD_TO:
+        return true;
+      case KEYWORD_LEFT:
+      case KEYWORD_RIGHT:
+        return IsSymbol("(", 1) == false;
+      default:
+        return false;
+    }
+  }
+
+  // Keywords that start a clause of a query
+  bool IsClauseStart() const {
+    return IsKeyword(KEYWORD_FROM) || IsKeyword(KEYWORD_WHERE) ||
+        IsKeyword(KEYWORD_GROUP) || IsKeyword(KEYWORD_HAVING) ||
+        IsKeyword(KEYWORD_ORDER) || IsKeyword(KEYWORD_LIMIT) ||
+        IsKeyword(KEYWORD_OFFSET) || IsSetOperation();
+  }
+
+  bool IsSetOperation() const {
+    return IsKeyword(KEYWORD_UNION) || IsKeyword(KEYWORD_INTERSECT) ||
+        IsKeyword(KEYWORD_EXCEPT) || IsWord("minus");
+  }
+
+  bool IsJoinStart() const {
+    if(IsKeyword(KEYWORD_JOIN) || IsWord("straight_join")){
+      return true;
+    }
+    if(IsKeyword(KEYWORD_INNER) || IsKeyword(KEYWORD_CROSS) ||
+        IsKeyword(KEYWORD_LEFT) || IsKeyword(KEYWORD_RIGHT) ||
+        IsKeyword(KEYWORD_FULL) || IsWord("natural")){
+      return IsSymbol("(", 1) == false;
+    }
+    return false;
+  }
+
+  // Words that may follow a table or expression without being an alias
+  bool IsAliasCandidate() const {
+    if(IsName() == false){
+      return false;
+    }
+    static const char* words[] = {
+      "natural", "straight_join", "connect", "start", "window", "fetch",
+      "qualify", "returning", "for", "lateral", "minus", "escape", "collate",
+      "over", "filter", "within"
+    };
+    for(auto word : words){
+      if(IsWord(word)){
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Skip a token, or a parenthesized group as a whole
+  void SkipBalanced(){
+    if(AtEnd()){
+      return;
+    }
+    size_t depth = 0;
+    do {
+      if(IsSymbol("(")){
+        depth++;
+      }
+      else if(IsSymbol(")")){
+        if(depth == 0){
+          return;
+        }
+        depth--;
+      }
+      pos_++;
+    } while(depth != 0 && AtEnd() == false);
+  }
+
+  // Skip to the next comma or closing parenthesis at this level
+  void SkipToSeparator(){
+    while(AtEnd() == false && IsSymbol(",") == false && IsSymbol(")") == false &&
+        IsSymbol(";") == false){
+      SkipBalanced();
+    }
+  }
+
+  void SkipToStatementEnd(){
+    while(AtEnd() == false && IsSymbol(";") == false){
+      if(IsSymbol(")")){
+        pos_++;
+        continue;
+      }
+      SkipBalanced();
+    }
+  }
+
+  // NODES
+
+  Node* NewNode(const NodeKind kind){
+    auto node = arena_.New<Node>();
+    node->kind = kind;
+    node->keyword = KEYWORD_NONE;
+    node->first = static_cast<uint32_t>(std::min(pos_, LastToken()));
+    node->last = node->first;
+    node->token = node->first;
+    node->child = nullptr;
+    node->next = nullptr;
+    return node;
+  }
+
+  Node* NewNode(const NodeKind kind, const Node* first){
+    auto node = NewNode(kind);
+    if(first != nullptr){
+      node->first = first->first;
+    }
+    return node;
+  }
+
+  size_t LastToken() const {
+    return tokens_.empty() ? 0 : tokens_.size() - 1;
+  }
+
+  // Extend a node up to the last consumed token
+  Node* Finish(Node* node){
+    if(pos_ > node->first){
+      node->last = static_cast<uint32_t>(std::min(pos_ - 1, LastToken()));
+    }
+    return node;
+  }
+
+  Node* Leaf(const NodeKind kind){
+    auto node = NewNode(kind);
+    pos_++;
+    return Finish(node);
+  }
+
+  Node* Binary(Node* left, const size_t op, Node* right, const KeywordId keyword){
+    auto node = NewNode(NODE_KIND_BINARY, left);
+    if(left == nullptr){
+      node->first = static_cast<uint32_t>(op);
+    }
+    node->token = static_cast<uint32_t>(op);
+    node->keyword = keyword;
+    ChildList children(node);
+    children.Add(left);
+    children.Add(right);
+    return Finish(node);
+  }
+
+  // STATEMENTS
+
+  Node* ParseStatement(){
+
+    Node* node = nullptr;
+
+    if(IsKeyword(KEYWORD_SELECT) || IsSymbol("(") || IsKeyword(KEYWORD_VALUES)){
+      node = ParseQueryExpression();
+    }
+    else if(IsKeyword(KEYWORD_WITH)){
+      node = ParseWith();
+    }
+    else if(IsKeyword(KEYWORD_INSERT) || IsWord("replace")){
+      node = ParseInsert();
+    }
+    else if(IsKeyword(KEYWORD_UPDATE)){
+      node = ParseUpdate();
+    }
+    else if(IsKeyword(KEYWORD_DELETE)){
+      node = ParseDelete();
+    }
+    else if(IsKeyword(KEYWORD_CREATE)){
+      node = ParseCreate();
+    }
+    else if(IsKeyword(KEYWORD_ALTER) && IsKeyword(KEYWORD_TABLE, 1)){
+      node = ParseAlterTable();
+    }
+    else if(IsKeyword(KEYWORD_DROP)){
+      node = NewNode(NODE_KIND_DROP);
+    }
+
+    if(node == nullptr){
+      node = NewNode(NODE_KIND_OTHER);
+    }
+
+    SkipToStatementEnd();
+    return Finish(node);
+  }
+
+  Node* ParseWith(){
+
+    auto node = NewNode(NODE_KIND_WITH);
+    ChildList children(node);
+    Accept(KEYWORD_WITH);
+    AcceptWord("recursive");
+
+    do {
+      if(IsName() == false){
+        break;
+      }
+      auto cte = NewNode(NODE_KIND_CTE);
+      pos_++;
+      if(IsSymbol("(")){
+        cte->child = ParseNameList();
+      }
+      Accept(KEYWORD_AS);
+      Accept(KEYWORD_NOT);
+      AcceptWord("materialized");
+      if(AcceptSymbol("(")){
+        ChildList body(cte);
+        body.Add(ParseStatementBody());
+        SkipToSeparator();
+        AcceptSymbol(")");
+      }
+      children.Add(Finish(cte));
+    } while(AcceptSymbol(","));
+
+    children.Add(ParseStatementBody());
+    return Finish(node);
+  }
+
+  // Statement that may follow a WITH clause
+  Node* ParseStatementBody(){
+    if(IsKeyword(KEYWORD_INSERT)){
+      return ParseInsert();
+    }
+    if(IsKeyword(KEYWORD_UPDATE)){
+      return ParseUpdate();
+    }
+    if(IsKeyword(KEYWORD_DELETE)){
+      return ParseDelete();
+    }
+    return ParseQueryExpression();
+  }
+
+  Node* ParseQueryExpression(){
+
+    if(depth_ >= PARSER_MAX_DEPTH){
+      auto node = NewNode(NODE_KIND_OTHER);
+      SkipToSeparator();
+      return Finish(node);
+    }
+    depth_++;
+
+    auto left = ParseQueryTerm();
+    while(IsSetOperation()){
+      auto node = NewNode(NODE_KIND_SET_OPERATION, left);
+      node->token = static_cast<uint32_t>(pos_);
+      node->keyword = tokens_[pos_].keyword;
+      pos_++;
+      if(Accept(KEYWORD_ALL) == false){
+        Accept(KEYWORD_DISTINCT);
+      }
+      ChildList children(node);
+      children.Add(left);
+      children.Add(ParseQueryTerm());
+      left = Finish(node);
+    }
+
+    depth_--;
+    return left;
+  }
+
+  Node* ParseQueryTerm(){
+
+    if(IsSymbol("(") &&
+        (IsQueryStart(1) || IsSymbol("(", 1) || IsKeyword(KEYWORD_VALUES, 1))){
+      pos_++;
+      auto node = ParseQueryExpression();
+      SkipToSeparator();
+      AcceptSymbol(")");
+      return node;
+    }
+    if(IsKeyword(KEYWORD_SELECT)){
+      return ParseQuery();
+    }
+    if(IsKeyword(KEYWORD_WITH)){
+      return ParseWith();
+    }
+    if(IsKeyword(KEYWORD_VALUES)){
+      return ParseValues();
+    }
+    return nullptr;
+  }
+
+  Node* ParseQuery(){
+
+    auto node = NewNode(NODE_KIND_QUERY);
+    ChildList children(node);
+    Accept(KEYWORD_SELECT);
+
+    if(Accept(KEYWORD_DISTINCT)){
+      node->keyword = KEYWORD_DISTINCT;
+    }
+    else {
+      Accept(KEYWORD_ALL);
+    }
+    if(AcceptWord("top")){
+      ParseUnary();
+    }
+
+    auto select_list = NewNode(NODE_KIND_SELECT_LIST);
+    ChildList items(select_list);
+    do {
+      items.Add(ParseAliased(ParseExpression()));
+    } while(AcceptSymbol(","));
+    children.Add(Finish(select_list));
+
+    ParseClauses(children);
+    return Finish(node);
+  }
+
+  // Clauses following the select list (or the target of UPDATE and DELETE)
+  void ParseClauses(ChildList& children){
+
+    while(AtEnd() == false && IsSymbol(")") == false && IsSymbol(";") == false &&
+        IsSetOperation() == false){
+
+      if(IsKeyword(KEYWORD_FROM)){
+        children.Add(ParseFrom());
+      }
+      else if(IsKeyword(KEYWORD_WHERE)){
+        auto node = NewNode(NODE_KIND_WHERE);
+        pos_++;
+        node->child = ParseExpression();
+        children.Add(Finish(node));
+      }
+      else if(IsKeyword(KEYWORD_GROUP) && IsKeyword(KEYWORD_BY, 1)){
+        children.Add(ParseExpressionList(NODE_KIND_GROUP_BY, 2));
+      }
+      else if(IsKeyword(KEYWORD_HAVING)){
+        auto node = NewNode(NODE_KIND_HAVING);
+        pos_++;
+        node->child = ParseExpression();
+        children.Add(Finish(node));
+      }
+      else if(IsKeyword(KEYWORD_ORDER) && IsKeyword(KEYWORD_BY, 1)){
+        children.Add(ParseExpressionList(NODE_KIND_ORDER_BY, 2));
+      }
+      else if(IsKeyword(KEYWORD_LIMIT) || IsKeyword(KEYWORD_OFFSET)){
+        children.Add(ParseExpressionList(NODE_KIND_LIMIT, 1));
+      }
+      else {
+        // Unsupported clause
+        do {
+          SkipBalanced();
+        } while(AtEnd() == false && IsClauseStart() == false &&
+                IsSymbol(")") == false && IsSymbol(";") == false);
+      }
+    }
+  }
+
+  // Comma-separated expressions after a clause keyword (with ASC/DESC)
+  Node* ParseExpressionList(const NodeKind kind, const size_t keywords){
+
+    auto node = NewNode(kind);
+    pos_ += keywords;
+    ChildList items(node);
+    do {
+      items.Add(ParseExpression());
+      if(Accept(KEYWORD_ASC) == false){
+        Accept(KEYWORD_DESC);
+      }
+      if(AcceptWord("nulls")){
+        pos_++;
+      }
+    } while(AcceptSymbol(",") || Accept(KEYWORD_OFFSET));
+    return Finish(node);
+  }
+
+  Node* ParseValues(){
+
+    auto node = NewNode(NODE_KIND_VALUES);
+    pos_++;
+    ChildList rows(node);
+    do {
+      if(AcceptWord("row") == false && IsSymbol("(") == false){
+        break;
+      }
+      rows.Add(ParsePrimary());
+    } while(AcceptSymbol(","));
+    return Finish(node);
+  }
+
+  Node* ParseAliased(Node* expression){
+
+    if(expression == nullptr){
+      return nullptr;
+    }
+    auto has_as = IsKeyword(KEYWORD_AS);
+    auto offset = has_as ? 1 : 0;
+    auto kind = (pos_ + offset < tokens_.size()) ? tokens_[pos_ + offset].kind : TOKEN_KIND_INVALID;
+    if(has_as == false && IsAliasCandidate() == false){
+      return expression;
+    }
+    if(has_as && kind != TOKEN_KIND_IDENTIFIER && kind != TOKEN_KIND_QUOTED_IDENTIFIER &&
+        kind != TOKEN_KIND_STRING && kind != TOKEN_KIND_KEYWORD){
+      return expression;
+    }
+
+    auto node = NewNode(NODE_KIND_ALIAS, expression);
+    pos_ += offset;
+    node->token = static_cast<uint32_t>(pos_);
+    pos_++;
+    node->child = expression;
+    return Finish(node);
+  }
+
+  Node* ParseNameList(){
+
+    auto node = NewNode(NODE_KIND_COLUMN_LIST);
+    ChildList names(node);
+    AcceptSymbol("(");
+    while(AtEnd() == false && IsSymbol(")") == false && IsSymbol(";") == false){
+      if(IsSymbol(",")){
+        pos_++;
+        continue;
+      }
+      auto start = pos_;
+      names.Add(ParseExpression());
+      if(pos_ == start){
+        SkipBalanced();
+      }
+      SkipToSeparator();
+    }
+    AcceptSymbol(")");
+    return Finish(node);
+  }
+
+  // TABLES
+
+  Node* ParseFrom(){
+
+    auto node = NewNode(NODE_KIND_FROM);
+    pos_++;
+    ParseTableReferences(node);
+    return Finish(node);
+  }
+
+  void ParseTableReferences(Node* node){
+    ChildList tables(node);
+    do {
+      tables.Add(ParseJoinedTable());
+    } while(AcceptSymbol(","));
+  }
+
+  Node* ParseJoinedTable(){
+
+    auto left = ParseTablePrimary();
+    while(IsJoinStart()){
+      auto node = NewNode(NODE_KIND_JOIN, left);
+      if(left == nullptr){
+        node->first = static_cast<uint32_t>(pos_);
+      }
+      AcceptWord("natural");
+      node->keyword = IsKeyword(KEYWORD_JOIN) ? KEYWORD_JOIN : tokens_[pos_].keyword;
+      while(AtEnd() == false && IsKeyword(KEYWORD_JOIN) == false &&
+          IsWord("straight_join") == false){
+        pos_++;
+      }
+      node->token = static_cast<uint32_t>(std::min(pos_, LastToken()));
+      pos_++;
+
+      ChildList children(node);
+      children.Add(left);
+      children.Add(ParseTablePrimary());
+      if(Accept(KEYWORD_ON)){
+        children.Add(ParseExpression());
+      }
+      else if(Accept(KEYWORD_USING)){
+        children.Add(ParseNameList());
+      }
+      left = Finish(node);
+    }
+    return left;
+  }
+
+  Node* ParseTablePrimary(){
+
+    AcceptWord("lateral");
+    AcceptWord("only");
+
+    Node* node = nullptr;
+    if(IsSymbol("(")){
+      if(IsQueryStart(1) || IsKeyword(KEYWORD_VALUES, 1) ||
+          (IsSymbol("(", 1) && (IsQueryStart(2) || IsSymbol("(", 2)))){
+        node = NewNode(NODE_KIND_DERIVED_TABLE);
+        node->child = ParseQueryTerm();
+        Finish(node);
+      }
+      else {
+        if(depth_ >= PARSER_MAX_DEPTH){
+          SkipBalanced();
+          return nullptr;
+        }
+        depth_++;
+        pos_++;
+        node = ParseJoinedTable();
+        SkipToSeparator();
+        AcceptSymbol(")");
+        depth_--;
+        return node;
+      }
+    }
+    else if(IsName()){
+      node = NewNode(NODE_KIND_TABLE);
+      ParseQualifiedName(node);
+      if(IsSymbol("(")){
+        SkipBalanced();
+      }
+      Finish(node);
+    }
+    else {
+      return nullptr;
+    }
+
+    node = ParseAliased(node);
+    if(IsSymbol("(") && node->kind == NODE_KIND_ALIAS){
+      SkipBalanced();
+    }
+
+    // Table hints
+    while(((AcceptWord("use") || AcceptWord("force") || AcceptWord("ignore")) &&
+           (Accept(KEYWORD_INDEX) || Accept(KEYWORD_KEY))) ||
+          (IsKeyword(KEYWORD_WITH) && IsSymbol("(", 1) && Accept(KEYWORD_WITH))){
+      AcceptWord("for");
+      if(IsKeyword(KEYWORD_JOIN) || (IsKeyword(KEYWORD_ORDER) || IsKeyword(KEYWORD_GROUP))){
+        pos_++;
+        Accept(KEYWORD_BY);
+      }
+      SkipBalanced();
+    }
+    return Finish(node);
+  }
+
+  // Dotted name; the principal token is its last part
+  void ParseQualifiedName(Node* node){
+    node->token = static_cast<uint32_t>(pos_);
+    pos_++;
+    while(IsSymbol(".") && pos_ + 1 < tokens_.size()){
+      pos_++;
+      node->token = static_cast<uint32_t>(pos_);
+      if(IsSymbol("*")){
+        node->kind = NODE_KIND_STAR;
+      }
+      pos_++;
+    }
+  }
+
+  // EXPRESSIONS
+
+  Node* ParseExpression(){
+
+    if(depth_ >= PARSER_MAX_DEPTH){
+      auto node = NewNode(NODE_KIND_OTHER);
+      SkipToSeparator();
+      return Finish(node);
+    }
+    depth_++;
+    auto node = ParseOr();
+    depth_--;
+    return node;
+  }
+
+  Node* ParseOr(){
+    auto left = ParseAnd();
+    while(IsKeyword(KEYWORD_OR)){
+      auto op = pos_++;
+      left = Binary(left, op, ParseAnd(), KEYWORD_OR);
+    }
+    return left;
+  }
+
+  Node* ParseAnd(){
+    auto left = ParseNot();
+    while(IsKeyword(KEYWORD_AND)){
+      auto op = pos_++;
+      left = Binary(left, op, ParseNot(), KEYWORD_AND);
+    }
+    return left;
+  }
+
+  Node* ParseNot(){
+    if(IsKeyword(KEYWORD_NOT)){
+      auto node = NewNode(NODE_KIND_UNARY);
+      node->keyword = KEYWORD_NOT;
+      pos_++;
+      node->child = ParseNot();
+      return Finish(node);
+    }
+    return ParsePredicate();
+  }
+
+  Node* ParsePredicate(){
+
+    auto left = ParseArithmetic();
+    while(AtEnd() == false){
+      auto op = pos_;
+      auto negated = IsKeyword(KEYWORD_NOT) &&
+          (IsKeyword(KEYWORD_IN, 1) || IsKeyword(KEYWORD_LIKE, 1) ||
+           IsKeyword(KEYWORD_BETWEEN, 1) || IsKeyword(KEYWORD_REGEXP, 1) ||
+           IsKeyword(KEYWORD_SIMILAR, 1));
+      if(negated){
+        pos_++;
+      }
+
+      if(IsKeyword(KEYWORD_IN)){
+        pos_++;
+        left = Binary(left, op, ParseUnary(), KEYWORD_IN);
+      }
+      else if(IsKeyword(KEYWORD_LIKE) || IsKeyword(KEYWORD_REGEXP) ||
+          (IsKeyword(KEYWORD_SIMILAR) && IsKeyword(KEYWORD_TO, 1))){
+        auto keyword = tokens_[pos_].keyword;
+        pos_ += (keyword == KEYWORD_SIMILAR) ? 2 : 1;
+        auto right = ParseArithmetic();
+        if(AcceptWord("escape")){
+          ParseUnary();
+        }
+        left = Binary(left, op, right, keyword);
+      }
+      else if(IsKeyword(KEYWORD_BETWEEN)){
+        pos_++;
+        auto node = Binary(left, op, nullptr, KEYWORD_BETWEEN);
+        ChildList children(node);
+        children.Add(left);
+        children.Add(ParseArithmetic());
+        Accept(KEYWORD_AND);
+        children.Add(ParseArithmetic());
+        left = Finish(node);
+      }
+      else if(IsKeyword(KEYWORD_IS)){
+        pos_++;
+        Accept(KEYWORD_NOT);
+        Node* right = nullptr;
+        if(Accept(KEYWORD_DISTINCT)){
+          Accept(KEYWORD_FROM);
+          right = ParseArithmetic();
+        }
+        else if(AtEnd() == false){
+          right = Leaf(NODE_KIND_LITERAL);
+        }
+        left = Binary(left, op, right, KEYWORD_IS);
+      }
+      else if(IsComparison()){
+        pos_++;
+        if(IsKeyword(KEYWORD_ANY) || IsKeyword(KEYWORD_ALL) || IsWord("some")){
+          pos_++;
+        }
+        left = Binary(left, op, ParseArithmetic(), KEYWORD_NONE);
+      }
+      else {
+        break;
+      }
+    }
+    return left;
+  }
+
+  Node* ParseArithmetic(){
+    auto left = ParseUnary();
+    while(AtEnd() == false){
+      if(tokens_[pos_].kind == TOKEN_KIND_OPERATOR && IsComparison() == false){
+        auto op = pos_++;
+        left = Binary(left, op, ParseUnary(), KEYWORD_NONE);
+      }
+      else if(IsWord("collate")){
+        pos_ += 2;
+      }
+      else {
+        break;
+      }
+    }
+    return left;
+  }
+
+  Node* ParseUnary(){
+    if(IsSymbol("-") || IsSymbol("+") || IsSymbol("~") || IsSymbol("!")){
+      auto node = NewNode(NODE_KIND_UNARY);
+      pos_++;
+      node->child = ParseUnary();
+      return Finish(node);
+    }
+    return ParsePrimary();
+  }
+
+  Node* ParsePrimary(){
+
+    if(IsExpressionEnd()){
+      return nullptr;
+    }
+
+    auto& token = tokens_[pos_];
+    switch(token.kind){
+      case TOKEN_KIND_NUMBER:
+      case TOKEN_KIND_STRING:
+        return Leaf(NODE_KIND_LITERAL);
+      case TOKEN_KIND_PARAMETER:
+        return Leaf(NODE_KIND_PARAMETER);
+      case TOKEN_KIND_IDENTIFIER:
+        if(pos_ + 1 < tokens_.size() && tokens_[pos_ + 1].kind == TOKEN_KIND_STRING){
+          return ParseTypedLiteral();
+        }
+        return ParseName();
+      case TOKEN_KIND_QUOTED_IDENTIFIER:
+        return ParseName();
+      default:
+        break;
+    }
+
+    if(IsSymbol("*")){
+      return Leaf(NODE_KIND_STAR);
+    }
+    if(IsSymbol("(")){
+      return ParseParenthesized();
+    }
+    if(IsKeyword(KEYWORD_SELECT) || IsKeyword(KEYWORD_WITH)){
+      auto node = NewNode(NODE_KIND_SUBQUERY);
+      node->child = ParseQueryExpression();
+      return Finish(node);
+    }
+    if(IsKeyword(KEYWORD_EXISTS)){
+      auto node = NewNode(NODE_KIND_UNARY);
+      node->keyword = KEYWORD_EXISTS;
+      pos_++;
+      node->child = ParsePrimary();
+      return Finish(node);
+    }
+    if(IsKeyword(KEYWORD_CASE)){
+      return ParseCase();
+    }
+    if(IsKeyword(KEYWORD_NULL) || IsKeyword(KEYWORD_DEFAULT)){
+      auto node = Leaf(NODE_KIND_LITERAL);
+      node->keyword = token.keyword;
+      return node;
+    }
+    if(token.kind == TOKEN_KIND_KEYWORD && IsSymbol("(", 1)){
+      return ParseName();
+    }
+
+    // Type names and other words
+    return Leaf(NODE_KIND_OTHER);
+  }
+
+  // DATE '...', INTERVAL '...' unit
+  Node* ParseTypedLiteral(){
+    auto interval = IsWord("interval");
+    auto node = NewNode(NODE_KIND_LITERAL);
+    pos_ += 2;
+    if(interval && IsName()){
+      pos_++;
+    }
+    return Finish(node);
+  }
+
+  // Column reference, qualified star or function call
+  Node* ParseName(){
+
+    auto node = NewNode(NODE_KIND_COLUMN);
+    ParseQualifiedName(node);
+    if(node->kind == NODE_KIND_STAR || IsSymbol("(") == false){
+      return Finish(node);
+    }
+
+    node->kind = NODE_KIND_FUNCTION;
+    ParseArguments(node);
+
+    // Aggregate and window modifiers
+    while(true){
+      if(AcceptWord("within") || AcceptWord("filter")){
+        Accept(KEYWORD_GROUP);
+        SkipBalanced();
+      }
+      else if(AcceptWord("over")){
+        SkipBalanced();
+      }
+      else {
+        break;
+      }
+    }
+    return Finish(node);
+  }
+
+  void ParseArguments(Node* node){
+
+    if(depth_ >= PARSER_MAX_DEPTH){
+      SkipBalanced();
+      return;
+    }
+    depth_++;
+
+    ChildList arguments(node);
+    pos_++;
+    if(Accept(KEYWORD_DISTINCT)){
+      node->keyword = KEYWORD_DISTINCT;
+    }
+    else {
+      Accept(KEYWORD_ALL);
+    }
+    while(AtEnd() == false && IsSymbol(")") == false && IsSymbol(";") == false){
+      if(AcceptSymbol(",")){
+        continue;
+      }
+      auto start = pos_;
+      arguments.Add(ParseExpression());
+
+      // CAST(x AS type), EXTRACT(field FROM x), ORDER BY in aggregates
+      while(AtEnd() == false && IsSymbol(",") == false && IsSymbol(")") == false &&
+          IsSymbol(";") == false){
+        if(IsKeyword(KEYWORD_FROM) || IsKeyword(KEYWORD_IN)){
+          pos_++;
+          arguments.Add(ParseExpression());
+          continue;
+        }
+        SkipBalanced();
+      }
+      if(pos_ == start){
+        SkipBalanced();
+      }
+    }
+    AcceptSymbol(")");
+    depth_--;
+  }
+
+  Node* ParseParenthesized(){
+
+    if(IsQueryStart(1)){
+      auto node = NewNode(NODE_KIND_SUBQUERY);
+      pos_++;
+      node->child = ParseQueryExpression();
+      SkipToSeparator();
+      AcceptSymbol(")");
+      return Finish(node);
+    }
+
+    if(depth_ >= PARSER_MAX_DEPTH){
+      auto node = NewNode(NODE_KIND_OTHER);
+      SkipBalanced();
+      return Finish(node);
+    }
+    depth_++;
+
+    auto node = NewNode(NODE_KIND_LIST);
+    ChildList items(node);
+    pos_++;
+    while(AtEnd() == false && IsSymbol(")") == false && IsSymbol(";") == false){
+      if(AcceptSymbol(",")){
+        continue;
+      }
+      auto start = pos_;
+      items.Add(ParseExpression());
+      if(pos_ == start){
+        SkipBalanced();
+      }
+      SkipToSeparator();
+    }
+    AcceptSymbol(")");
+
+    depth_--;
+    return Finish(node);
+  }
+
+  Node* ParseCase(){
+
+    auto node = NewNode(NODE_KIND_CASE);
+    ChildList children(node);
+    pos_++;
+    while(AtEnd() == false && IsKeyword(KEYWORD_END) == false &&
+        IsSymbol(")") == false && IsSymbol(";") == false){
+      if(Accept(KEYWORD_WHEN) == false && Accept(KEYWORD_THEN) == false){
+        Accept(KEYWORD_ELSE);
+      }
+      auto start = pos_;
+      children.Add(ParseExpression());
+      if(pos_ == start){
+        SkipBalanced();
+      }
+    }
+    Accept(KEYWORD_END);
+    return Finish(node);
+  }
+
+  // DML
+
+  Node* ParseTableName(){
+    if(IsName() == false){
+      return nullptr;
+    }
+    auto node = NewNode(NODE_KIND_TABLE);
+    ParseQualifiedName(node);
+    return Finish(node);
+  }
+
+  Node* ParseInsert(){
+
+    auto node = NewNode(NODE_KIND_INSERT);
+    ChildList children(node);
+    pos_++;
+
+    // Modifiers (IGNORE, OR REPLACE, ...)
+    for(size_t offset = 0; offset < 3; offset++){
+      if(IsKeyword(KEYWORD_INTO, offset)){
+        pos_ += offset;
+        break;
+      }
+    }
+    Accept(KEYWORD_INTO);
+
+    auto table = ParseTableName();
+    if(table != nullptr){
+      node->token = table->token;
+    }
+    children.Add(ParseAliased(table));
+
+    if(IsSymbol("(") && IsQueryStart(1) == false){
+      children.Add(ParseNameList());
+    }
+
+    if(IsKeyword(KEYWORD_VALUES) || IsWord("value")){
+      children.Add(ParseValues());
+    }
+    else if(IsKeyword(KEYWORD_SELECT) || IsKeyword(KEYWORD_WITH) || IsSymbol("(")){
+      children.Add(ParseQueryExpression());
+    }
+    else if(IsKeyword(KEYWORD_SET)){
+      children.Add(ParseExpressionList(NODE_KIND_SET, 1));
+    }
+    return Finish(node);
+  }
+
+  Node* ParseUpdate(){
+
+    auto node = NewNode(NODE_KIND_UPDATE);
+    ChildList children(node);
+    pos_++;
+    while(AcceptWord("low_priority") || AcceptWord("ignore") || AcceptWord("only")){
+    }
+
+    do {
+      children.Add(ParseJoinedTable());
+    } while(AcceptSymbol(","));
+
+    if(IsKeyword(KEYWORD_SET)){
+      children.Add(ParseExpressionList(NODE_KIND_SET, 1));
+    }
+    ParseClauses(children);
+    return Finish(node);
+  }
+
+  Node* ParseDelete(){
+
+    auto node = NewNode(NODE_KIND_DELETE);
+    ChildList children(node);
+    pos_++;
+    while(AcceptWord("low_priority") || AcceptWord("quick") || AcceptWord("ignore")){
+    }
+
+    // DELETE t1 FROM t1 JOIN t2 ...
+    if(IsKeyword(KEYWORD_FROM) == false){
+      auto targets = NewNode(NODE_KIND_FROM);
+      ParseTableReferences(targets);
+      children.Add(Finish(targets));
+    }
+    if(IsKeyword(KEYWORD_FROM)){
+      children.Add(ParseFrom());
+    }
+    if(Accept(KEYWORD_USING)){
+      auto tables = NewNode(NODE_KIND_FROM);
+      ParseTableReferences(tables);
+      children.Add(Finish(tables));
+    }
+    ParseClauses(children);
+    return Finish(node);
+  }
+
+  // DDL
+
+  Node* ParseCreate(){
+
+    auto start = pos_;
+    pos_++;
+
+    // Modifiers (TEMPORARY, OR REPLACE, UNIQUE, ...)
+    while(AtEnd() == false && IsKeyword(KEYWORD_TABLE) == false &&
+        IsKeyword(KEYWORD_INDEX) == false && IsKeyword(KEYWORD_VIEW) == false &&
+        pos_ < start + 4){
+      pos_++;
+    }
+
+    if(IsKeyword(KEYWORD_TABLE)){
+      pos_ = start;
+      return ParseCreateTable();
+    }
+    if(IsKeyword(KEYWORD_INDEX)){
+      pos_ = start;
+      return ParseCreateIndex();
+    }
+
+    auto node = NewNode(NODE_KIND_OTHER);
+    node->first = static_cast<uint32_t>(start);
+    if(IsKeyword(KEYWORD_VIEW)){
+      while(AtEnd() == false && IsKeyword(KEYWORD_AS) == false && IsSymbol(";") == false){
+        SkipBalanced();
+      }
+      if(Accept(KEYWORD_AS)){
+        node->child = ParseQueryExpression();
+      }
+    }
+    return Finish(node);
+  }
+
+  Node* ParseCreateTable(){
+
+    auto node = NewNode(NODE_KIND_CREATE_TABLE);
+    ChildList children(node);
+    while(Accept(KEYWORD_TABLE) == false && AtEnd() == false){
+      pos_++;
+    }
+    if(IsKeyword(KEYWORD_IF)){
+      pos_ += IsKeyword(KEYWORD_NOT, 1) ? 3 : 2;
+    }
+
+    auto table = ParseTableName();
+    if(table != nullptr){
+      node->token = table->token;
+    }
+    children.Add(table);
+
+    if(AcceptSymbol("(")){
+      while(AtEnd() == false && IsSymbol(")") == false && IsSymbol(";") == false){
+        if(AcceptSymbol(",")){
+          continue;
+        }
+        auto start = pos_;
+        children.Add(ParseTableElement());
+        if(pos_ == start){
+          SkipBalanced();
+        }
+      }
+      AcceptSymbol(")");
+    }
+
+    // CREATE TABLE ... AS SELECT
+    while(AtEnd() == false && IsSymbol(";") == false && IsQueryStart() == false &&
+        IsSymbol("(") == false){
+      pos_++;
+    }
+    if(IsQueryStart() || (IsSymbol("(") && IsQueryStart(1))){
+      children.Add(ParseQueryExpression());
+    }
+    return Finish(node);
+  }
+
+  // Column definition or table constraint
+  Node* ParseTableElement(){
+
+    auto start = pos_;
+    if(Accept(KEYWORD_CONSTRAINT) && IsName()){
+      pos_++;
+    }
+
+    if(IsKeyword(KEYWORD_PRIMARY) || IsKeyword(KEYWORD_FOREIGN) ||
+        IsKeyword(KEYWORD_UNIQUE) || IsKeyword(KEYWORD_CHECK) ||
+        IsKeyword(KEYWORD_INDEX) || IsKeyword(KEYWORD_KEY) ||
+        IsWord("fulltext") || IsWord("spatial")){
+      auto node = NewNode(NODE_KIND_CONSTRAINT);
+      node->first = static_cast<uint32_t>(start);
+      node->keyword = tokens_[pos_].keyword;
+      node->token = static_cast<uint32_t>(pos_);
+      SkipToSeparator();
+      return Finish(node);
+    }
+
+    if(IsName() == false && tokens_[pos_].kind != TOKEN_KIND_KEYWORD){
+      SkipToSeparator();
+      return nullptr;
+    }
+
+    // Column name, type and inline constraints
+    auto node = NewNode(NODE_KIND_COLUMN_DEFINITION);
+    ChildList constraints(node);
+    pos_++;
+    while(AtEnd() == false && IsSymbol(",") == false && IsSymbol(")") == false &&
+        IsSymbol(";") == false){
+      if(IsKeyword(KEYWORD_PRIMARY) || IsKeyword(KEYWORD_REFERENCES) ||
+          IsKeyword(KEYWORD_UNIQUE) || IsKeyword(KEYWORD_CHECK)){
+        auto constraint = NewNode(NODE_KIND_CONSTRAINT);
+        constraint->keyword = tokens_[pos_].keyword;
+        pos_++;
+        Accept(KEYWORD_KEY);
+        if(IsName()){
+          ParseQualifiedName(constraint);
+        }
+        if(IsSymbol("(")){
+          SkipBalanced();
+        }
+        constraints.Add(Finish(constraint));
+        continue;
+      }
+      SkipBalanced();
+    }
+    return Finish(node);
+  }
+
+  Node* ParseCreateIndex(){
+
+    auto node = NewNode(NODE_KIND_CREATE_INDEX);
+    ChildList children(node);
+    while(Accept(KEYWORD_INDEX) == false && AtEnd() == false){
+      if(IsKeyword(KEYWORD_UNIQUE)){
+        node->keyword = KEYWORD_UNIQUE;
+      }
+      pos_++;
+    }
+    while(AtEnd() == false && IsKeyword(KEYWORD_ON) == false && IsSymbol(";") == false){
+      pos_++;
+    }
+    if(Accept(KEYWORD_ON)){
+      AcceptWord("only");
+      auto table = ParseTableName();
+      if(table != nullptr){
+        node->token = table->token;
+      }
+      children.Add(table);
+      if(Accept(KEYWORD_USING)){
+        pos_++;
+      }
+      if(IsSymbol("(")){
+        children.Add(ParseNameList());
+      }
+    }
+    return Finish(node);
+  }
+
+  Node* ParseAlterTable(){
+
+    auto node = NewNode(NODE_KIND_ALTER_TABLE);
+    ChildList children(node);
+    pos_ += 2;
+    AcceptWord("only");
+    if(IsKeyword(KEYWORD_IF)){
+      pos_ += 2;
+    }
+
+    auto table = ParseTableName();
+    if(table != nullptr){
+      node->token = table->token;
+    }
+    children.Add(table);
+
+    do {
+      if(Accept(KEYWORD_ADD) || AcceptWord("modify") || AcceptWord("change")){
+        Accept(KEYWORD_COLUMN);
+        if(IsKeyword(KEYWORD_IF)){
+          pos_ += 3;
+        }
+        if(AcceptSymbol("(")){
+          while(AtEnd() == false && IsSymbol(")") == false && IsSymbol(";") == false){
+            if(AcceptSymbol(",")){
+              continue;
+            }
+            auto start = pos_;
+            children.Add(ParseTableElement());
+            if(pos_ == start){
+              SkipBalanced();
+            }
+          }
+          AcceptSymbol(")");
+        }
+        else {
+          children.Add(ParseTableElement());
+        }
+      }
+      SkipToSeparator();
+    } while(AcceptSymbol(","));
+
+    return Finish(node);
+  }
+
+  // statement text
+  const std::string& sql_statement_;
+
+  // statement tokens
+  const std::vector<Token>& tokens_;
+
+  // node allocator
+  Arena& arena_;
+
+  // current token
+  size_t pos_;
+
+  // recursion depth
+  size_t depth_;
+
+};
+
+}  // namespace
+
+Node* Parse(const std::string& sql_statement,
+            const std::vector<Token>& tokens,
+            Arena& arena){
+
+  Parser parser(sql_statement, tokens, arena);
+  return parser.ParseStatements();
+}
+
+const Node* FindChild(const Node* node, const NodeKind kind){
+  for(auto child = node->child; child != nullptr; child = child->next){
+    if(child->kind == kind){
+      return child;
+    }
+  }
+  return nullptr;
+}
+
+// SUBQUERIES
+
+namespace {
+
+// Names of the tables (and their aliases) in a query scope, without the
+// nested subqueries
+void CollectScopeNames(const Node* node,
+                       std::vector<uint32_t>& names){
+  for(auto child = node->child; child != nullptr; child = child->next){
+    if(child->kind == NODE_KIND_TABLE || child->kind == NODE_KIND_ALIAS){
+      names.push_back(child->token);
+    }
+    if(child->kind != NODE_KIND_SUBQUERY && child->kind != NODE_KIND_DERIVED_TABLE){
+      CollectScopeNames(child, names);
+    }
+  }
+}
+
+class SubqueryAnalyzer {
+
+ public:
+  SubqueryAnalyzer(const std::string& sql_statement,
+                   const std::vector<Token>& tokens,
+                   SubqueryInfo& subqueries)
+ : sql_statement_(sql_statement),
+   tokens_(tokens),
+   subqueries_(subqueries){
+  }
+
+  void VisitScope(const Node* scope, const size_t depth){
+
+    if(depth > subqueries_.max_depth){
+      subqueries_.max_depth = depth;
+      subqueries_.deepest = scope;
+    }
+    auto start = names_.size();
+    scopes_.push_back(start);
+    CollectScopeNames(scope, names_);
+    VisitChildren(scope, scope, depth);
+    names_.resize(start);
+    scopes_.pop_back();
+  }
+
+ private:
+
+  void VisitChildren(const Node* node, const Node* scope, const size_t depth){
+    for(auto child = node->child; child != nullptr; child = child->next){
+      if(child->kind == NODE_KIND_SUBQUERY || child->kind == NODE_KIND_DERIVED_TABLE){
+        VisitScope(child, depth + 1);
+        continue;
+      }
+      if(depth != 0 && child->kind == NODE_KIND_COLUMN && IsOuterReference(child) &&
+          (subqueries_.correlated.empty() || subqueries_.correlated.back() != scope)){
+        subqueries_.correlated.push_back(scope);
+      }
+      VisitChildren(child, scope, depth);
+    }
+  }
+
+  // Qualified column whose qualifier names a table of an enclosing scope
+  // only
+  bool IsOuterReference(const Node* column) const {
+    if(column->token < column->first + 2){
+      return false;
+    }
+    auto& qualifier = tokens_[column->token - 2];
+    auto defined = [&](const size_t first, const size_t last){
+      for(auto itr = first; itr < last; itr++){
+        auto& name = tokens_[names_[itr]];
+        if(name.length == qualifier.length &&
+            sql_statement_.compare(name.offset, name.length,
+                                   sql_statement_, qualifier.offset, qualifier.length) == 0){
+          return true;
+        }
+      }
+      return false;
+    };
+    return defined(scopes_.back(), names_.size()) == false && defined(0, scopes_.back());
+  }
+
+  // statement text
+  const std::string& sql_statement_;
+
+  // statement tokens
+  const std::vector<Token>& tokens_;
+
+  SubqueryInfo& subqueries_;
+
+  // table names of the enclosing scopes, and the start of each scope
+  std::vector<uint32_t> names_;
+  std::vector<size_t> scopes_;
+
+};
+
+}  // namespace
+
+void AnalyzeSubqueries(const std::string& sql_statement,
+                       const std::vector<Token>& tokens,
+                       const Node* tree,
+                       SubqueryInfo& subqueries){
+
+  subqueries.max_depth = 0;
+  subqueries.deepest = nullptr;
+  subqueries.correlated.clear();
+
+  SubqueryAnalyzer analyzer(sql_statement, tokens, subqueries);
+  for(auto statement = tree; statement != nullptr; statement = statement->next){
+    analyzer.VisitScope(statement, 0);
+  }
+}
+
+// ROUTINES
+
+namespace {
+
+// Leading tokens searched for PROCEDURE, FUNCTION or TRIGGER
+const size_t ROUTINE_HEADER_TOKENS = 8;
+
+// Case-insensitive comparison of an identifier with a lower-case word
+bool IsWord(const std::string& sql_statement,
+            const Token& token,
+            const char* word){
+  if(token.kind != TOKEN_KIND_IDENTIFIER || token.length != std::strlen(word)){
+    return false;
+  }
+  for(size_t itr = 0; itr < token.length; itr++){
+    if((sql_statement[token.offset + itr] | 0x20) != word[itr]){
+      return false;
+    }
+  }
+  return true;
+}
+
+bool IsStatementKeyword(const KeywordId keyword){
+  switch(keyword){
+    case KEYWORD_SELECT:
+    case KEYWORD_INSERT:
+    case KEYWORD_UPDATE:
+    case KEYWORD_DELETE:
+    case KEYWORD_CREATE:
+    case KEYWORD_ALTER:
+    case KEYWORD_DROP:
+    case KEYWORD_WITH:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+bool SplitRoutineBody(const std::string& sql_statement,
+                      const std::vector<Token>& tokens,
+                      const Dialect dialect,
+                      std::vector<Token>& body_tokens,
+                      std::vector<BodyStatement>& body_statements){
+
+  body_tokens.clear();
+  body_statements.clear();
+  if(tokens.empty() || tokens[0].keyword != KEYWORD_CREATE){
+    return false;
+  }
+
+  size_t header = 1;
+  auto header_end = std::min(tokens.size(), ROUTINE_HEADER_TOKENS);
+  while(header < header_end &&
+      IsWord(sql_statement, tokens[header], "procedure") == false &&
+      IsWord(sql_statement, tokens[header], "function") == false &&
+      IsWord(sql_statement, tokens[header], "trigger") == false){
+    header++;
+  }
+  if(header == header_end){
+    return false;
+  }
+
+  // Dollar-quoted body, tokenized once
+  size_t pos = header + 1;
+  for(; pos < tokens.size(); pos++){
+    auto& token = tokens[pos];
+    if(IsWord(sql_statement, token, "begin")){
+      break;
+    }
+    if(token.kind != TOKEN_KIND_STRING || sql_statement[token.offset] != '$'){
+      continue;
+    }
+    auto tag = DollarTagLength(sql_statement, token.offset);
+    if(tag != 0 && token.length >= 2 * tag){
+      auto start = token.offset + tag;
+      Tokenize(sql_statement.substr(start, token.length - 2 * tag), body_tokens, dialect);
+      for(auto& body_token : body_tokens){
+        body_token.offset += start;
+      }
+      break;
+    }
+  }
+  if(pos == tokens.size()){
+    return false;
+  }
+
+  // Tokens between BEGIN and the last END
+  if(tokens[pos].kind != TOKEN_KIND_STRING){
+    auto last = tokens.size();
+    for(auto itr = tokens.size(); itr > pos + 1; itr--){
+      if(tokens[itr - 1].keyword == KEYWORD_END){
+        last = itr - 1;
+        break;
+      }
+    }
+    body_tokens.assign(tokens.begin() + pos + 1, tokens.begin() + last);
+  }
+
+  // Split at the semicolons outside parentheses; each statement starts at
+  // its first statement keyword, which skips declarations and the control
+  // flow around it (IF ... THEN, DECLARE ... CURSOR FOR)
+  size_t depth = 0;
+  size_t first = body_tokens.size();
+  for(pos = 0; pos < body_tokens.size(); pos++){
+    auto& token = body_tokens[pos];
+    if(token.kind == TOKEN_KIND_PUNCTUATION){
+      auto c = sql_statement[token.offset];
+      if(c == '('){
+        depth++;
+      }
+      else if(c == ')' && depth != 0){
+        depth--;
+      }
+      else if(c == ';' && depth == 0){
+        if(first < pos){
+          body_statements.push_back(BodyStatement{first, pos});
+        }
+        first = body_tokens.size();
+      }
+    }
+    else if(depth == 0 && first == body_tokens.size() &&
+        token.kind == TOKEN_KIND_KEYWORD && IsStatementKeyword(token.keyword)){
+      first = pos;
+    }
+  }
+  if(first < body_tokens.size()){
+    body_statements.push_back(BodyStatement{first, body_tokens.size()});
+  }
+  return true;
+}
+
+}  // namespace sqlcheck
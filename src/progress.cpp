@@ -0,0 +1,72 @@
+// PROGRESS SOURCE
+
+#include <cstdio>
+
+#include "include/progress.h"
+
+namespace sqlcheck {
+
+ProgressReporter::ProgressReporter(const Configuration& state,
+                                   const unsigned long long total_bytes)
+ : state_(state),
+   total_bytes_(total_bytes),
+   start_(std::chrono::steady_clock::now()),
+   stopped_(false),
+   thread_(&ProgressReporter::Run, this){
+}
+
+ProgressReporter::~ProgressReporter(){
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  stop_condition_.notify_one();
+  thread_.join();
+
+  Print();
+  std::fprintf(stderr, "\n");
+}
+
+void ProgressReporter::Run(){
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(stop_condition_.wait_for(lock,
+                                 std::chrono::milliseconds(PROGRESS_INTERVAL_MS),
+                                 [this](){ return stopped_; }) == false){
+    Print();
+  }
+}
+
+void ProgressReporter::Print(){
+
+  auto bytes = state_.progress_bytes.load(std::memory_order_relaxed);
+  auto statements = state_.progress_statements.load(std::memory_order_relaxed);
+  auto findings = state_.progress_findings.load(std::memory_order_relaxed);
+
+  double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start_).count();
+  if(seconds <= 0){
+    seconds = 1e-9;
+  }
+  double megabytes = bytes / (1024.0 * 1024.0);
+
+  std::fprintf(stderr, "\r%.1f MB", megabytes);
+  if(total_bytes_ != 0){
+    std::fprintf(stderr, " of %.1f MB (%.1f%%)",
+                 total_bytes_ / (1024.0 * 1024.0), 100.0 * bytes / total_bytes_);
+  }
+  std::fprintf(stderr, " :: %llu statements (%.0f/s, %.1f MB/s) :: %llu findings",
+               statements, statements / seconds, megabytes / seconds, findings);
+
+  if(total_bytes_ != 0 && bytes != 0 && bytes < total_bytes_){
+    auto eta = static_cast<unsigned long long>(seconds * (total_bytes_ - bytes) / bytes);
+    std::fprintf(stderr, " :: ETA %llu:%02llu:%02llu",
+                 eta / 3600, (eta / 60) % 60, eta % 60);
+  }
+
+  // Clear the rest of a longer previous line
+  std::fprintf(stderr, "\033[K");
+  std::fflush(stderr);
+
+}
+
+}  // namespace sqlcheck
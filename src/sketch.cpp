@@ -0,0 +1,216 @@
+// SKETCH SOURCE
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+#include "include/sketch.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Spread the bits of a hash (splitmix64 finalizer); statement fingerprints
+// are FNV hashes whose high bits are not uniform enough on their own
+uint64_t MixHash(uint64_t hash){
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebULL;
+  hash ^= hash >> 31;
+  return hash;
+}
+
+// Multipliers and increments of the MinHash functions
+struct MinHashFunctions {
+
+  MinHashFunctions(){
+    for(size_t itr = 0; itr < MINHASH_SIZE; itr++){
+      multipliers[itr] = MixHash(2 * itr + 1) | 1;
+      increments[itr] = MixHash(2 * itr + 2);
+    }
+  }
+
+  uint64_t multipliers[MINHASH_SIZE];
+  uint64_t increments[MINHASH_SIZE];
+
+};
+
+const MinHashFunctions MINHASH_FUNCTIONS;
+
+}  // namespace
+
+HyperLogLog::HyperLogLog(const uint8_t precision)
+ : precision_(precision),
+   registers_(static_cast<size_t>(1) << precision, 0){
+}
+
+void HyperLogLog::Add(const uint64_t hash){
+
+  auto mixed = MixHash(hash);
+  auto index = mixed >> (64 - precision_);
+
+  // Rank of the first set bit in the remaining bits; the guard bit bounds it
+  auto remaining = (mixed << precision_) | (static_cast<uint64_t>(1) << (precision_ - 1));
+  uint8_t rank = static_cast<uint8_t>(__builtin_clzll(remaining) + 1);
+
+  if(rank > registers_[index]){
+    registers_[index] = rank;
+  }
+
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other){
+
+  if(other.precision_ != precision_){
+    throw std::invalid_argument("Cannot merge HyperLogLog counters of different precision");
+  }
+
+  for(size_t itr = 0; itr < registers_.size(); itr++){
+    if(other.registers_[itr] > registers_[itr]){
+      registers_[itr] = other.registers_[itr];
+    }
+  }
+
+}
+
+double HyperLogLog::Estimate() const {
+
+  double registers = static_cast<double>(registers_.size());
+  double alpha = 0.7213 / (1.0 + 1.079 / registers);
+
+  double sum = 0;
+  size_t zeros = 0;
+  for(auto rank : registers_){
+    sum += std::ldexp(1.0, -rank);
+    if(rank == 0){
+      zeros++;
+    }
+  }
+
+  double estimate = alpha * registers * registers / sum;
+
+  // Linear counting for small cardinalities
+  if(estimate <= 2.5 * registers && zeros != 0){
+    estimate = registers * std::log(registers / zeros);
+  }
+
+  return estimate;
+}
+
+void HyperLogLog::Save(std::ostream& output) const {
+
+  // Ranks never exceed 64, so each register fits in two hex digits
+  static const char digits[] = "0123456789abcdef";
+  std::string registers;
+  registers.reserve(2 * registers_.size());
+  for(auto rank : registers_){
+    registers += digits[rank >> 4];
+    registers += digits[rank & 0xf];
+  }
+
+  output << static_cast<int>(precision_) << " " << registers << "\n";
+}
+
+bool HyperLogLog::Load(std::istream& input){
+
+  int precision;
+  std::string registers;
+  if(!(input >> precision >> registers) || precision < 4 || precision > 16 ||
+      registers.size() != (static_cast<size_t>(2) << precision)){
+    return false;
+  }
+
+  precision_ = static_cast<uint8_t>(precision);
+  registers_.assign(registers.size() / 2, 0);
+  for(size_t itr = 0; itr < registers_.size(); itr++){
+    unsigned int rank;
+    if(std::sscanf(registers.c_str() + 2 * itr, "%2x", &rank) != 1){
+      return false;
+    }
+    registers_[itr] = static_cast<uint8_t>(rank);
+  }
+
+  return true;
+}
+
+MinHash ComputeMinHash(const std::vector<uint64_t>& elements){
+
+  MinHash signature;
+  signature.fill(UINT32_MAX);
+
+  // Multiply-shift hashes of the mixed element
+  for(auto element : elements){
+    auto mixed = MixHash(element);
+    for(size_t itr = 0; itr < MINHASH_SIZE; itr++){
+      auto value = static_cast<uint32_t>((mixed * MINHASH_FUNCTIONS.multipliers[itr] +
+                                          MINHASH_FUNCTIONS.increments[itr]) >> 32);
+      signature[itr] = std::min(signature[itr], value);
+    }
+  }
+
+  return signature;
+}
+
+double EstimateSimilarity(const MinHash& left, const MinHash& right){
+
+  size_t equal = 0;
+  for(size_t itr = 0; itr < MINHASH_SIZE; itr++){
+    equal += (left[itr] == right[itr]);
+  }
+  return static_cast<double>(equal) / MINHASH_SIZE;
+}
+
+LshClusters::LshClusters(const double min_similarity)
+ : min_similarity_(min_similarity),
+   clusters_(0){
+}
+
+void LshClusters::Add(const uint64_t key, const MinHash& signature){
+
+  clusters_++;
+
+  const size_t rows = MINHASH_SIZE / MINHASH_BANDS;
+  bool first = false;
+  for(size_t band = 0; band < MINHASH_BANDS; band++){
+    uint64_t bucket = MixHash(band + 1);
+    for(size_t row = band * rows; row < (band + 1) * rows; row++){
+      bucket = MixHash(bucket ^ signature[row]);
+    }
+
+    auto entry = buckets_.insert(std::make_pair(bucket, key));
+    if(entry.second == true){
+      first = true;
+      continue;
+    }
+
+    // Merge with the first set of the bucket
+    auto other = entry.first->second;
+    if(other == key){
+      continue;
+    }
+    auto root = Find(key);
+    auto other_root = Find(other);
+    if(root != other_root &&
+        EstimateSimilarity(signature, signatures_.at(other)) >= min_similarity_){
+      parents_[root] = other_root;
+      clusters_--;
+    }
+  }
+
+  if(first == true){
+    signatures_[key] = signature;
+  }
+}
+
+uint64_t LshClusters::Find(uint64_t key) const {
+
+  auto parent = parents_.find(key);
+  while(parent != parents_.end()){
+    key = parent->second;
+    parent = parents_.find(key);
+  }
+  return key;
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,411 @@
+// SPLITTER SOURCE
+
+#include <algorithm>
+#include <cmath>
+
+#include "include/splitter.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Check for a GO line, which ends a batch in SQL Server scripts (with an
+// optional repeat count)
+bool IsBatchSeparator(const std::string& line){
+
+  size_t pos = line.find_first_not_of(" \t\r");
+  if(pos == std::string::npos || pos + 2 > line.size() ||
+      (line[pos] | 0x20) != 'g' || (line[pos + 1] | 0x20) != 'o'){
+    return false;
+  }
+  for(pos = pos + 2; pos < line.size(); pos++){
+    auto c = line[pos];
+    if(c != ' ' && c != '\t' && c != '\r' && (c < '0' || c > '9')){
+      return false;
+    }
+  }
+  return true;
+
+}
+
+// Case-insensitive comparison of a word with a lower-case keyword
+bool WordEquals(const std::string& line,
+                const size_t pos,
+                const size_t length,
+                const char* keyword){
+
+  size_t itr = 0;
+  for(; itr < length; itr++){
+    if(keyword[itr] == '\0' || (line[pos + itr] | 0x20) != keyword[itr]){
+      return false;
+    }
+  }
+  return keyword[itr] == '\0';
+
+}
+
+bool IsWordChar(const char c){
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+      (c >= '0' && c <= '9') || c == '_';
+}
+
+// Check for a DELIMITER directive of the mysql client and get the new
+// delimiter
+bool IsDelimiterDirective(const std::string& line, std::string& delimiter){
+
+  size_t pos = line.find_first_not_of(" \t\r");
+  if(pos == std::string::npos || pos + 9 >= line.size() ||
+      WordEquals(line, pos, 9, "delimiter") == false ||
+      (line[pos + 9] != ' ' && line[pos + 9] != '\t')){
+    return false;
+  }
+  auto first = line.find_first_not_of(" \t\r", pos + 9);
+  if(first == std::string::npos){
+    return false;
+  }
+  auto last = line.find_first_of(" \t\r", first);
+  delimiter = line.substr(first, (last == std::string::npos) ? std::string::npos : last - first);
+  return true;
+
+}
+
+}  // namespace
+
+StatementSplitter::StatementSplitter(Configuration& state,
+                                     std::istream& input)
+ : delimiter_(state.delimiter),
+   table_(GetLexerTable(state.dialect)),
+   backslash_escapes_(false),
+   comment_depth_(0),
+   words_(0),
+   routine_(false),
+   block_depth_(0),
+   pending_offset_(0),
+   offset_(0),
+   statement_offset_(0),
+   input_(input),
+   cancelled_(state.cancelled),
+   progress_bytes_(state.progress_bytes),
+   progress_statements_(state.progress_statements),
+   line_(0),
+   first_line_(0),
+   statements_(0),
+   sample_rate_(1.0),
+   skip_(0),
+   reservoir_size_(0),
+   reservoir_position_(0),
+   reservoir_filled_(false),
+   random_(SAMPLE_SEED){
+  auto position = input_.tellg();
+  if(position > 0){
+    offset_ = static_cast<unsigned long long>(position);
+  }
+}
+
+void StatementSplitter::SetSampling(const double sample_rate,
+                                    const size_t reservoir_size){
+  sample_rate_ = sample_rate;
+  reservoir_size_ = reservoir_size;
+  skip_ = DrawSkip();
+}
+
+bool StatementSplitter::Next(std::string& sql_statement){
+
+  if(cancelled_.load(std::memory_order_relaxed) == true){
+    return false;
+  }
+
+  if(reservoir_size_ != 0){
+    if(reservoir_filled_ == false){
+      FillReservoir();
+    }
+    if(reservoir_position_ == reservoir_.size()){
+      return false;
+    }
+    sql_statement.swap(reservoir_[reservoir_position_++].second);
+    return true;
+  }
+
+  // Fast-forward over the statements that are not sampled
+  for(; skip_ != 0; skip_--){
+    if(ReadStatement(nullptr) == false){
+      return false;
+    }
+  }
+
+  if(ReadStatement(&sql_statement) == false){
+    return false;
+  }
+  skip_ = DrawSkip();
+  return true;
+}
+
+bool StatementSplitter::ReadStatement(std::string* sql_statement){
+
+  std::string statement;
+  std::string statement_fragment;
+  unsigned long long bytes = 0;
+  bool started = false;
+
+  while(true){
+
+    // Continue after the delimiter of the last statement, or read a line
+    unsigned long long fragment_offset = offset_;
+    if(pending_.empty() == false){
+      fragment_offset = pending_offset_;
+      statement_fragment.swap(pending_);
+      pending_.clear();
+    }
+    else if(std::getline(input_, statement_fragment)){
+      line_++;
+      bytes += statement_fragment.size() + 1;
+      offset_ += statement_fragment.size() + (input_.eof() ? 0 : 1);
+    }
+    else {
+      break;
+    }
+
+    auto outside = closing_.empty() && comment_depth_ == 0;
+
+    // Delimiter change between statements
+    if(started == false && outside && IsDelimiterDirective(statement_fragment, delimiter_)){
+      continue;
+    }
+
+    // Batch separator (outside quotes and comments)
+    auto batch_end = table_.batch_separator && outside &&
+        IsBatchSeparator(statement_fragment);
+    if(batch_end && started == false){
+      continue;
+    }
+
+    size_t pos = 0;
+    auto statement_end = batch_end || ScanFragment(statement_fragment, pos);
+    if(batch_end == false && statement_end == true){
+      auto rest = statement_fragment.find_first_not_of(" \t\r", pos);
+      if(rest != std::string::npos){
+        pending_ = statement_fragment.substr(rest);
+        pending_offset_ = fragment_offset + rest;
+      }
+      statement_fragment.resize(pos);
+    }
+
+    // Append fragment to statement
+    auto first = statement_fragment.find_first_not_of(" \t\r");
+    auto blank = first == std::string::npos;
+    if(batch_end == false && (blank == false || started) &&
+        statement_fragment.empty() == false){
+      if(started == false){
+        first_line_ = line_;
+        statement_offset_ = fragment_offset + first;
+        started = true;
+      }
+      if(sql_statement != nullptr){
+        statement += statement_fragment;
+        statement += ' ';
+      }
+    }
+
+    if(statement_end){
+      words_ = 0;
+      routine_ = false;
+      block_depth_ = 0;
+      statements_++;
+      progress_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+      progress_statements_.fetch_add(1, std::memory_order_relaxed);
+      if(sql_statement != nullptr){
+        sql_statement->swap(statement);
+      }
+      return true;
+    }
+
+  }
+
+  progress_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  return false;
+}
+
+bool StatementSplitter::ScanFragment(std::string& statement_fragment, size_t& pos){
+
+  auto& line = statement_fragment;
+  auto size = line.size();
+  while(pos < size){
+    auto c = line[pos];
+    auto next = (pos + 1 < size) ? line[pos + 1] : '\0';
+
+    // Inside a block comment
+    if(comment_depth_ != 0){
+      if(c == '*' && next == '/'){
+        comment_depth_--;
+        pos += 2;
+      }
+      else if(c == '/' && next == '*' && table_.nested_comments){
+        comment_depth_++;
+        pos += 2;
+      }
+      else {
+        pos++;
+      }
+      continue;
+    }
+
+    // Inside a quoted string or identifier
+    if(closing_.empty() == false){
+      if(c == '\\' && backslash_escapes_){
+        pos += 2;
+      }
+      else if(line.compare(pos, closing_.size(), closing_) == 0){
+        pos += closing_.size();
+        closing_.clear();
+      }
+      else {
+        pos++;
+      }
+      continue;
+    }
+
+    if(block_depth_ == 0 && line.compare(pos, delimiter_.size(), delimiter_) == 0){
+      pos += delimiter_.size();
+      return true;
+    }
+
+    // Words of the statement header, and the blocks of a routine body
+    if(IsWordChar(c) && (pos == 0 || IsWordChar(line[pos - 1]) == false) &&
+        (routine_ || words_ < ROUTINE_HEADER_WORDS)){
+      auto length = ScanWord(line, pos);
+      pos += length;
+      continue;
+    }
+
+    // Drop a line comment, which would otherwise swallow the following
+    // lines once they are joined into one statement
+    if((c == '-' && next == '-') || (c == '#' && table_.hash_comments)){
+      line.resize(pos);
+      return false;
+    }
+
+    if(c == '/' && next == '*'){
+      comment_depth_ = 1;
+      pos += 2;
+      continue;
+    }
+
+    if(c == '\'' || c == '"'){
+      closing_.assign(1, c);
+      backslash_escapes_ = table_.backslash_escapes ||
+          (c == '\'' && table_.escape_strings && pos > 0 && (line[pos - 1] | 0x20) == 'e');
+    }
+    else if((c == '`' && table_.backtick_identifiers) ||
+        (c == '[' && table_.bracket_identifiers)){
+      closing_.assign(1, (c == '[') ? ']' : c);
+      backslash_escapes_ = false;
+    }
+    else if(c == '$' && table_.dollar_quotes && DollarTagLength(line, pos) != 0){
+      auto length = DollarTagLength(line, pos);
+      closing_ = line.substr(pos, length);
+      backslash_escapes_ = false;
+      pos += length;
+      continue;
+    }
+    pos++;
+  }
+  return false;
+}
+
+size_t StatementSplitter::ScanWord(const std::string& line, const size_t pos){
+
+  size_t length = 0;
+  while(pos + length < line.size() && IsWordChar(line[pos + length])){
+    length++;
+  }
+
+  words_++;
+  if(routine_ == false){
+    if(words_ == 1){
+      words_ = WordEquals(line, pos, length, "create") ? 1 : ROUTINE_HEADER_WORDS;
+    }
+    else if(WordEquals(line, pos, length, "procedure") ||
+        WordEquals(line, pos, length, "function") ||
+        WordEquals(line, pos, length, "trigger")){
+      routine_ = true;
+    }
+    return length;
+  }
+
+  if(WordEquals(line, pos, length, "begin") ||
+      (block_depth_ != 0 && WordEquals(line, pos, length, "case"))){
+    block_depth_++;
+  }
+  else if(block_depth_ != 0 && WordEquals(line, pos, length, "end")){
+
+    // END IF, END LOOP, ... close statements that do not open a block,
+    // END CASE closes a CASE
+    auto next = line.find_first_not_of(" \t\r", pos + length);
+    size_t next_length = 0;
+    while(next != std::string::npos && next + next_length < line.size() &&
+        IsWordChar(line[next + next_length])){
+      next_length++;
+    }
+    if(next_length != 0 &&
+        (WordEquals(line, next, next_length, "if") ||
+         WordEquals(line, next, next_length, "loop") ||
+         WordEquals(line, next, next_length, "while") ||
+         WordEquals(line, next, next_length, "repeat") ||
+         WordEquals(line, next, next_length, "for"))){
+      return next + next_length - pos;
+    }
+    block_depth_--;
+    if(next_length != 0 && WordEquals(line, next, next_length, "case")){
+      return next + next_length - pos;
+    }
+  }
+  return length;
+}
+
+unsigned long long StatementSplitter::DrawSkip(){
+
+  if(sample_rate_ >= 1.0){
+    return 0;
+  }
+
+  // The gaps between Bernoulli samples are geometrically distributed
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  auto u = 1.0 - uniform(random_);
+  return static_cast<unsigned long long>(std::floor(std::log(u) / std::log(1.0 - sample_rate_)));
+}
+
+void StatementSplitter::FillReservoir(){
+
+  reservoir_filled_ = true;
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  auto draw = [&](){ return 1.0 - uniform(random_); };
+
+  std::string sql_statement;
+  while(reservoir_.size() < reservoir_size_ && ReadStatement(&sql_statement)){
+    reservoir_.push_back(std::make_pair(statements_, sql_statement));
+  }
+
+  // Jump directly to the next statement that replaces a sample
+  double weight = std::exp(std::log(draw()) / reservoir_size_);
+  while(reservoir_.size() == reservoir_size_){
+    auto skip = static_cast<unsigned long long>(
+        std::floor(std::log(draw()) / std::log(1.0 - weight)));
+    for(; skip != 0; skip--){
+      if(ReadStatement(nullptr) == false){
+        break;
+      }
+    }
+    if(skip != 0 || ReadStatement(&sql_statement) == false){
+      break;
+    }
+
+    std::uniform_int_distribution<size_t> slot(0, reservoir_size_ - 1);
+    reservoir_[slot(random_)] = std::make_pair(statements_, sql_statement);
+    weight *= std::exp(std::log(draw()) / reservoir_size_);
+  }
+
+  // Return the samples in input order
+  std::sort(reservoir_.begin(), reservoir_.end());
+}
+
+}  // namespace sqlcheck
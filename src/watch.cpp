@@ -0,0 +1,185 @@
+// WATCH SOURCE
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "include/watch.h"
+#include "include/checker.h"
+#include "include/hash.h"
+#include "include/splitter.h"
+
+namespace sqlcheck {
+
+namespace {
+
+bool IsSqlFile(const std::string& file_name){
+  auto suffix = std::string(".sql");
+  return file_name.size() > suffix.size() &&
+      file_name.compare(file_name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Report the findings of removed copies of a statement as resolved
+size_t ResolveFindings(const Configuration& state,
+                       const StatementFindings& statement,
+                       const size_t copies){
+  for(size_t copy = 0; copy < copies; copy++){
+    for(auto& finding : statement.findings){
+      std::cout << "[" << state.file_name << "]: (RESOLVED) "
+          << PatternIdToString(finding.pattern_id) << "\n";
+    }
+  }
+  return statement.findings.size() * copies;
+}
+
+void PrintDelta(const WatchDelta& delta){
+  std::cout << ">  New         :: " << delta.new_findings << "\n";
+  std::cout << ">  Resolved    :: " << delta.resolved_findings << "\n";
+  std::cout.flush();
+}
+
+// Re-check a file of the watched directory; missing files are forgotten
+WatchDelta UpdateFile(Configuration& state,
+                      const std::string& file_name,
+                      std::map<std::string, WatchedFile>& files){
+
+  state.file_name = state.watch_dir + "/" + file_name;
+
+  std::ifstream input(state.file_name.c_str());
+  if(!input){
+    WatchDelta delta{0, 0};
+    for(auto& entry : files[file_name].statements){
+      delta.resolved_findings += ResolveFindings(state, entry.second.result,
+                                                 entry.second.copies);
+    }
+    files.erase(file_name);
+    return delta;
+  }
+
+  return UpdateWatchedFile(state, input, files[file_name]);
+}
+
+}  // namespace
+
+WatchDelta UpdateWatchedFile(Configuration& state,
+                             std::istream& input,
+                             WatchedFile& file){
+
+  WatchDelta delta{0, 0};
+  std::map<uint64_t, WatchedStatement> statements;
+
+  StatementSplitter splitter(state, input);
+  std::string sql_statement;
+  while(splitter.Next(sql_statement)){
+    auto hash = HashString(sql_statement);
+    auto& statement = statements[hash];
+    statement.copies++;
+
+    auto previous = file.statements.find(hash);
+    auto previous_copies = (previous == file.statements.end()) ? 0 : previous->second.copies;
+    if(statement.copies == 1){
+
+      // Reuse the findings of unchanged statements
+      if(previous != file.statements.end()){
+        statement.result = previous->second.result;
+      }
+      else {
+        CheckStatement(state, sql_statement);
+        statement.result = StatementFindings{state.statement, state.findings};
+        delta.new_findings += state.findings.size();
+        continue;
+      }
+    }
+
+    // Copies beyond those in the last version are new
+    if(statement.copies > previous_copies){
+      state.findings = statement.result.findings;
+      ReportFindings(state, statement.result.statement);
+      delta.new_findings += state.findings.size();
+    }
+  }
+
+  // Copies left over were changed or removed
+  for(auto& entry : file.statements){
+    auto current = statements.find(entry.first);
+    auto copies = (current == statements.end()) ? 0 : current->second.copies;
+    if(entry.second.copies > copies){
+      delta.resolved_findings += ResolveFindings(state, entry.second.result,
+                                                 entry.second.copies - copies);
+    }
+  }
+
+  file.statements.swap(statements);
+  return delta;
+}
+
+void WatchDirectory(Configuration& state){
+
+  int handle = inotify_init();
+  if(handle < 0 ||
+      inotify_add_watch(handle, state.watch_dir.c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE | IN_MOVED_FROM) < 0){
+    throw std::runtime_error("Could not watch directory: " + state.watch_dir +
+                             " (" + std::strerror(errno) + ")");
+  }
+
+  DIR* directory = opendir(state.watch_dir.c_str());
+  if(directory == nullptr){
+    throw std::runtime_error("Could not open directory: " + state.watch_dir);
+  }
+  std::set<std::string> file_names;
+  struct dirent* entry;
+  while((entry = readdir(directory)) != nullptr){
+    if(IsSqlFile(entry->d_name)){
+      file_names.insert(entry->d_name);
+    }
+  }
+  closedir(directory);
+
+  std::cout << "==================== Results ===================\n";
+
+  std::map<std::string, WatchedFile> files;
+  WatchDelta delta{0, 0};
+  for(auto& file_name : file_names){
+    delta.new_findings += UpdateFile(state, file_name, files).new_findings;
+  }
+  PrintDelta(delta);
+
+  char buffer[64 * 1024]
+      __attribute__ ((aligned(__alignof__(struct inotify_event))));
+  while(true){
+    auto length = read(handle, buffer, sizeof(buffer));
+    if(length < 0){
+      if(errno == EINTR){
+        continue;
+      }
+      throw std::runtime_error("Could not read file events: " +
+                               std::string(std::strerror(errno)));
+    }
+
+    // Coalesce the events of a batch per file
+    file_names.clear();
+    for(char* pos = buffer; pos < buffer + length;){
+      auto event = reinterpret_cast<struct inotify_event*>(pos);
+      if(event->len != 0 && IsSqlFile(event->name)){
+        file_names.insert(event->name);
+      }
+      pos += sizeof(struct inotify_event) + event->len;
+    }
+
+    for(auto& file_name : file_names){
+      std::cout << "==================== Changes ===================\n";
+      PrintDelta(UpdateFile(state, file_name, files));
+    }
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -0,0 +1,431 @@
+// WORKLOAD SOURCE
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+#include "include/workload.h"
+#include "include/hash.h"
+
+namespace sqlcheck {
+
+namespace {
+
+// Hash of the text of a token (FNV-1a)
+uint64_t TokenHash(const std::string& query,
+                   const Token& token){
+  const uint64_t prime = 1099511628211ULL;
+  uint64_t hash = HASH_SEED;
+  for(size_t pos = token.offset; pos < token.offset + token.length; pos++){
+    hash ^= static_cast<unsigned char>(query[pos]);
+    hash *= prime;
+  }
+  return hash;
+}
+
+// Locate the end of a parenthesized list of placeholders: (?, ?, ?)
+size_t FindValueListEnd(const std::string& query, size_t pos){
+  bool expect_value = true;
+
+  for(pos = pos + 1; pos < query.size(); pos++){
+    char c = query[pos];
+    if(c == ' '){
+      continue;
+    }
+    if(expect_value){
+      if(c != '?'){
+        return std::string::npos;
+      }
+      expect_value = false;
+    }
+    else if(c == ','){
+      expect_value = true;
+    }
+    else if(c == ')'){
+      return pos + 1;
+    }
+    else {
+      return std::string::npos;
+    }
+  }
+
+  return std::string::npos;
+}
+
+// Collapse IN lists and multi-row VALUES lists into a single placeholder
+std::string CollapseValueLists(const std::string& query){
+  std::string collapsed;
+  collapsed.reserve(query.size());
+
+  for(size_t pos = 0; pos < query.size(); pos++){
+    if(query[pos] != '('){
+      collapsed += query[pos];
+      continue;
+    }
+
+    auto end = FindValueListEnd(query, pos);
+    if(end == std::string::npos){
+      collapsed += query[pos];
+      continue;
+    }
+
+    // Drop repeated rows: (?), (?)
+    auto length = collapsed.size();
+    if(length >= 4 && collapsed.compare(length - 4, 4, "(?),") == 0){
+      collapsed.pop_back();
+    }
+    else if(length >= 5 && collapsed.compare(length - 5, 5, "(?), ") == 0){
+      collapsed.resize(length - 2);
+    }
+    else {
+      collapsed += "(?)";
+    }
+    pos = end - 1;
+  }
+
+  return collapsed;
+}
+
+unsigned long long EstimateDistinct(const HyperLogLog& counter){
+  return static_cast<unsigned long long>(std::llround(counter.Estimate()));
+}
+
+// Count an execution of a query shape exhibiting an anti-pattern
+void CountPattern(Configuration& state,
+                  const uint64_t fingerprint,
+                  const PatternId pattern_id,
+                  const bool new_query){
+
+  auto& rank = state.pattern_ranks[pattern_id];
+  rank.pattern_id = pattern_id;
+  rank.executions++;
+  if(new_query == true){
+    rank.queries++;
+    state.pattern_shapes[pattern_id].Add(fingerprint);
+  }
+
+  if(state.top_k != 0){
+    QueryPattern evicted;
+    state.pattern_sketch.Add(QueryPattern{fingerprint, pattern_id}, 1, evicted);
+  }
+
+}
+
+}  // namespace
+
+std::string NormalizeQuery(const std::string& sql_statement,
+                           const std::vector<Token>& tokens){
+
+  std::string query;
+  query.reserve(sql_statement.size());
+
+  // Drop the trailing delimiters
+  auto count = tokens.size();
+  while(count != 0 && tokens[count - 1].kind == TOKEN_KIND_PUNCTUATION &&
+      sql_statement[tokens[count - 1].offset] == ';'){
+    count--;
+  }
+
+  // Comments and white space become a single space, literals a ?
+  size_t end = 0;
+  for(size_t pos = 0; pos < count; pos++){
+    auto& token = tokens[pos];
+    if(token.offset > end && query.empty() == false){
+      query += ' ';
+    }
+    end = token.offset + token.length;
+
+    if(token.kind == TOKEN_KIND_STRING || token.kind == TOKEN_KIND_NUMBER ||
+        token.kind == TOKEN_KIND_PARAMETER){
+      query += '?';
+    }
+    else {
+      query.append(sql_statement, token.offset, token.length);
+    }
+  }
+
+  return CollapseValueLists(query);
+}
+
+std::string NormalizeQuery(const std::string& sql_statement){
+  std::vector<Token> tokens;
+  Tokenize(sql_statement, tokens);
+  return NormalizeQuery(sql_statement, tokens);
+}
+
+bool RecordQuery(Configuration& state,
+                 const std::string& sql_statement,
+                 const std::vector<Token>& tokens,
+                 uint64_t& fingerprint){
+
+  auto query = NormalizeQuery(sql_statement, tokens);
+  fingerprint = HashString(query);
+  state.executions++;
+  state.query_shapes.Add(fingerprint);
+
+  // Bound the tracked query shapes
+  if(state.top_k != 0){
+    if(state.query_sketch.Capacity() == 0){
+      state.query_sketch = SpaceSaving<uint64_t>(state.top_k * SKETCH_CAPACITY_FACTOR);
+      state.pattern_sketch = SpaceSaving<QueryPattern, QueryPatternHash>(
+          state.top_k * SKETCH_CAPACITY_FACTOR);
+    }
+
+    uint64_t evicted;
+    if(state.query_sketch.Add(fingerprint, 1, evicted)){
+      state.query_stats.erase(evicted);
+    }
+  }
+
+  auto& query_stats = state.query_stats[fingerprint];
+  query_stats.executions++;
+
+  if(query_stats.executions > 1){
+    for(auto pattern_id : query_stats.pattern_ids){
+      CountPattern(state, fingerprint, pattern_id, false);
+    }
+    return false;
+  }
+
+  query_stats.query = query;
+  if(state.cluster_queries == true){
+    ClusterQuery(state, fingerprint, query);
+  }
+  return true;
+}
+
+void ClusterQuery(Configuration& state,
+                  const uint64_t fingerprint,
+                  const std::string& query){
+
+  // Shingles: single tokens and pairs of adjacent tokens, so that
+  // reordered columns and optional filters keep most shingles in common
+  std::vector<Token> tokens;
+  Tokenize(query, tokens);
+  std::vector<uint64_t> shingles;
+  shingles.reserve(2 * tokens.size());
+  uint64_t previous = 0;
+  for(auto& token : tokens){
+    auto hash = TokenHash(query, token);
+    shingles.push_back(hash);
+    shingles.push_back(previous * 31 + hash + 1);
+    previous = hash;
+  }
+
+  state.query_clusters.Add(fingerprint, ComputeMinHash(shingles));
+}
+
+std::vector<QueryCluster> RankClusters(const Configuration& state){
+
+  std::unordered_map<uint64_t, QueryCluster> clusters;
+  for(auto& entry : state.query_stats){
+    auto& cluster = clusters[state.query_clusters.Find(entry.first)];
+    auto& query_stats = entry.second;
+    cluster.executions += query_stats.executions;
+    cluster.queries++;
+
+    // The heaviest query represents the cluster
+    if(query_stats.executions > cluster.representative_executions ||
+        (query_stats.executions == cluster.representative_executions &&
+         entry.first < cluster.representative)){
+      cluster.representative = entry.first;
+      cluster.representative_executions = query_stats.executions;
+    }
+
+    for(auto pattern_id : query_stats.pattern_ids){
+      if(std::find(cluster.pattern_ids.begin(), cluster.pattern_ids.end(),
+                   pattern_id) == cluster.pattern_ids.end()){
+        cluster.pattern_ids.push_back(pattern_id);
+      }
+    }
+  }
+
+  std::vector<QueryCluster> ranking;
+  for(auto& entry : clusters){
+    if(entry.second.pattern_ids.empty() == false){
+      std::sort(entry.second.pattern_ids.begin(), entry.second.pattern_ids.end());
+      ranking.push_back(entry.second);
+    }
+  }
+
+  std::sort(ranking.begin(), ranking.end(),
+            [](const QueryCluster& left, const QueryCluster& right){
+              if(left.executions != right.executions){
+                return left.executions > right.executions;
+              }
+              return left.representative < right.representative;
+            });
+
+  return ranking;
+}
+
+void RecordFindings(Configuration& state,
+                    const uint64_t fingerprint){
+
+  // A routine body or a rule can report a pattern more than once; the
+  // executions of a query count once per pattern
+  auto& query_stats = state.query_stats[fingerprint];
+  for(auto& finding : state.findings){
+    auto& pattern_ids = query_stats.pattern_ids;
+    if(std::find(pattern_ids.begin(), pattern_ids.end(), finding.pattern_id) !=
+        pattern_ids.end()){
+      continue;
+    }
+    pattern_ids.push_back(finding.pattern_id);
+    CountPattern(state, fingerprint, finding.pattern_id, true);
+  }
+
+}
+
+std::vector<PatternRank> RankPatterns(const Configuration& state){
+
+  std::vector<PatternRank> ranking;
+  for(auto& entry : state.pattern_ranks){
+    ranking.push_back(entry.second);
+
+    // Shapes evicted from the top-k sketch are counted again when they
+    // recur, so estimate the distinct shapes instead
+    if(state.top_k != 0){
+      ranking.back().queries = EstimateDistinct(state.pattern_shapes.at(entry.first));
+    }
+  }
+
+  std::stable_sort(ranking.begin(), ranking.end(),
+                   [](const PatternRank& left, const PatternRank& right){
+                     return left.executions > right.executions;
+                   });
+
+  return ranking;
+}
+
+// Print the heaviest clusters of near-duplicate queries with findings
+void PrintClusters(const Configuration& state,
+                   const size_t top_clusters,
+                   const size_t query_width){
+
+  auto clusters = RankClusters(state);
+  if(clusters.size() > top_clusters){
+    clusters.resize(top_clusters);
+  }
+
+  std::cout << "> Query clusters by executions\n";
+  for(auto& cluster : clusters){
+    auto query = state.query_stats.at(cluster.representative).query;
+    if(query.size() > query_width){
+      query = query.substr(0, query_width) + "...";
+    }
+
+    std::cout << std::setw(12) << cluster.executions << " :: ["
+        << HashToString(cluster.representative) << "] " << query
+        << " (" << cluster.queries << (cluster.queries == 1 ? " query)\n" : " queries)\n");
+
+    std::cout << std::setw(16) << "";
+    for(size_t pattern = 0; pattern < cluster.pattern_ids.size(); pattern++){
+      std::cout << (pattern == 0 ? "" : ", ")
+          << PatternIdToString(cluster.pattern_ids[pattern]);
+    }
+    std::cout << "\n";
+  }
+
+}
+
+void PrintWorkloadSummary(const Configuration& state){
+
+  const size_t query_width = 60;
+  auto top_queries = (state.top_k != 0) ? state.top_k : 10;
+
+  std::cout << "\n==================== Workload ==================\n";
+  auto approximate = (state.top_k != 0) ? "~" : "";
+  auto distinct_queries = (state.top_k != 0) ?
+      EstimateDistinct(state.query_shapes) : state.query_stats.size();
+
+  std::cout << "Executions   :: " << state.executions << " ("
+      << approximate << distinct_queries << " distinct queries";
+  if(state.cluster_queries == true){
+    std::cout << ", " << state.query_clusters.Size() << " clusters";
+  }
+  std::cout << ")\n";
+
+  auto ranking = RankPatterns(state);
+  if(ranking.empty()){
+    return;
+  }
+
+  std::cout << "> Anti-Patterns by executions\n";
+  for(auto& rank : ranking){
+    std::cout << std::setw(12) << rank.executions << " :: "
+        << PatternIdToString(rank.pattern_id) << " (" << approximate
+        << rank.queries << (rank.queries == 1 ? " query)\n" : " queries)\n");
+  }
+
+  // Heaviest offending query shapes
+  std::vector<std::pair<uint64_t, unsigned long long>> queries;
+  if(state.top_k == 0){
+    for(auto& entry : state.query_stats){
+      if(entry.second.pattern_ids.empty() == false){
+        queries.push_back(std::make_pair(entry.first, entry.second.executions));
+      }
+    }
+    auto count = std::min(top_queries, queries.size());
+    std::partial_sort(queries.begin(), queries.begin() + count, queries.end(),
+                      [](const std::pair<uint64_t, unsigned long long>& left,
+                         const std::pair<uint64_t, unsigned long long>& right){
+                        if(left.second != right.second){
+                          return left.second > right.second;
+                        }
+                        return left.first < right.first;
+                      });
+    queries.resize(count);
+  }
+  else {
+    for(auto& counter : state.query_sketch.Top(state.query_sketch.Size())){
+      auto query_stats = state.query_stats.find(counter.key);
+      if(query_stats != state.query_stats.end() &&
+          query_stats->second.pattern_ids.empty() == false){
+        queries.push_back(std::make_pair(counter.key, counter.count));
+      }
+      if(queries.size() == top_queries){
+        break;
+      }
+    }
+  }
+
+  std::cout << "> Queries by executions\n";
+  for(auto& entry : queries){
+    auto& query_stats = state.query_stats.at(entry.first);
+    auto query = query_stats.query;
+    if(query.size() > query_width){
+      query = query.substr(0, query_width) + "...";
+    }
+
+    std::cout << std::setw(12) << entry.second << " :: ["
+        << HashToString(entry.first) << "] " << query << "\n";
+
+    std::cout << std::setw(16) << "";
+    for(size_t pattern = 0; pattern < query_stats.pattern_ids.size(); pattern++){
+      std::cout << (pattern == 0 ? "" : ", ")
+          << PatternIdToString(query_stats.pattern_ids[pattern]);
+    }
+    std::cout << "\n";
+  }
+
+  if(state.cluster_queries == true){
+    PrintClusters(state, top_queries, query_width);
+  }
+
+  if(state.top_k == 0){
+    return;
+  }
+
+  std::cout << "> Anti-Patterns by query\n";
+  for(auto& counter : state.pattern_sketch.Top(state.top_k)){
+    std::cout << std::setw(12) << counter.count << " :: ["
+        << HashToString(counter.key.fingerprint) << "] "
+        << PatternIdToString(counter.key.pattern_id) << "\n";
+  }
+
+}
+
+}  // namespace sqlcheck
@@ -1,8 +1,29 @@
 // TEST SUITE
 
 #include <sstream>
+#include <fstream>
+#include <cstdlib>
+#include <regex>
+
+#include <unistd.h>
 
 #include "checker.h"
+#include "migration.h"
+#include "diff.h"
+#include "workload.h"
+#include "hash.h"
+#include "cache.h"
+#include "changes.h"
+#include "watch.h"
+#include "checkpoint.h"
+#include "compare.h"
+#include "splitter.h"
+#include "budget.h"
+#include "progress.h"
+#include "lexer.h"
+#include "keyword_table.h"
+#include "parser.h"
+#include "list.h"
 
 #include <gtest/gtest.h>
 
@@ -456,5 +477,1304 @@ TEST(TestSuite, QueryTests) {
 
 }
 
+TEST(TestSuite, CatalogTest) {
+
+  Catalog catalog;
+
+  catalog.ApplyStatement("create table bugs ( bug_id serial primary key, "
+                         "summary varchar(80), hours float, index (summary) );");
+  catalog.ApplyStatement("create table accounts ( account_id int, email text );");
+  catalog.ApplyStatement("alter table accounts add column rate numeric(9,2), "
+                         "add constraint pk_accounts primary key (account_id);");
+  catalog.ApplyStatement("alter table bugs drop column hours;");
+  catalog.ApplyStatement("create unique index bugs_summary on bugs (summary);");
+  catalog.ApplyStatement("select * from bugs;");
+
+  ASSERT_EQ(2, catalog.tables.size());
+  EXPECT_EQ(2, catalog.tables["bugs"].columns.size());
+  EXPECT_EQ(2, catalog.tables["bugs"].indexes.size());
+  EXPECT_EQ(3, catalog.tables["accounts"].columns.size());
+  EXPECT_TRUE(catalog.tables["accounts"].HasPrimaryKey());
+
+  catalog.ApplyStatement("alter table accounts drop constraint pk_accounts;");
+  catalog.ApplyStatement("drop index bugs_summary;");
+  EXPECT_FALSE(catalog.tables["accounts"].HasPrimaryKey());
+  EXPECT_EQ(1, catalog.tables["bugs"].indexes.size());
+
+  // Round trip
+  std::stringstream buffer;
+  catalog.Save(buffer);
+  Catalog loaded;
+  ASSERT_TRUE(loaded.Load(buffer));
+  std::stringstream reloaded;
+  loaded.Save(reloaded);
+  EXPECT_EQ(buffer.str(), reloaded.str());
+
+  catalog.ApplyStatement("drop table if exists bugs, accounts;");
+  EXPECT_TRUE(catalog.tables.empty());
+
+}
+
+void WriteFile(const std::string& file_name, const std::string& contents){
+  std::ofstream output(file_name.c_str());
+  output << contents;
+}
+
+TEST(TestSuite, MigrationTest) {
+
+  char directory_template[] = "/tmp/sqlcheck_migrations_XXXXXX";
+  std::string directory = mkdtemp(directory_template);
+
+  WriteFile(directory + "/V1__init.sql",
+            "CREATE TABLE Bugs (bug_id SERIAL PRIMARY KEY, hours FLOAT);\n");
+  WriteFile(directory + "/V2__accounts.sql",
+            "CREATE TABLE Accounts (account_id SERIAL PRIMARY KEY);\n");
+  WriteFile(directory + "/V10__rename.sql",
+            "ALTER TABLE Accounts RENAME TO Users;\n");
+  WriteFile(directory + "/README.md", "");
+
+  auto migrations = ListMigrations(directory);
+  ASSERT_EQ(3, migrations.size());
+  EXPECT_EQ(directory + "/V10__rename.sql", migrations.back().file_name);
+
+  Configuration default_conf;
+  default_conf.migration_dir = directory;
+  default_conf.cache_dir = directory + "/.sqlcheck-cache";
+
+  EXPECT_EQ(3, CheckMigrations(default_conf));
+  EXPECT_EQ(1, default_conf.catalog.tables.count("users"));
+
+  // Only the new migration is checked on top of the cached catalog
+  WriteFile(directory + "/V11__comments.sql",
+            "CREATE TABLE Comments (comment_id SERIAL PRIMARY KEY);\n");
+
+  Configuration incremental_conf;
+  incremental_conf.migration_dir = directory;
+  incremental_conf.cache_dir = directory + "/.sqlcheck-cache";
+
+  EXPECT_EQ(1, CheckMigrations(incremental_conf));
+  EXPECT_EQ(3, incremental_conf.catalog.tables.size());
+  EXPECT_EQ(1, incremental_conf.catalog.tables.count("users"));
+
+  // Editing an applied migration invalidates the cached states after it
+  WriteFile(directory + "/V2__accounts.sql",
+            "CREATE TABLE Accounts (account_id SERIAL PRIMARY KEY, email TEXT);\n");
+
+  Configuration edited_conf;
+  edited_conf.migration_dir = directory;
+  edited_conf.cache_dir = directory + "/.sqlcheck-cache";
+
+  EXPECT_EQ(3, CheckMigrations(edited_conf));
+
+  // Indexes created by cached migrations count towards the index limit
+  std::string indexes =
+      "CREATE INDEX bugs_hours ON Bugs (hours);\n"
+      "CREATE INDEX bugs_hours_id ON Bugs (hours, bug_id);\n"
+      "CREATE INDEX bugs_id_hours ON Bugs (bug_id, hours);\n"
+      "CREATE INDEX bugs_hours_desc ON Bugs (hours DESC);\n";
+  WriteFile(directory + "/V12__indexes.sql", indexes);
+
+  Configuration index_conf;
+  index_conf.migration_dir = directory;
+  index_conf.cache_dir = directory + "/.sqlcheck-cache";
+  EXPECT_EQ(1, CheckMigrations(index_conf));
+  EXPECT_EQ(4, index_conf.catalog.tables["bugs"].indexes.size());
+
+  Configuration plain_conf;
+  std::istringstream plain_input(indexes);
+  CheckStream(plain_conf, plain_input);
+  EXPECT_EQ(plain_conf.checker_stats[RISK_LEVEL_MEDIUM] + 1,
+            index_conf.checker_stats[RISK_LEVEL_MEDIUM]);
+
+}
+TEST(TestSuite, ResultCacheTest) {
+
+  char directory_template[] = "/tmp/sqlcheck_results_XXXXXX";
+  std::string directory = mkdtemp(directory_template);
+  std::string contents = "SELECT * FROM Bugs;\nCREATE TABLE Bugs (hours FLOAT);\n";
+
+  Configuration default_conf;
+  default_conf.cache_dir = directory;
+  std::istringstream first_input(contents);
+  EXPECT_FALSE(CheckCachedStream(default_conf, first_input));
+
+  // Unchanged contents are answered from the cache with the same findings
+  Configuration cached_conf;
+  cached_conf.cache_dir = directory;
+  std::istringstream second_input(contents);
+  EXPECT_TRUE(CheckCachedStream(cached_conf, second_input));
+  EXPECT_EQ(default_conf.checker_stats, cached_conf.checker_stats);
+  EXPECT_LT(0, cached_conf.checker_stats[RISK_LEVEL_ALL]);
+
+  // A different rule configuration is checked again
+  Configuration risk_conf;
+  risk_conf.cache_dir = directory;
+  risk_conf.risk_level = RISK_LEVEL_HIGH;
+  EXPECT_NE(ResultCacheKey(default_conf, contents), ResultCacheKey(risk_conf, contents));
+  std::istringstream third_input(contents);
+  EXPECT_FALSE(CheckCachedStream(risk_conf, third_input));
+
+  // Replaying a warm cache stops at the first fail-fast finding
+  Configuration fail_fast_conf;
+  fail_fast_conf.cache_dir = directory;
+  fail_fast_conf.print_findings = false;
+  fail_fast_conf.fail_fast = true;
+  fail_fast_conf.fail_fast_level = RISK_LEVEL_HIGH;
+  std::istringstream fourth_input(contents + contents);
+  EXPECT_FALSE(CheckCachedStream(default_conf, fourth_input));
+  std::istringstream fifth_input(contents + contents);
+  EXPECT_TRUE(CheckCachedStream(fail_fast_conf, fifth_input));
+  EXPECT_TRUE(fail_fast_conf.cancelled);
+  EXPECT_EQ(1, fail_fast_conf.checker_stats[RISK_LEVEL_HIGH]);
+
+  // Sampled checks keep their estimates on a cache miss and on a hit
+  std::string log;
+  for(int itr = 0; itr < 200; itr++){
+    log += (itr % 4 == 0) ? "SELECT * FROM Bugs;\n" : "SELECT bug_id FROM Bugs;\n";
+  }
+  Configuration sampled_conf;
+  sampled_conf.cache_dir = directory;
+  sampled_conf.print_findings = false;
+  sampled_conf.sample_rate = 0.5;
+  std::istringstream sampled_input(log);
+  EXPECT_FALSE(CheckCachedStream(sampled_conf, sampled_input));
+  EXPECT_EQ(200, sampled_conf.scanned_statements);
+  EXPECT_LT(0, sampled_conf.sampled_statements);
+
+  Configuration cached_sampled_conf;
+  cached_sampled_conf.cache_dir = directory;
+  cached_sampled_conf.print_findings = false;
+  cached_sampled_conf.sample_rate = 0.5;
+  std::istringstream cached_sampled_input(log);
+  EXPECT_TRUE(CheckCachedStream(cached_sampled_conf, cached_sampled_input));
+  EXPECT_EQ(sampled_conf.scanned_statements, cached_sampled_conf.scanned_statements);
+  EXPECT_EQ(sampled_conf.sampled_statements, cached_sampled_conf.sampled_statements);
+  EXPECT_EQ(sampled_conf.sampled_squares, cached_sampled_conf.sampled_squares);
+  EXPECT_EQ(sampled_conf.checker_stats, cached_sampled_conf.checker_stats);
+
+}
+
+TEST(TestSuite, ChangedStatementsTest) {
+
+  std::istringstream diff(
+      "diff --git a/schema.sql b/schema.sql\n"
+      "@@ -4 +4,2 @@ CREATE TABLE Bugs\n"
+      "-SELECT * FROM Bugs;\n"
+      "+SELECT * FROM Bugs\n"
+      "+WHERE bug_id = 1;\n"
+      "@@ -9,2 +10,0 @@\n");
+
+  auto changes = ParseDiffHunks(diff);
+  ASSERT_EQ(2, changes.size());
+  EXPECT_EQ(4, changes[0].first);
+  EXPECT_EQ(5, changes[0].last);
+  EXPECT_EQ(10, changes[1].first);
+  EXPECT_EQ(11, changes[1].last);
+
+  // Only the changed SELECT is checked, and plain checks keep no catalog
+  Configuration default_conf;
+  std::istringstream input(
+      "CREATE TABLE Bugs (hours FLOAT);\n"
+      "\n"
+      "SELECT * FROM Accounts;\n"
+      "SELECT * FROM Bugs\n"
+      "WHERE bug_id = 1;\n"
+      "CREATE TABLE Accounts (account_id INT);\n");
+
+  CheckChangedStream(default_conf, input, changes);
+
+  EXPECT_EQ(1, default_conf.checker_stats[RISK_LEVEL_ALL]);
+  EXPECT_TRUE(default_conf.catalog.tables.empty());
+
+  // Changed lines come from git, where the revision is never an option
+  char directory_template[] = "/tmp/sqlcheck_changes_XXXXXX";
+  std::string directory = mkdtemp(directory_template);
+  char working_directory[4096];
+  ASSERT_NE(nullptr, getcwd(working_directory, sizeof(working_directory)));
+  ASSERT_EQ(0, chdir(directory.c_str()));
+  WriteFile("schema.sql", "SELECT 1;\nSELECT 2;\n");
+  ASSERT_EQ(0, std::system("git init -q . && git add schema.sql && "
+                           "git -c user.name=test -c user.email=test@example.com "
+                           "commit -q -m init"));
+  WriteFile("schema.sql", "SELECT 1;\nSELECT 3;\n");
+
+  auto lines = ChangedLines("HEAD", "schema.sql");
+  ASSERT_EQ(1, lines.size());
+  EXPECT_EQ(2, lines[0].first);
+  EXPECT_THROW(ChangedLines("--output=leak.txt", "schema.sql"), std::runtime_error);
+  EXPECT_NE(0, access("leak.txt", F_OK));
+  ASSERT_EQ(0, chdir(working_directory));
+
+}
+
+TEST(TestSuite, WatchedFileTest) {
+
+  Configuration default_conf;
+  WatchedFile file;
+
+  std::istringstream first_input("SELECT * FROM Bugs;\nSELECT bug_id FROM Bugs;\n");
+  auto delta = UpdateWatchedFile(default_conf, first_input, file);
+  EXPECT_EQ(1, delta.new_findings);
+  EXPECT_EQ(0, delta.resolved_findings);
+  EXPECT_EQ(2, file.statements.size());
+
+  // Only the edited statement is checked again
+  std::istringstream second_input("SELECT * FROM Bugs;\nSELECT bug_id FROM Bugs ORDER BY RAND();\n");
+  delta = UpdateWatchedFile(default_conf, second_input, file);
+  EXPECT_EQ(1, delta.new_findings);
+  EXPECT_EQ(0, delta.resolved_findings);
+  EXPECT_EQ(2, default_conf.checker_stats[RISK_LEVEL_ALL]);
+
+  std::istringstream third_input("SELECT bug_id FROM Bugs;\n");
+  delta = UpdateWatchedFile(default_conf, third_input, file);
+  EXPECT_EQ(0, delta.new_findings);
+  EXPECT_EQ(2, delta.resolved_findings);
+  EXPECT_EQ(1, file.statements.size());
+
+  // Copies of a statement are counted, added and removed one by one
+  std::istringstream fourth_input("SELECT * FROM Bugs;\nSELECT * FROM Bugs;\n");
+  delta = UpdateWatchedFile(default_conf, fourth_input, file);
+  EXPECT_EQ(2, delta.new_findings);
+  EXPECT_EQ(0, delta.resolved_findings);
+
+  std::istringstream fifth_input("SELECT * FROM Bugs;\n");
+  delta = UpdateWatchedFile(default_conf, fifth_input, file);
+  EXPECT_EQ(0, delta.new_findings);
+  EXPECT_EQ(1, delta.resolved_findings);
+
+}
+
+TEST(TestSuite, CheckpointTest) {
+
+  std::stringstream first_half, second_half;
+  for(int itr = 0; itr < 20; itr++){
+    first_half << "SELECT * FROM Bugs WHERE bug_id = " << itr << ";\n";
+    first_half << "SELECT bug_id FROM Table" << itr % 3 << ";\n";
+    second_half << "SELECT * FROM Accounts GROUP BY account_id;\n";
+    second_half << "SELECT bug_id FROM Table" << itr << ";\n";
+  }
+  auto log = first_half.str() + second_half.str();
+
+  Configuration full_conf;
+  full_conf.log_mode = true;
+  full_conf.top_k = 2;
+  std::istringstream full_input(log);
+  CheckStream(full_conf, full_input);
+
+  // Interrupted after the first half
+  Configuration partial_conf;
+  partial_conf.log_mode = true;
+  partial_conf.top_k = 2;
+  std::istringstream partial_input(first_half.str());
+  CheckStream(partial_conf, partial_input);
+
+  char directory_template[] = "/tmp/sqlcheck_checkpoint_XXXXXX";
+  std::string checkpoint_file = std::string(mkdtemp(directory_template)) + "/checkpoint";
+  {
+    std::ofstream output(checkpoint_file.c_str());
+    SaveCheckpoint(partial_conf, output, first_half.str().size(), ";",
+                   HashString(first_half.str()));
+  }
+
+  Configuration resumed_conf;
+  resumed_conf.log_mode = true;
+  resumed_conf.top_k = 2;
+  resumed_conf.checkpoint_file = checkpoint_file;
+  resumed_conf.resume = true;
+  std::istringstream resumed_input(log);
+  CheckStreamWithCheckpoints(resumed_conf, resumed_input);
+
+  EXPECT_EQ(full_conf.checker_stats, resumed_conf.checker_stats);
+  EXPECT_EQ(full_conf.executions, resumed_conf.executions);
+  EXPECT_EQ(full_conf.query_stats.size(), resumed_conf.query_stats.size());
+  EXPECT_EQ(full_conf.pattern_ranks[PATTERN_ID_GROUP_BY_USAGE].executions,
+            resumed_conf.pattern_ranks[PATTERN_ID_GROUP_BY_USAGE].executions);
+  EXPECT_EQ(full_conf.query_shapes.Estimate(), resumed_conf.query_shapes.Estimate());
+
+  auto full_top = full_conf.query_sketch.Top(2);
+  auto resumed_top = resumed_conf.query_sketch.Top(2);
+  ASSERT_EQ(full_top.size(), resumed_top.size());
+  for(size_t itr = 0; itr < full_top.size(); itr++){
+    EXPECT_EQ(full_top[itr].key, resumed_top[itr].key);
+    EXPECT_EQ(full_top[itr].count, resumed_top[itr].count);
+  }
+
+  // A finished check removes its checkpoint
+  std::ifstream checkpoint(checkpoint_file.c_str());
+  EXPECT_FALSE(checkpoint.good());
+
+  // A checkpoint of another configuration is rejected
+  {
+    std::ofstream output(checkpoint_file.c_str());
+    SaveCheckpoint(partial_conf, output, first_half.str().size(), ";",
+                   HashString(first_half.str()));
+  }
+  Configuration other_conf;
+  other_conf.checkpoint_file = checkpoint_file;
+  other_conf.resume = true;
+  std::istringstream other_input(log);
+  EXPECT_THROW(CheckStreamWithCheckpoints(other_conf, other_input), std::runtime_error);
+
+  // Statements after the first one on a line, and the delimiter changed
+  // before them, survive a fail-fast stop and resume
+  std::string line_log =
+      "SELECT * FROM a; SELECT * FROM b; SELECT * FROM c;\n"
+      "DELIMITER //\n"
+      "SELECT * FROM d// SELECT * FROM e//";
+  unsigned long long high_findings = 0;
+  for(int run = 0; run < 6; run++){
+    Configuration line_conf;
+    line_conf.print_findings = false;
+    line_conf.fail_fast = true;
+    line_conf.fail_fast_level = RISK_LEVEL_HIGH;
+    line_conf.checkpoint_file = checkpoint_file;
+    line_conf.checkpoint_interval = 0;
+    line_conf.resume = (run != 0);
+    std::istringstream line_input(line_log);
+    CheckStreamWithCheckpoints(line_conf, line_input);
+    high_findings = line_conf.checker_stats[RISK_LEVEL_HIGH];
+    if(line_conf.cancelled == false){
+      break;
+    }
+  }
+  EXPECT_EQ(5, high_findings);
+
+  // The keys of a baseline being written survive a resume
+  Configuration baseline_full_conf;
+  baseline_full_conf.print_findings = false;
+  baseline_full_conf.write_baseline = true;
+  std::istringstream baseline_full_input(line_log);
+  CheckStream(baseline_full_conf, baseline_full_input);
+
+  std::vector<uint64_t> baseline_keys;
+  for(int run = 0; run < 6; run++){
+    Configuration baseline_conf;
+    baseline_conf.print_findings = false;
+    baseline_conf.write_baseline = true;
+    baseline_conf.fail_fast = true;
+    baseline_conf.fail_fast_level = RISK_LEVEL_HIGH;
+    baseline_conf.checkpoint_file = checkpoint_file;
+    baseline_conf.checkpoint_interval = 0;
+    baseline_conf.resume = (run != 0);
+    std::istringstream baseline_input(line_log);
+    CheckStreamWithCheckpoints(baseline_conf, baseline_input);
+    baseline_keys = baseline_conf.baseline_keys;
+    if(baseline_conf.cancelled == false){
+      break;
+    }
+  }
+  EXPECT_EQ(baseline_full_conf.baseline_keys, baseline_keys);
+
+  // A resumed check continues the metrics file without gaps or repeats
+  auto read_file = [](const std::string& file_name){
+    std::ifstream file(file_name.c_str());
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+  };
+
+  Configuration metrics_full_conf;
+  metrics_full_conf.print_findings = false;
+  metrics_full_conf.metrics.Open(checkpoint_file + ".full.ndjson");
+  std::istringstream metrics_full_input(line_log);
+  CheckStream(metrics_full_conf, metrics_full_input);
+  metrics_full_conf.metrics.Close();
+
+  for(int run = 0; run < 6; run++){
+    Configuration metrics_conf;
+    metrics_conf.print_findings = false;
+    metrics_conf.fail_fast = true;
+    metrics_conf.fail_fast_level = RISK_LEVEL_HIGH;
+    metrics_conf.checkpoint_file = checkpoint_file;
+    metrics_conf.checkpoint_interval = 0;
+    metrics_conf.resume = (run != 0);
+    metrics_conf.metrics.Open(checkpoint_file + ".ndjson", metrics_conf.resume);
+    std::istringstream metrics_input(line_log);
+    CheckStreamWithCheckpoints(metrics_conf, metrics_input);
+    metrics_conf.metrics.Close();
+    if(metrics_conf.cancelled == false){
+      break;
+    }
+  }
+  EXPECT_EQ(read_file(checkpoint_file + ".full.ndjson"),
+            read_file(checkpoint_file + ".ndjson"));
+
+}
+
+TEST(TestSuite, BaselineTest) {
+
+  char directory_template[] = "/tmp/sqlcheck_baseline_XXXXXX";
+  std::string baseline_file = std::string(mkdtemp(directory_template)) + "/baseline";
+
+  std::string accepted = "SELECT * FROM Bugs ORDER BY RAND();\n";
+
+  Configuration write_conf;
+  write_conf.baseline_file = baseline_file;
+  write_conf.write_baseline = true;
+  std::istringstream write_input(accepted);
+  CheckStream(write_conf, write_input);
+  EXPECT_EQ(2, write_conf.baseline_keys.size());
+  Baseline::Write(baseline_file, write_conf.baseline_keys);
+
+  // Only the findings of the new statement are reported
+  Configuration default_conf;
+  default_conf.baseline_file = baseline_file;
+  default_conf.baseline.Open(baseline_file);
+  std::istringstream input(accepted + "SELECT * FROM Accounts;\n");
+  CheckStream(default_conf, input);
+
+  EXPECT_EQ(1, default_conf.checker_stats[RISK_LEVEL_ALL]);
+  EXPECT_EQ(2, default_conf.baselined_findings);
+
+  // Reopening replaces the mapping; the contents are hashed in place
+  std::ifstream baseline_input(baseline_file.c_str(), std::ios::binary);
+  std::string contents((std::istreambuf_iterator<char>(baseline_input)),
+                       std::istreambuf_iterator<char>());
+  Baseline baseline;
+  baseline.Open(baseline_file);
+  baseline.Open(baseline_file);
+  EXPECT_EQ(HashString(contents), baseline.ContentHash());
+  EXPECT_TRUE(baseline.Contains(write_conf.baseline_keys[0]));
+
+  EXPECT_THROW(baseline.Open(baseline_file + ".missing"), std::runtime_error);
+  EXPECT_EQ(0, baseline.ContentHash());
+  EXPECT_FALSE(baseline.Contains(write_conf.baseline_keys[0]));
+
+  // A slot count whose size overflows is rejected
+  uint64_t slot_count = 1ULL << 61;
+  std::string header = contents.substr(0, 2 * sizeof(uint64_t)) +
+      std::string(reinterpret_cast<const char*>(&slot_count), sizeof(slot_count));
+  WriteFile(baseline_file + ".overflow", header);
+  EXPECT_THROW(baseline.Open(baseline_file + ".overflow"), std::runtime_error);
+  EXPECT_FALSE(baseline.Contains(write_conf.baseline_keys[0]));
+
+}
+
+TEST(TestSuite, MetricsTest) {
+
+  char directory_template[] = "/tmp/sqlcheck_metrics_XXXXXX";
+  std::string metrics_file = std::string(mkdtemp(directory_template)) + "/metrics.ndjson";
+
+  Configuration default_conf;
+  default_conf.print_findings = false;
+  default_conf.metrics.Open(metrics_file);
+  std::istringstream input(
+      "SELECT DISTINCT a FROM t JOIN u ON t.x = u.x, v "
+      "WHERE a IN (1, 2, 3) OR b LIKE 'x%' ORDER BY a;\n"
+      "SELECT a FROM t WHERE EXISTS (SELECT 1 FROM u WHERE u.x = t.x) GROUP BY a;\n");
+  CheckStream(default_conf, input);
+
+  auto& metrics = default_conf.statement_metrics;
+  EXPECT_EQ(1, metrics.subquery_depth);
+  EXPECT_EQ(1, metrics.correlated_subqueries);
+  EXPECT_EQ(2, metrics.predicates);
+  EXPECT_TRUE(metrics.group_by);
+  EXPECT_FALSE(metrics.distinct);
+  default_conf.metrics.Close();
+
+  std::ifstream output(metrics_file);
+  std::string line;
+  ASSERT_TRUE(std::getline(output, line));
+  EXPECT_NE(std::string::npos, line.find("\"tables\":3,\"joins\":2,"));
+  EXPECT_NE(std::string::npos, line.find("\"predicates\":3,\"ors\":1,\"in_list\":3,"
+                                         "\"distinct\":true,\"group_by\":false,\"order_by\":true}"));
+  ASSERT_TRUE(std::getline(output, line));
+  EXPECT_EQ(0, line.find("{\"statement\":2,"));
+  EXPECT_FALSE(std::getline(output, line));
+
+}
+
+QueryStats MakeQueryStats(const unsigned long long executions,
+                          const std::string& query,
+                          const std::vector<PatternId>& pattern_ids){
+  QueryStats query_stats;
+  query_stats.executions = executions;
+  query_stats.query = query;
+  query_stats.pattern_ids = pattern_ids;
+  return query_stats;
+}
+
+TEST(TestSuite, CompareTest) {
+
+  std::unordered_map<uint64_t, QueryStats> before;
+  std::unordered_map<uint64_t, QueryStats> after;
+
+  before[1] = MakeQueryStats(10, "select * from bugs", {PATTERN_ID_SELECT_STAR});
+  before[2] = MakeQueryStats(10, "select a from b group by a", {PATTERN_ID_GROUP_BY_USAGE});
+  before[3] = MakeQueryStats(80, "select a from b", {});
+
+  after[1] = MakeQueryStats(50, "select * from bugs", {PATTERN_ID_SELECT_STAR});
+  after[3] = MakeQueryStats(140, "select a from b", {});
+  after[4] = MakeQueryStats(10, "select * from accounts", {PATTERN_ID_SELECT_STAR});
+
+  auto comparison = CompareQueryStats(before, after);
+
+  EXPECT_EQ(100, comparison.before_executions);
+  EXPECT_EQ(200, comparison.after_executions);
+
+  ASSERT_EQ(1, comparison.new_findings.size());
+  EXPECT_EQ(4, comparison.new_findings[0].fingerprint);
+  ASSERT_EQ(1, comparison.fixed_findings.size());
+  EXPECT_EQ(PATTERN_ID_GROUP_BY_USAGE, comparison.fixed_findings[0].pattern_id);
+
+  // 10% of the executions before, 25% after
+  ASSERT_EQ(1, comparison.changed_findings.size());
+  EXPECT_EQ(10, comparison.changed_findings[0].before);
+  EXPECT_EQ(50, comparison.changed_findings[0].after);
+
+}
+
+TEST(TestSuite, SamplingTest) {
+
+  std::stringstream log;
+  for(int itr = 0; itr < 10000; itr++){
+    log << "SELECT " << (itr % 4 == 0 ? "*" : "bug_id") << " FROM Bugs WHERE bug_id = " << itr << ";\n";
+  }
+
+  // Bernoulli sampling
+  Configuration bernoulli_conf;
+  bernoulli_conf.sample_rate = 0.1;
+  std::istringstream bernoulli_input(log.str());
+  StatementSplitter bernoulli_splitter(bernoulli_conf, bernoulli_input);
+  bernoulli_splitter.SetSampling(bernoulli_conf.sample_rate, bernoulli_conf.reservoir_size);
+  std::string sql_statement;
+  size_t sampled = 0;
+  while(bernoulli_splitter.Next(sql_statement)){
+    sampled++;
+  }
+  EXPECT_EQ(10000, bernoulli_splitter.Statements());
+  EXPECT_NEAR(1000, sampled, 150);
+
+  // Reservoir sampling returns exactly N statements in input order
+  Configuration reservoir_conf;
+  reservoir_conf.reservoir_size = 400;
+  reservoir_conf.print_findings = false;
+  std::istringstream reservoir_input(log.str());
+  CheckStream(reservoir_conf, reservoir_input);
+
+  EXPECT_EQ(10000, reservoir_conf.scanned_statements);
+  EXPECT_EQ(400, reservoir_conf.sampled_statements);
+  EXPECT_NEAR(100, reservoir_conf.checker_stats[RISK_LEVEL_HIGH], 40);
+
+}
+
+TEST(TestSuite, TimeBudgetTest) {
+
+  EXPECT_DOUBLE_EQ(30, ParseDuration("30s"));
+  EXPECT_DOUBLE_EQ(0.5, ParseDuration("500ms"));
+  EXPECT_DOUBLE_EQ(120, ParseDuration("2m"));
+  EXPECT_THROW(ParseDuration("soon"), std::invalid_argument);
+
+  // Statements spanning several lines and range boundaries
+  std::stringstream log;
+  for(int itr = 0; itr < 3000; itr++){
+    if(itr % 3 == 0){
+      log << "SELECT *\nFROM Bugs\nWHERE bug_id = " << itr << ";\n";
+    }
+    else {
+      log << "SELECT bug_id FROM Bugs WHERE bug_id = " << itr << "; -- " << itr << "\n";
+    }
+  }
+
+  Configuration full_conf;
+  full_conf.print_findings = false;
+  std::istringstream full_input(log.str());
+  CheckStream(full_conf, full_input);
+
+  // With enough time every statement is checked exactly once
+  Configuration budget_conf;
+  budget_conf.print_findings = false;
+  budget_conf.time_budget = 60;
+  std::istringstream budget_input(log.str());
+  CheckWithTimeBudget(budget_conf, budget_input);
+
+  EXPECT_LT(1, budget_conf.total_ranges);
+  EXPECT_EQ(budget_conf.total_ranges, budget_conf.covered_ranges);
+  EXPECT_EQ(budget_conf.total_bytes, budget_conf.covered_bytes);
+  EXPECT_EQ(1000, budget_conf.checker_stats[RISK_LEVEL_HIGH]);
+  EXPECT_EQ(full_conf.checker_stats, budget_conf.checker_stats);
+
+  // Several statements on a line, some ending in a line comment or
+  // continued on the next line
+  std::stringstream line_log;
+  for(int itr = 0; itr < 3000; itr++){
+    line_log << "SELECT * FROM a" << itr << "; SELECT * FROM b" << itr << ";";
+    if(itr % 7 == 0){
+      line_log << " -- " << itr << "\n";
+    }
+    else if(itr % 5 == 0){
+      line_log << " SELECT bug_id\nFROM Bugs;\n";
+    }
+    else {
+      line_log << "\n";
+    }
+  }
+
+  Configuration line_full_conf;
+  line_full_conf.print_findings = false;
+  std::istringstream line_full_input(line_log.str());
+  CheckStream(line_full_conf, line_full_input);
+
+  Configuration line_budget_conf;
+  line_budget_conf.print_findings = false;
+  line_budget_conf.time_budget = 60;
+  std::istringstream line_budget_input(line_log.str());
+  CheckWithTimeBudget(line_budget_conf, line_budget_input);
+
+  EXPECT_EQ(line_budget_conf.total_bytes, line_budget_conf.covered_bytes);
+  EXPECT_EQ(6000, line_budget_conf.checker_stats[RISK_LEVEL_HIGH]);
+  EXPECT_EQ(line_full_conf.checker_stats, line_budget_conf.checker_stats);
+
+  // An exhausted budget still reports the partial coverage of a range
+  Configuration short_conf;
+  short_conf.print_findings = false;
+  short_conf.time_budget = 1e-9;
+  std::istringstream short_input(line_log.str());
+  CheckWithTimeBudget(short_conf, short_input);
+
+  EXPECT_EQ(0, short_conf.covered_ranges);
+  EXPECT_LT(0, short_conf.covered_bytes);
+  EXPECT_EQ(1, short_conf.checker_stats[RISK_LEVEL_HIGH]);
+
+}
+
+TEST(TestSuite, FailFastTest) {
+
+  Configuration default_conf;
+  default_conf.fail_fast = true;
+  default_conf.fail_fast_level = RISK_LEVEL_HIGH;
+  default_conf.print_findings = false;
+
+  std::istringstream input(
+      "CREATE TABLE Bugs (hours FLOAT);\n"
+      "SELECT * FROM Bugs;\n"
+      "SELECT * FROM Accounts;\n");
+  CheckStream(default_conf, input);
+
+  // The medium risk findings (float, no primary or foreign key) do not
+  // stop the check, the high risk one does
+  EXPECT_TRUE(default_conf.cancelled);
+  EXPECT_EQ(3, default_conf.checker_stats[RISK_LEVEL_MEDIUM]);
+  EXPECT_EQ(1, default_conf.checker_stats[RISK_LEVEL_HIGH]);
+
+}
+
+TEST(TestSuite, ProgressTest) {
+
+  std::string log = "SELECT * FROM Bugs;\n\nSELECT bug_id\nFROM Bugs;\n";
+
+  Configuration default_conf;
+  default_conf.print_findings = false;
+  {
+    ProgressReporter progress(default_conf, log.size());
+    std::istringstream input(log);
+    CheckStream(default_conf, input);
+  }
+
+  EXPECT_EQ(log.size(), default_conf.progress_bytes);
+  EXPECT_EQ(2, default_conf.progress_statements);
+  EXPECT_EQ(1, default_conf.progress_findings);
+
+}
+
+TEST(TestSuite, LexerTest) {
+
+  std::string statement =
+      "SELECT \"Order\", 'it''s -- not a comment' FROM t /* skipped */ "
+      "WHERE x >= 1.5e3 || :name -- trailing\n;";
+
+  std::vector<Token> tokens;
+  Tokenize(statement, tokens);
+
+  std::vector<std::string> texts;
+  for(auto& token : tokens){
+    texts.push_back(TokenText(statement, token));
+  }
+  std::vector<std::string> expected = {
+    "SELECT", "\"Order\"", ",", "'it''s -- not a comment'", "FROM", "t",
+    "WHERE", "x", ">=", "1.5e3", "||", ":name", ";"
+  };
+  EXPECT_EQ(expected, texts);
+
+  ASSERT_EQ(expected.size(), tokens.size());
+  EXPECT_EQ(KEYWORD_SELECT, tokens[0].keyword);
+  EXPECT_EQ(TOKEN_KIND_QUOTED_IDENTIFIER, tokens[1].kind);
+  EXPECT_EQ(TOKEN_KIND_STRING, tokens[3].kind);
+  EXPECT_EQ(TOKEN_KIND_IDENTIFIER, tokens[5].kind);
+  EXPECT_EQ(TOKEN_KIND_NUMBER, tokens[9].kind);
+  EXPECT_EQ(TOKEN_KIND_OPERATOR, tokens[10].kind);
+  EXPECT_EQ(TOKEN_KIND_PARAMETER, tokens[11].kind);
+
+  EXPECT_EQ(KEYWORD_UNION, LookupKeyword("Union", 5));
+  EXPECT_EQ(KEYWORD_NONE, LookupKeyword("labor_union", 11));
+  EXPECT_EQ(KEYWORD_NONE, LookupKeyword("unio_", 5));
+  EXPECT_EQ(KEYWORD_NONE, LookupKeyword("u", 1));
+
+  // Every keyword of the perfect hash table, in upper case
+  size_t keywords = 0;
+  for(auto& entry : KEYWORD_HASH_TABLE){
+    if(entry.keyword == KEYWORD_NONE){
+      continue;
+    }
+    std::string word = entry.word;
+    for(auto& c : word){
+      c = c - 'a' + 'A';
+    }
+    EXPECT_EQ(entry.keyword, LookupKeyword(word.data(), word.size())) << word;
+    keywords++;
+  }
+  EXPECT_EQ(KEYWORD_WITH, keywords);
+
+}
+
+TEST(TestSuite, TokenRulesTest) {
+
+  Configuration default_conf;
+  default_conf.risk_level = RISK_LEVEL_ALL;
+  default_conf.print_findings = false;
+
+  // Keywords inside names, strings and comments are not matched
+  std::istringstream input(
+      "SELECT nullable_flag, labor_union FROM Members WHERE note = 'or like';\n"
+      "-- SELECT * FROM Members;\n"
+      "SELECT name FROM Members WHERE status IS NULL OR name LIKE 'a%';\n");
+  CheckStream(default_conf, input);
+
+  EXPECT_EQ(3, default_conf.checker_stats[RISK_LEVEL_ALL]);
+  EXPECT_EQ(1, default_conf.checker_stats[RISK_LEVEL_MEDIUM]);
+
+}
+
+std::vector<std::string> SplitStatements(const Dialect dialect,
+                                         const std::string& input){
+  Configuration conf;
+  conf.dialect = dialect;
+  std::istringstream stream(input);
+  StatementSplitter splitter(conf, stream);
+  std::vector<std::string> statements;
+  std::string sql_statement;
+  while(splitter.Next(sql_statement)){
+    statements.push_back(sql_statement);
+  }
+  return statements;
+}
+
+TEST(TestSuite, DialectTest) {
+
+  // Delimiters inside quotes and comments do not end statements
+  auto statements = SplitStatements(DIALECT_MYSQL,
+      "SELECT `a;b` FROM t # no; split\n"
+      "WHERE c = 'it\\'s; fine'; SELECT 2;\n");
+  ASSERT_EQ(2, statements.size());
+  EXPECT_EQ("SELECT 2; ", statements[1]);
+
+  statements = SplitStatements(DIALECT_POSTGRESQL,
+      "CREATE FUNCTION f() RETURNS int AS $body$\n"
+      "BEGIN RETURN 1; END;\n"
+      "$body$ LANGUAGE plpgsql;\n"
+      "SELECT E'a\\';b' /* nested /* ; */ ; */;\n");
+  ASSERT_EQ(2, statements.size());
+
+  statements = SplitStatements(DIALECT_SQLSERVER,
+      "SELECT [a;b] FROM t\n"
+      "GO\n"
+      "go 2\n"
+      "SELECT 1\n"
+      "GO\n");
+  ASSERT_EQ(2, statements.size());
+  EXPECT_EQ("SELECT [a;b] FROM t ", statements[0]);
+
+  // Lexer tables
+  std::string statement = "select [a b], `c`, e'\\'', $x$ ; $x$ from t # comment";
+  std::vector<Token> tokens;
+  Tokenize(statement, tokens, DIALECT_SQLSERVER);
+  EXPECT_EQ(TOKEN_KIND_QUOTED_IDENTIFIER, tokens[1].kind);
+  Tokenize(statement, tokens, DIALECT_POSTGRESQL);
+  EXPECT_EQ("e'\\''", TokenText(statement, tokens[10]));
+  EXPECT_EQ("$x$ ; $x$", TokenText(statement, tokens[12]));
+  Tokenize(statement, tokens, DIALECT_MYSQL);
+  EXPECT_EQ(KEYWORD_FROM, tokens.end()[-2].keyword);
+
+  Dialect dialect;
+  EXPECT_TRUE(ParseDialect("sqlite", dialect));
+  EXPECT_EQ(DIALECT_SQLITE, dialect);
+  EXPECT_FALSE(ParseDialect("oracle", dialect));
+
+}
+
+TEST(TestSuite, RoutineTest) {
+
+  // Delimiter directives and routine bodies
+  auto statements = SplitStatements(DIALECT_MYSQL,
+      "DELIMITER //\n"
+      "CREATE PROCEDURE p() BEGIN SELECT 1; END //\n"
+      "delimiter ;\n"
+      "CREATE TRIGGER t AFTER INSERT ON a BEGIN\n"
+      "  IF new.b THEN UPDATE c SET d = CASE WHEN e THEN 1 END; END IF;\n"
+      "  SELECT * FROM f;\n"
+      "END;\n"
+      "SELECT 2;\n");
+  ASSERT_EQ(3, statements.size());
+  EXPECT_EQ("CREATE PROCEDURE p() BEGIN SELECT 1; END // ", statements[0]);
+  EXPECT_EQ("SELECT 2; ", statements[2]);
+
+  // Statements in the body
+  std::vector<Token> tokens;
+  std::vector<Token> body_tokens;
+  std::vector<BodyStatement> body_statements;
+  std::string statement = statements[1];
+  Tokenize(statement, tokens);
+  ASSERT_TRUE(SplitRoutineBody(statement, tokens, DIALECT_GENERIC,
+                               body_tokens, body_statements));
+  ASSERT_EQ(2, body_statements.size());
+  EXPECT_EQ("UPDATE c SET d = CASE WHEN e THEN 1 END",
+            TokenText(statement, body_tokens[body_statements[0].first],
+                      body_tokens[body_statements[0].last - 1]));
+  EXPECT_EQ("SELECT * FROM f",
+            TokenText(statement, body_tokens[body_statements[1].first],
+                      body_tokens[body_statements[1].last - 1]));
+
+  statement = "create function g() returns int as $$ begin "
+      "delete from h; return 1; end; $$ language plpgsql;";
+  Tokenize(statement, tokens, DIALECT_POSTGRESQL);
+  ASSERT_TRUE(SplitRoutineBody(statement, tokens, DIALECT_POSTGRESQL,
+                               body_tokens, body_statements));
+  ASSERT_EQ(1, body_statements.size());
+  EXPECT_EQ(KEYWORD_DELETE, body_tokens[body_statements[0].first].keyword);
+
+  Tokenize("select 1;", tokens);
+  EXPECT_FALSE(SplitRoutineBody("select 1;", tokens, DIALECT_GENERIC,
+                                body_tokens, body_statements));
+
+  // Each body statement is checked on its own
+  Configuration default_conf;
+  default_conf.testing_mode = true;
+
+  std::unique_ptr<std::istringstream> stream(new std::istringstream());
+  stream->str(
+      "CREATE PROCEDURE p() BEGIN SELECT * FROM a; SELECT * FROM b; END;"
+  );
+
+  default_conf.test_stream.reset(stream.release());
+
+  Check(default_conf);
+  EXPECT_EQ(2, default_conf.checker_stats[RISK_LEVEL_HIGH]);
+
+}
+
+TEST(TestSuite, ParserTest) {
+
+  std::string statement =
+      "with t as (select a from b) "
+      "select distinct x.a, count(*) n from t x join c on x.a = c.a, d "
+      "where x.a in (select a from e) group by x.a order by n desc";
+  std::vector<Token> tokens;
+  Tokenize(statement, tokens);
+
+  Arena arena(256);
+  auto tree = Parse(statement, tokens, arena);
+  ASSERT_EQ(NODE_KIND_WITH, tree->kind);
+  EXPECT_EQ(nullptr, tree->next);
+  EXPECT_EQ(NODE_KIND_CTE, tree->child->kind);
+
+  auto query = tree->child->next;
+  ASSERT_EQ(NODE_KIND_QUERY, query->kind);
+  EXPECT_EQ(KEYWORD_DISTINCT, query->keyword);
+  EXPECT_EQ(tokens.size() - 1, query->last);
+
+  auto select_list = FindChild(query, NODE_KIND_SELECT_LIST);
+  ASSERT_NE(nullptr, select_list);
+  EXPECT_EQ(NODE_KIND_COLUMN, select_list->child->kind);
+  EXPECT_EQ(NODE_KIND_ALIAS, select_list->child->next->kind);
+  EXPECT_EQ(NODE_KIND_FUNCTION, select_list->child->next->child->kind);
+
+  // One explicit join and one comma-separated table
+  auto from = FindChild(query, NODE_KIND_FROM);
+  ASSERT_NE(nullptr, from);
+  EXPECT_EQ(NODE_KIND_JOIN, from->child->kind);
+  EXPECT_EQ(NODE_KIND_TABLE, from->child->next->kind);
+
+  size_t subqueries = 0;
+  VisitNodes(tree, [&](const Node* node){
+    subqueries += (node->kind == NODE_KIND_SUBQUERY);
+  });
+  EXPECT_EQ(1, subqueries);
+  EXPECT_NE(nullptr, FindChild(query, NODE_KIND_GROUP_BY));
+  EXPECT_NE(nullptr, FindChild(query, NODE_KIND_ORDER_BY));
+
+  // Nodes spill into further blocks and are reused after a reset
+  arena.Reset();
+  tree = Parse(statement, tokens, arena);
+  EXPECT_EQ(NODE_KIND_WITH, tree->kind);
+
+  // Unsupported syntax is skipped
+  statement = "create table t (a int primary key, b int references u) engine = x;";
+  Tokenize(statement, tokens);
+  tree = Parse(statement, tokens, arena);
+  ASSERT_EQ(NODE_KIND_CREATE_TABLE, tree->kind);
+  EXPECT_EQ(NODE_KIND_COLUMN_DEFINITION, tree->child->next->kind);
+  EXPECT_EQ(KEYWORD_PRIMARY, tree->child->next->child->keyword);
+  EXPECT_EQ(KEYWORD_REFERENCES, tree->child->next->next->child->keyword);
+
+  // Subquery depth and correlation; parentheses in literals do not count
+  SubqueryInfo subquery_info;
+  statement = "select a from (select a from (select a, '((' from t) x) y "
+      "where exists (select 1 from u where u.a = y.a and u.b = '(');";
+  Tokenize(statement, tokens);
+  tree = Parse(statement, tokens, arena);
+  AnalyzeSubqueries(statement, tokens, tree, subquery_info);
+  EXPECT_EQ(2, subquery_info.max_depth);
+  ASSERT_EQ(1, subquery_info.correlated.size());
+  EXPECT_EQ(NODE_KIND_SUBQUERY, subquery_info.correlated[0]->kind);
+  EXPECT_EQ("(select 1", TokenText(statement, tokens[subquery_info.correlated[0]->first],
+                                   tokens[subquery_info.correlated[0]->child->first + 1]));
+
+  statement = "select a from t where b in (select b from u where u.c = 1);";
+  Tokenize(statement, tokens);
+  tree = Parse(statement, tokens, arena);
+  AnalyzeSubqueries(statement, tokens, tree, subquery_info);
+  EXPECT_EQ(1, subquery_info.max_depth);
+  EXPECT_TRUE(subquery_info.correlated.empty());
+
+}
+
+TEST(TestSuite, StructuralRulesTest) {
+
+  Configuration default_conf;
+  default_conf.risk_level = RISK_LEVEL_ALL;
+  default_conf.print_findings = false;
+
+  // Unions are not nested, count(*) is not a select star and grouped
+  // columns satisfy the single-value rule
+  std::istringstream input(
+      "SELECT a FROM t1 UNION ALL SELECT a FROM t2 UNION ALL SELECT a FROM t3;\n"
+      "SELECT status, COUNT(*) AS n FROM Bugs GROUP BY status;\n"
+      "SELECT b.status, UPPER(b.status), MAX(b.hours) FROM Bugs b GROUP BY status;\n"
+      "SELECT a FROM t WHERE note = 'pick one or the other' /* select * or */;\n"
+      "/* " + std::string(600, '-') + " */ INSERT INTO t (a) VALUES ('" +
+      std::string(600, 'x') + "');\n");
+  CheckStream(default_conf, input);
+
+  EXPECT_EQ(0, default_conf.checker_stats[RISK_LEVEL_ALL]);
+
+  std::istringstream input2(
+      "SELECT status, reported_by FROM Bugs GROUP BY status;\n"
+      "SELECT name FROM Accounts WHERE id IN (SELECT account_id FROM Bugs);\n");
+  CheckStream(default_conf, input2);
+
+  EXPECT_EQ(2, default_conf.checker_stats[RISK_LEVEL_LOW]);
+
+}
+
+TEST(TestSuite, DispatchTest) {
+
+  Arena arena(256);
+  std::vector<Token> tokens;
+  auto classify = [&](const std::string& statement){
+    Tokenize(statement, tokens);
+    Statement parsed = {statement, tokens, Parse(statement, tokens, arena)};
+    return ClassifyStatement(parsed);
+  };
+
+  EXPECT_EQ(STATEMENT_KIND_QUERY, classify("select a from t;"));
+  EXPECT_EQ(STATEMENT_KIND_QUERY, classify("insert into t values (1);"));
+  EXPECT_EQ(STATEMENT_KIND_CREATE_TABLE, classify("create table t (a int);"));
+  EXPECT_EQ(STATEMENT_KIND_ALTER_TABLE, classify("alter table t add b int;"));
+  EXPECT_EQ(STATEMENT_KIND_CREATE_INDEX, classify("create unique index i on t(a);"));
+  EXPECT_EQ(STATEMENT_KIND_OTHER, classify("create table u as select * from t;"));
+  EXPECT_EQ(STATEMENT_KIND_OTHER, classify("select a from t; create table u (a int);"));
+
+  // Queries skip the table rules and tables skip the query rules
+  auto& query_rules = GetRules(STATEMENT_KIND_QUERY);
+  auto& table_rules = GetRules(STATEMENT_KIND_CREATE_TABLE);
+  Rule primary_key = CheckPrimaryKeyExists;
+  Rule select_star = CheckSelectStar;
+  EXPECT_EQ(query_rules.end(), std::find(query_rules.begin(), query_rules.end(), primary_key));
+  EXPECT_NE(query_rules.end(), std::find(query_rules.begin(), query_rules.end(), select_star));
+  EXPECT_NE(table_rules.end(), std::find(table_rules.begin(), table_rules.end(), primary_key));
+  EXPECT_EQ(table_rules.end(), std::find(table_rules.begin(), table_rules.end(), select_star));
+  Rule having = CheckHaving;
+  EXPECT_EQ(table_rules.end(), std::find(table_rules.begin(), table_rules.end(), having));
+  EXPECT_EQ(29, GetRules(STATEMENT_KIND_OTHER).size());
+
+}
+
+TEST(TestSuite, SchemaDiffTest) {
+
+  char directory_template[] = "/tmp/sqlcheck_diff_XXXXXX";
+  std::string directory = mkdtemp(directory_template);
+
+  WriteFile(directory + "/old.sql",
+            "CREATE TABLE Bugs (\n"
+            "bug_id SERIAL PRIMARY KEY,\n"
+            "hours NUMERIC(9,2),\n"
+            "INDEX (hours));\n"
+            "CREATE TABLE Accounts (account_id INT, PRIMARY KEY (account_id));\n"
+            "CREATE TABLE Products (product_id INT PRIMARY KEY);\n");
+  WriteFile(directory + "/new.sql",
+            "CREATE TABLE Bugs (\n"
+            "bug_id SERIAL PRIMARY KEY,\n"
+            "hours FLOAT);\n"
+            "CREATE TABLE Accounts (account_id INT);\n"
+            "CREATE TABLE Products (product_id INT PRIMARY KEY);\n"
+            "CREATE TABLE Tags (tag1 VARCHAR(20), tag2 VARCHAR(20));\n");
+
+  Configuration default_conf;
+  default_conf.diff_old_file_name = directory + "/old.sql";
+  default_conf.diff_new_file_name = directory + "/new.sql";
+
+  auto changes = CheckDiff(default_conf);
+
+  // Tags added, hours modified, index and primary key removed
+  ASSERT_EQ(4, changes.size());
+  std::map<int, int> counts;
+  for(auto& change : changes){
+    counts[change.change_type]++;
+    EXPECT_NE("products", change.table_name);
+  }
+  EXPECT_EQ(1, counts[CHANGE_TYPE_ADDED]);
+  EXPECT_EQ(1, counts[CHANGE_TYPE_MODIFIED]);
+  EXPECT_EQ(2, counts[CHANGE_TYPE_REMOVED]);
+
+  // Only the float column and the new table (tribbles, no primary or
+  // foreign key) are checked; the unchanged generic primary key of bugs is
+  // not reported again
+  EXPECT_EQ(4, default_conf.checker_stats[RISK_LEVEL_MEDIUM]);
+  EXPECT_EQ(0, default_conf.checker_stats[RISK_LEVEL_HIGH]);
+
+  // Dropping one of two identical unnamed constraints is a change
+  Catalog old_catalog, new_catalog;
+  old_catalog.ApplyStatement("create table t (id int, check (id > 0), check (id > 0));");
+  new_catalog.ApplyStatement("create table t (id int, check (id > 0));");
+  ASSERT_EQ(2, old_catalog.tables["t"].constraints.size());
+  changes = DiffCatalogs(old_catalog, new_catalog);
+  ASSERT_EQ(1, changes.size());
+  EXPECT_EQ(CHANGE_TYPE_REMOVED, changes[0].change_type);
+  EXPECT_EQ(OBJECT_TYPE_CONSTRAINT, changes[0].object_type);
+  EXPECT_TRUE(DiffCatalogs(old_catalog, old_catalog).empty());
+
+}
+
+TEST(TestSuite, NormalizeQueryTest) {
+
+  EXPECT_EQ("select * from bugs where bug_id = ? and status = ?",
+            NormalizeQuery("select *  from bugs where bug_id = 42 and status = 'it''s new';"));
+  EXPECT_EQ("select tag1 from bugs where bug_id in (?)",
+            NormalizeQuery("select tag1 from bugs where bug_id in (1, 2,3)"));
+  EXPECT_EQ("insert into bugs values (?)",
+            NormalizeQuery("insert into bugs values (1, 'a'), (2, 'b'),(3, 'c');"));
+  EXPECT_EQ("select a from bugs where note = ? and b in (?)",
+            NormalizeQuery("select a /* or b; 'x' */ from bugs where note = 'a or b'"
+                           "  and b in (:x, $1) ;"));
+
+}
+
+TEST(TestSuite, LogModeTest) {
+
+  Configuration default_conf;
+  default_conf.testing_mode = true;
+  default_conf.log_mode = true;
+
+  std::unique_ptr<std::istringstream> stream(new std::istringstream());
+  stream->str(
+      "SELECT * FROM Bugs WHERE bug_id = 1;\n"
+      "SELECT * FROM Bugs WHERE bug_id = 2;\n"
+      "SELECT * FROM Bugs WHERE bug_id = 3;\n"
+      "SELECT * FROM Accounts WHERE account_id = 1;\n"
+      "SELECT status, reported_by, COUNT(*) FROM Bugs GROUP BY status;\n"
+      "SELECT status, reported_by, COUNT(*) FROM Bugs GROUP BY status;\n"
+      "SELECT bug_id FROM Bugs WHERE status = 'NEW';\n"
+  );
+
+  default_conf.test_stream.reset(stream.release());
+
+  Check(default_conf);
+
+  EXPECT_EQ(4, default_conf.query_stats.size());
+
+  // Findings are reported once per query shape
+  EXPECT_EQ(3, default_conf.checker_stats[RISK_LEVEL_ALL]);
+
+  auto ranking = RankPatterns(default_conf);
+  ASSERT_EQ(2, ranking.size());
+  EXPECT_EQ(PATTERN_ID_SELECT_STAR, ranking[0].pattern_id);
+  EXPECT_EQ(4, ranking[0].executions);
+  EXPECT_EQ(2, ranking[0].queries);
+  EXPECT_EQ(PATTERN_ID_GROUP_BY_USAGE, ranking[1].pattern_id);
+  EXPECT_EQ(2, ranking[1].executions);
+
+  // A pattern found in several statements of a routine body counts the
+  // executions of the routine once
+  Configuration routine_conf;
+  routine_conf.log_mode = true;
+  routine_conf.print_findings = false;
+  std::istringstream routine_input(
+      "CREATE PROCEDURE p() BEGIN SELECT * FROM a; SELECT * FROM b; END;\n"
+      "CREATE PROCEDURE p() BEGIN SELECT * FROM a; SELECT * FROM b; END;\n");
+  CheckStream(routine_conf, routine_input);
+
+  ASSERT_EQ(1, routine_conf.query_stats.size());
+  EXPECT_EQ(1, routine_conf.query_stats.begin()->second.pattern_ids.size());
+  EXPECT_EQ(2, routine_conf.pattern_ranks[PATTERN_ID_SELECT_STAR].executions);
+
+  // Rules that depend on literals see each execution of a known shape
+  Configuration literal_conf;
+  literal_conf.log_mode = true;
+  literal_conf.print_findings = false;
+  std::istringstream literal_input(
+      "SELECT a FROM t WHERE x = 5;\n"
+      "SELECT a FROM t WHERE x = 0.0001;\n"
+      "SELECT a FROM t WHERE x = 0.0001;\n");
+  CheckStream(literal_conf, literal_input);
+
+  ASSERT_EQ(1, literal_conf.query_stats.size());
+  EXPECT_EQ(1, literal_conf.checker_stats[RISK_LEVEL_ALL]);
+  EXPECT_EQ(2, literal_conf.pattern_ranks[PATTERN_ID_FLOAT].executions);
+  EXPECT_EQ(1, literal_conf.pattern_ranks[PATTERN_ID_FLOAT].queries);
+
+}
+
+TEST(TestSuite, SpaceSavingTest) {
+
+  SpaceSaving<uint64_t> left(4);
+  SpaceSaving<uint64_t> right(4);
+  uint64_t evicted;
+
+  // Heavy keys 1 and 2 among a long tail of distinct keys
+  for(uint64_t itr = 0; itr < 100; itr++){
+    left.Add(1, 1, evicted);
+    right.Add(2, 1, evicted);
+    left.Add(1000 + itr, 1, evicted);
+    right.Add(2000 + itr, 1, evicted);
+  }
+  right.Add(1, 10, evicted);
+
+  EXPECT_EQ(4, left.Size());
+  auto top = left.Top(1);
+  ASSERT_EQ(1, top.size());
+  EXPECT_EQ(1, top[0].key);
+  EXPECT_GE(top[0].count, 100);
+  EXPECT_LE(top[0].count - top[0].error, 100);
+
+  left.Merge(right);
+  EXPECT_EQ(4, left.Size());
+  top = left.Top(2);
+  ASSERT_EQ(2, top.size());
+  EXPECT_EQ(1, top[0].key);
+  EXPECT_GE(top[0].count, 110);
+  EXPECT_EQ(2, top[1].key);
+  EXPECT_GE(top[1].count, 100);
+
+}
+
+TEST(TestSuite, TopKLogModeTest) {
+
+  Configuration default_conf;
+  default_conf.testing_mode = true;
+  default_conf.log_mode = true;
+  default_conf.top_k = 1;
+
+  std::stringstream log;
+  for(int itr = 0; itr < 50; itr++){
+    log << "SELECT * FROM Bugs WHERE bug_id = " << itr << ";\n";
+    log << "SELECT bug_id FROM Table" << itr << ";\n";
+  }
+
+  std::unique_ptr<std::istringstream> stream(new std::istringstream(log.str()));
+  default_conf.test_stream.reset(stream.release());
+
+  Check(default_conf);
+
+  EXPECT_EQ(100, default_conf.executions);
+  EXPECT_LE(default_conf.query_stats.size(), SKETCH_CAPACITY_FACTOR);
+  EXPECT_EQ(50, default_conf.pattern_ranks[PATTERN_ID_SELECT_STAR].executions);
+
+  auto top = default_conf.pattern_sketch.Top(1);
+  ASSERT_EQ(1, top.size());
+  EXPECT_EQ(PATTERN_ID_SELECT_STAR, top[0].key.pattern_id);
+  EXPECT_EQ(50, top[0].count);
+
+  // One distinct SELECT * shape, estimated despite the evictions
+  auto ranking = RankPatterns(default_conf);
+  ASSERT_FALSE(ranking.empty());
+  EXPECT_EQ(PATTERN_ID_SELECT_STAR, ranking[0].pattern_id);
+  EXPECT_EQ(1, ranking[0].queries);
+
+}
+
+TEST(TestSuite, ClusterTest) {
+
+  Configuration default_conf;
+  default_conf.testing_mode = true;
+  default_conf.log_mode = true;
+  default_conf.cluster_queries = true;
+
+  // Variants of two queries: optional filters and reordered columns
+  std::stringstream log;
+  for(int itr = 0; itr < 20; itr++){
+    log << "SELECT * FROM Orders WHERE customer_id = " << itr;
+    log << ((itr % 2) ? " AND status = 'new'" : "");
+    log << ((itr % 3) ? " AND region = 'eu'" : "") << ";\n";
+  }
+  log << "SELECT id, name, email FROM Users WHERE id IN (SELECT user_id FROM Orders);\n"
+      << "SELECT name, email, id FROM Users WHERE id IN (SELECT user_id FROM Orders);\n"
+      << "SELECT status FROM Orders;\n";
+
+  std::unique_ptr<std::istringstream> stream(new std::istringstream(log.str()));
+  default_conf.test_stream.reset(stream.release());
+
+  Check(default_conf);
+
+  EXPECT_EQ(7, default_conf.query_stats.size());
+  EXPECT_EQ(3, default_conf.query_clusters.Size());
+
+  auto clusters = RankClusters(default_conf);
+  ASSERT_EQ(2, clusters.size());
+  EXPECT_EQ(20, clusters[0].executions);
+  EXPECT_EQ(4, clusters[0].queries);
+  EXPECT_EQ("select * from orders where customer_id = ? and status = ? and region = ?",
+            default_conf.query_stats.at(clusters[0].representative).query);
+  EXPECT_EQ(2, clusters[1].queries);
+  EXPECT_EQ(std::vector<PatternId>{PATTERN_ID_NESTING}, clusters[1].pattern_ids);
+
+  // Unrelated sets stay apart
+  LshClusters lsh;
+  lsh.Add(1, ComputeMinHash({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+  lsh.Add(2, ComputeMinHash({1, 2, 3, 4, 5, 6, 7, 8, 9, 11}));
+  lsh.Add(3, ComputeMinHash({21, 22, 23, 24, 25, 26, 27, 28, 29, 30}));
+  EXPECT_EQ(lsh.Find(1), lsh.Find(2));
+  EXPECT_NE(lsh.Find(1), lsh.Find(3));
+  EXPECT_EQ(2, lsh.Size());
+
+}
+
+TEST(TestSuite, HyperLogLogTest) {
+
+  HyperLogLog first;
+  HyperLogLog second;
+  HyperLogLog both;
+  for(uint64_t itr = 0; itr < 20000; itr++){
+    auto hash = HashString(std::to_string(itr));
+    (itr < 10000 ? first : second).Add(hash);
+    both.Add(hash);
+    both.Add(hash);
+  }
+
+  EXPECT_NEAR(10000, first.Estimate(), 500);
+  EXPECT_NEAR(20000, both.Estimate(), 1000);
+
+  // Merged counters match a counter over the whole stream
+  first.Merge(second);
+  EXPECT_DOUBLE_EQ(both.Estimate(), first.Estimate());
+
+  HyperLogLog small;
+  for(uint64_t itr = 0; itr < 10; itr++){
+    small.Add(HashString(std::to_string(itr)));
+  }
+  EXPECT_NEAR(10, small.Estimate(), 1);
+
+  EXPECT_THROW(small.Merge(HyperLogLog(10)), std::invalid_argument);
+
+}
 
 }  // End machine sqlcheck